@@ -0,0 +1,145 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Converts a binary gland output file back into the legacy per-cell text files.
+ *
+ * Usage: gastric_gland_convert_output RESULTS_FILE OUTPUT_DIR
+ *
+ * RESULTS_FILE is a results.glandbin file written by GlandBinaryOutputWriter. The
+ * files cellareas.dat, cellages.dat and results.vizancestors are written to
+ * OUTPUT_DIR in the same layout as CellVolumesWriter, CellAgesWriter and
+ * CellAncestorWriter.
+ */
+
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+
+#include "GlandBinaryOutputReader.hpp"
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        if (argc != 3)
+        {
+            ExecutableSupport::PrintError("Usage: gastric_gland_convert_output RESULTS_FILE OUTPUT_DIR", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else
+        {
+            GlandBinaryOutputReader reader(argv[1]);
+            const unsigned dimension = reader.GetDimension();
+
+            const std::string output_dir(argv[2]);
+            std::ofstream areas_file((output_dir + "/cellareas.dat").c_str());
+            std::ofstream ages_file((output_dir + "/cellages.dat").c_str());
+            std::ofstream ancestors_file((output_dir + "/results.vizancestors").c_str());
+            if (!areas_file || !ages_file || !ancestors_file)
+            {
+                EXCEPTION("Could not create output files in " + output_dir);
+            }
+
+            GlandOutputSample sample;
+            unsigned num_samples = 0;
+            while (reader.ReadNextSample(sample))
+            {
+                areas_file << sample.time << "\t";
+                ages_file << sample.time << "\t";
+                ancestors_file << sample.time << "\t";
+
+                for (unsigned i = 0; i < sample.GetNumCells(); i++)
+                {
+                    // Cells are written as location index, cell id, centre, then the data
+                    std::ostringstream prefix;
+                    prefix << sample.locationIndices[i] << " " << sample.cellIds[i] << " " << sample.x[i] << " ";
+                    if (dimension > 1)
+                    {
+                        prefix << sample.y[i] << " ";
+                    }
+
+                    // CellVolumesWriter skips cells without a finite Voronoi element
+                    if (!std::isnan(sample.volumes[i]) && sample.volumes[i] < DBL_MAX)
+                    {
+                        areas_file << prefix.str() << sample.volumes[i] << " ";
+                    }
+                    ages_file << prefix.str() << sample.ages[i] << " ";
+
+                    if (sample.ancestors[i] == UINT32_MAX)
+                    {
+                        ancestors_file << "-1 ";
+                    }
+                    else
+                    {
+                        ancestors_file << sample.ancestors[i] << " ";
+                    }
+                }
+
+                areas_file << "\n";
+                ages_file << "\n";
+                ancestors_file << "\n";
+                num_samples++;
+            }
+
+            std::cout << "Converted " << num_samples << " samples from " << argv[1] << std::endl;
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    // 0 means 'no error'
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -9,12 +9,17 @@
 #include "GastricGlandCellPopulation.hpp"
 #include "CryptSimulation2d.hpp"
 #include "GastricGlandSimulation2d.hpp"
+#include "GlandCheckpoint.hpp"
+#include "GlandEnsembleRunner.hpp"
+#include "GlandSweepSpec.hpp"
 
 #include "VoronoiDataWriter.hpp"
 #include "CellPopulationAreaWriter.hpp"
 #include "CellVolumesWriter.hpp"
 #include "CellAncestorWriter.hpp"
 #include "CellAgesWriter.hpp"
+#include "GlandBinaryOutputWriter.hpp"
+#include "AsyncGlandBinaryOutputWriter.hpp"
 
 // Cell population writers
 #include "CellMutationStatesCountWriter.hpp"
@@ -24,22 +29,31 @@
 #include "VoronoiDataWriter.hpp"
 
 #include "LinearSpringWithVariableSpringConstantsForce.hpp"
-#include "SloughingCellKiller.hpp"
+#include "GlandSpringForce.hpp"
+#include "GlandForwardEulerNumericalMethod.hpp"
+#include "GlandSloughingCellKiller.hpp"
 #include "GastricGlandBaseCellKiller.hpp"
 #include "ExperimentalParietalCellKiller.hpp"
 
 // V2 Features
-#include "GastricGlandBasePosition.hpp"
 #include "GlandBaseTrackingModifier.hpp"
+#include "GlandMorphogenFieldModifier.hpp"
 #include "GastricGlandCellCycleModelV2.hpp"
 #include "FoveolarCellKiller.hpp"
 #include "Parameters.hpp"
 #include "ExecutableSupport.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
 
-
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
+#include <unistd.h>
+
 int GastricGlandSimulation::run(int argc, char *argv[])
 {
     try
@@ -47,26 +61,86 @@ int GastricGlandSimulation::run(int argc, char *argv[])
         // Process arguments
         if (argc == 2 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help" ))
         {
-            std::cerr << "Usage: " << argv[0] << " [KEY=VALUE]...\n";
+            std::cerr << "Usage: " << argv[0] << " [--config FILE] [--quiet] [KEY=VALUE]...\n";
+            std::cerr << "       " << argv[0] << " --sweep FILE [--jobs N] [--replicates N] [--dry-run] [--config FILE] [KEY=VALUE]...\n";
             std::cerr << std::endl;
             std::cerr << GastricGlandParameters::help() << std::endl;
             return ExecutableSupport::EXIT_OK;
         }
 
+        std::string config_file;
+        std::string sweep_file;
+        unsigned num_jobs = 0;
+        unsigned num_replicates = 0;
+        bool dry_run = false;
         std::string parameter_string;
         for (int i = 1; i < argc; i++)
         {
-            parameter_string += argv[i];
-            parameter_string += '\n';
+            std::string arg(argv[i]);
+            if (arg == "--config" && i + 1 < argc)
+            {
+                config_file = argv[++i];
+            }
+            else if (arg == "--sweep" && i + 1 < argc)
+            {
+                sweep_file = argv[++i];
+            }
+            else if (arg == "--jobs" && i + 1 < argc)
+            {
+                num_jobs = parseUnsigned(argv[++i], "--jobs");
+            }
+            else if (arg == "--replicates" && i + 1 < argc)
+            {
+                num_replicates = parseUnsigned(argv[++i], "--replicates");
+                if (num_replicates == 0)
+                {
+                    EXCEPTION("--replicates must be at least 1");
+                }
+            }
+            else if (arg == "--dry-run")
+            {
+                dry_run = true;
+            }
+            else if (arg == "--quiet" || arg == "-q")
+            {
+                mQuiet = true;
+            }
+            else
+            {
+                parameter_string += arg;
+                parameter_string += '\n';
+            }
+        }
+
+        // Pairs on the command line override those in the config file
+        std::map<std::string, std::string> map;
+        if (!config_file.empty())
+        {
+            map = readConfigFile(config_file);
+        }
+        for (const auto& p : makeMap(parameter_string))
+        {
+            map[p.first] = p.second;
+        }
+
+        if (!sweep_file.empty())
+        {
+            return runSweep(sweep_file, map, num_jobs, num_replicates, dry_run);
+        }
+        if (num_jobs != 0 || num_replicates != 0 || dry_run)
+        {
+            EXCEPTION("--jobs, --replicates and --dry-run apply only to a --sweep");
         }
 
-        std::map<std::string, std::string> map = makeMap(parameter_string);
-        //validate(map);
+        // Rejects unknown keys and malformed or inconsistent values before anything is run
         GastricGlandParameters params;
         params.update(map);
 
         // Print output
-        std::cerr << params << std::endl;
+        if (!mQuiet)
+        {
+            std::cerr << params << std::endl;
+        }
 
         // Run simulation
         simplifiedModel(params);
@@ -81,10 +155,83 @@ int GastricGlandSimulation::run(int argc, char *argv[])
     }
 }
 
+void GastricGlandSimulation::SetQuiet(bool quiet)
+{
+    mQuiet = quiet;
+}
+
+int GastricGlandSimulation::runSweep(const std::string& rSweepFile,
+    const std::map<std::string, std::string>& rMap, unsigned numJobs, unsigned numReplicates, bool dryRun)
+{
+    // Every run is parsed and checked here, before any is launched
+    GlandSweepSpec spec;
+    spec.ReadFile(rSweepFile);
+    if (numReplicates > 0)
+    {
+        spec.SetNumReplicates(numReplicates);
+    }
+    std::vector<GlandSweepRun> runs = spec.Expand(rMap);
+
+    GastricGlandParameters base_params;
+    base_params.update(rMap);
+    OutputFileHandler output_file_handler(base_params.output_directory, false);
+    out_stream p_manifest = output_file_handler.OpenOutputFile("sweep_manifest.tsv");
+    spec.WriteManifest(runs, *p_manifest);
+    p_manifest->close();
+
+    std::cout << "Sweep " << rSweepFile << " expands to " << runs.size() << " runs; manifest written to "
+              << output_file_handler.GetOutputDirectoryFullPath() << "sweep_manifest.tsv" << std::endl;
+    if (dryRun)
+    {
+        return ExecutableSupport::EXIT_OK;
+    }
+
+    GlandEnsembleRunner runner(numJobs);
+    for (const GlandSweepRun& r_run : runs)
+    {
+        runner.AddRun(r_run.params);
+    }
+
+    std::cout << "Running " << runner.GetNumRuns() << " simulations on "
+              << runner.GetNumWorkers() << " workers" << std::endl;
+
+    unsigned num_failed = runner.Run();
+    if (num_failed > 0)
+    {
+        std::cerr << num_failed << " of " << runner.GetNumRuns() << " runs failed" << std::endl;
+        return ExecutableSupport::EXIT_ERROR;
+    }
+    return ExecutableSupport::EXIT_OK;
+}
+
 void GastricGlandSimulation::simplifiedModel(
     const GastricGlandParameters& params)
 {
-    setUp(params.seed);
+    if (!params.resume_from.empty())
+    {
+        runFromCheckpoint(params);
+    }
+    else if (params.warm_start_cache.empty())
+    {
+        runFromLattice(params, "");
+    }
+    else
+    {
+        runFromWarmStart(params);
+    }
+    if (!mQuiet)
+    {
+        std::cout << "Completed Toy Gastric Gland Model" << std::endl;
+    }
+}
+
+void GastricGlandSimulation::runFromLattice(
+    const GastricGlandParameters& params, const std::string& rBurnInDirectory)
+{
+    bool is_burn_in = !rBurnInDirectory.empty();
+
+    // A burn-in is shared by every seed, so it always uses the same one
+    setUp(is_burn_in ? WARM_START_SEED : params.seed);
 
     CylindricalHoneycombMeshGenerator generator(
         params.num_cells_across, params.num_cells_high,
@@ -99,9 +246,6 @@ void GastricGlandSimulation::simplifiedModel(
     {
         GastricGlandCellCycleModelV2* pCycle = dynamic_cast<GastricGlandCellCycleModelV2*>(
             cell->GetCellCycleModel());
-        pCycle->SetBaseHeight(params.base_height);
-        pCycle->SetIsthmusBeginHeight(params.isthmus_begin_height);
-        pCycle->SetIsthmusEndHeight(params.isthmus_end_height);
         pCycle->SetBaseG1Duration(params.base_g1_duration);
         pCycle->SetIsthmusG1Duration(params.isthmus_g1_duration);
     }
@@ -112,85 +256,334 @@ void GastricGlandSimulation::simplifiedModel(
     WntConcentration<2>::Instance()->SetType(LINEAR);
     WntConcentration<2>::Instance()->SetCellPopulation(cell_population);
     WntConcentration<2>::Instance()->SetCryptLength(params.gland_height);
-    GastricGlandBasePosition<2>::Instance()->SetBasePosition(c_vector<double, 2>());
 
     GastricGlandSimulation2d simulator(cell_population);
+    configureGland(simulator, params);
+
+    if (is_burn_in)
+    {
+        // No writers are attached, so the burn-in writes nothing but its archive
+        simulator.SetOutputDirectory(rBurnInDirectory);
+        simulator.SetEndTime(params.burn_in_time);
+        simulator.SetCheckpointFormat(GlandCheckpoint::ParseFormat(params.checkpoint_format));
+        if (!mQuiet)
+        {
+            std::cout << "Burning in warm start state in " << rBurnInDirectory << std::endl;
+        }
+        simulator.Solve();
+        simulator.SaveCheckpoint();
+
+        // The marker is written last: a cache directory without one is incomplete
+        OutputFileHandler handler(rBurnInDirectory, false);
+        out_stream p_marker = handler.OpenOutputFile("warm_start.txt");
+        *p_marker << SimulationTime::Instance()->GetTime() << "\n" << params.warmStartKey() << "\n"
+                  << GlandCheckpoint::GetFormatName(simulator.GetCheckpointFormat()) << "\n";
+        p_marker->close();
+    }
+    else
+    {
+        configureRun(simulator, params);
+        solveAndSave(simulator, params);
+    }
+
+    tearDown();
+}
+
+void GastricGlandSimulation::runFromWarmStart(const GastricGlandParameters& params)
+{
+    if (params.burn_in_time >= params.simulation_time*(params.num_epochs + 1))
+    {
+        EXCEPTION("burn-in-time must be less than the total simulation time");
+    }
+    if (params.do_parietal_killing_experiment && params.parietal_killing_experiment_time < params.burn_in_time)
+    {
+        EXCEPTION("parietal-killing-experiment-time must not be before burn-in-time when warm starting");
+    }
+
+    std::string cache_directory = params.warm_start_cache + "/" + params.warmStartKey();
+    FileFinder marker(cache_directory + "/warm_start.txt", RelativeTo::ChasteTestOutput);
+
+    if (!marker.Exists())
+    {
+        /*
+         * Burn in to a directory of our own and move it into place once complete, so that
+         * runs started concurrently, e.g. by an ensemble, never load a partial snapshot.
+         */
+        std::stringstream temp_directory;
+        temp_directory << cache_directory << ".tmp" << getpid();
+        runFromLattice(params, temp_directory.str());
+
+        std::string test_output = OutputFileHandler::GetChasteTestOutputDirectory();
+        if (std::rename((test_output + temp_directory.str()).c_str(), (test_output + cache_directory).c_str()) != 0)
+        {
+            if (!marker.Exists())
+            {
+                EXCEPTION("Could not move warm start state into " + cache_directory);
+            }
+
+            // Another run filled the cache first; use its snapshot
+            FileFinder(temp_directory.str(), RelativeTo::ChasteTestOutput).Remove();
+        }
+    }
+
+    double start_time;
+    std::string key;
+    std::string format_name;
+    std::ifstream marker_file(marker.GetAbsolutePath().c_str());
+    if (!(marker_file >> start_time >> key))
+    {
+        EXCEPTION("Corrupt warm start marker " + marker.GetAbsolutePath());
+    }
+    // Markers written before gland checkpoints existed name no format
+    if (!(marker_file >> format_name))
+    {
+        format_name = "boost";
+    }
+
+    setUp(params.seed);
+    GastricGlandSimulation2d* p_simulator;
+    if (GlandCheckpoint::ParseFormat(format_name) == CHECKPOINT_FORMAT_GLAND)
+    {
+        // Gland checkpoints hold only the evolving state, so the gland is configured again
+        p_simulator = GlandCheckpoint::Load(cache_directory, start_time);
+        configureGland(*p_simulator, params);
+    }
+    else
+    {
+        p_simulator = CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Load(cache_directory, start_time);
+        WntConcentration<2>::Instance()->SetCellPopulation(p_simulator->rGetCellPopulation());
+    }
+
+    // Give this run its own stochastic future from the shared snapshot
+    RandomNumberGenerator::Instance()->Reseed(params.seed);
+
+    configureRun(*p_simulator, params);
+    solveAndSave(*p_simulator, params);
+
+    delete p_simulator;
+    tearDown();
+}
+
+void GastricGlandSimulation::runFromCheckpoint(const GastricGlandParameters& params)
+{
+    // The checkpoint restores the random number generator, so the seed is not used
+    setUp(params.seed);
 
-    cell_population.SetWriteVtkAsPoints(false);
-    cell_population.AddPopulationWriter<VoronoiDataWriter>();
-    cell_population.AddPopulationWriter<CellPopulationAreaWriter>();
-    cell_population.AddCellWriter<CellVolumesWriter>();
-    cell_population.AddCellWriter<CellAncestorWriter>();
-    cell_population.AddCellWriter<CellAgesWriter>();
+    GastricGlandSimulation2d* p_simulator;
+    if (GlandCheckpoint::ParseFormat(params.checkpoint_format) == CHECKPOINT_FORMAT_GLAND)
+    {
+        p_simulator = GlandCheckpoint::Load(params.resume_from, params.resume_time);
+        configureGland(*p_simulator, params);
+        configureRun(*p_simulator, params, true);
+    }
+    else
+    {
+        // A Boost archive holds the whole simulation, with its writers, killers and pending epochs
+        p_simulator = CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Load(params.resume_from, params.resume_time);
+        WntConcentration<2>::Instance()->SetCellPopulation(p_simulator->rGetCellPopulation());
+
+        p_simulator->rGetGlandContext().rGetProfiler().SetEnabled(params.profile);
+        p_simulator->SetOutputDirectory(params.output_directory + "/sim_" + params.simulation_id);
+        p_simulator->SetCheckpointFormat(CHECKPOINT_FORMAT_BOOST);
+        configureThreads(*p_simulator, params);
+        configureTimestep(*p_simulator, params);
+        p_simulator->SetEndTime(params.simulation_time*(params.num_epochs + 1));
+    }
 
-    simulator.SetOutputDirectory(params.output_directory + "/sim_" + params.simulation_id);
-    std::cout << "Writing to output directory: " << simulator.GetOutputDirectory() << std::endl;
-    simulator.SetEndTime(params.simulation_time);
-    simulator.SetDt(params.dt);
-    simulator.SetSamplingTimestepMultiple(params.sampling_timestep_multiple);
+    if (!mQuiet)
+    {
+        std::cout << "Resuming from time " << params.resume_time << " in " << params.resume_from << std::endl;
+    }
+    solveAndSave(*p_simulator, params);
 
-    cell_population.SetDampingConstantNormal(params.damping_constant);
-    cell_population.SetAreaBasedDampingConstant(params.use_area_based_damping_constant);
+    delete p_simulator;
+    tearDown();
+}
 
-    MAKE_PTR(LinearSpringWithVariableSpringConstantsForce<2>, p_linear_force);
-    p_linear_force->SetEdgeBasedSpringConstant(params.use_edge_based_spring_constant);
-    simulator.AddForce(p_linear_force);
+void GastricGlandSimulation::configureGland(
+    GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params)
+{
+    GastricGlandCellPopulation<2>& r_population = static_cast<GastricGlandCellPopulation<2>&>(rSimulator.rGetCellPopulation());
+
+    rSimulator.rGetGlandContext().SetBaseHeight(params.base_height);
+    rSimulator.rGetGlandContext().SetIsthmusBeginHeight(params.isthmus_begin_height);
+    rSimulator.rGetGlandContext().SetIsthmusEndHeight(params.isthmus_end_height);
+
+    r_population.SetWriteVtkAsPoints(false);
+    rSimulator.SetDt(params.dt);
+
+    r_population.SetDampingConstantNormal(params.damping_constant);
+    r_population.SetAreaBasedDampingConstant(params.use_area_based_damping_constant);
+
+    // The gland spring force does not support edge-based spring constants
+    if (params.use_gland_spring_force && !params.use_edge_based_spring_constant)
+    {
+        MAKE_PTR(GlandSpringForce<2>, p_gland_force);
+        rSimulator.AddForce(p_gland_force);
+    }
+    else
+    {
+        MAKE_PTR(LinearSpringWithVariableSpringConstantsForce<2>, p_linear_force);
+        p_linear_force->SetEdgeBasedSpringConstant(params.use_edge_based_spring_constant);
+        rSimulator.AddForce(p_linear_force);
+    }
 
     if (params.use_sloughing)
     {
-        MAKE_PTR_ARGS(SloughingCellKiller<2>, p_killer, (&cell_population, params.gland_height));
-        simulator.AddCellKiller(p_killer);
+        MAKE_PTR_ARGS(GlandSloughingCellKiller<2>, p_killer, (&r_population, params.gland_height));
+        rSimulator.AddCellKiller(p_killer);
     }
 
     if (params.use_foveolar_max_age)
     {
-        MAKE_PTR_ARGS(FoveolarCellKiller<2>, p_foveolarKiller, (&cell_population,
+        MAKE_PTR_ARGS(FoveolarCellKiller<2>, p_foveolarKiller, (&r_population,
             params.foveolar_cell_max_age));
-        simulator.AddCellKiller(p_foveolarKiller);
+        rSimulator.AddCellKiller(p_foveolarKiller);
     }
 
-    if (params.do_parietal_killing_experiment)
+    MAKE_PTR(GlandBaseTrackingModifier<2>, p_baseTrackingModifier);
+    rSimulator.AddSimulationModifier(p_baseTrackingModifier);
+
+    if (params.use_bmp_field)
     {
-        MAKE_PTR_ARGS(ExperimentalParietalCellKiller<2>, p_experiment, (&cell_population,
-            params.parietal_killing_ratio, params.parietal_killing_experiment_time));
-        simulator.AddCellKiller(p_experiment);
+        // A resumed gland keeps its archived field, but takes these parameters
+        GlandMorphogenField& r_field = rSimulator.rGetGlandContext().rGetField(GLAND_SIGNAL_BMP);
+        r_field.SetDiffusivity(params.field_diffusivity);
+        r_field.SetDecayRate(params.field_decay_rate);
+        r_field.SetSecretionRate(params.field_secretion_rate);
+        r_field.SetTimeStep(params.field_dt);
+
+        MAKE_PTR(GlandMorphogenFieldModifier<2>, p_fieldModifier);
+        p_fieldModifier->SetSignal(GLAND_SIGNAL_BMP);
+        p_fieldModifier->SetGridSpacing(params.field_grid_spacing);
+        p_fieldModifier->SetGridTop(params.gland_height);
+        rSimulator.AddSimulationModifier(p_fieldModifier);
     }
 
-    MAKE_PTR(GlandBaseTrackingModifier<2>, p_baseTrackingModifier);
-    simulator.AddSimulationModifier(p_baseTrackingModifier);
+    rSimulator.SetMaxCells(params.max_cells);
 
-    simulator.SetMaxCells(params.max_cells);
+    rSimulator.FixBottomCells();
+}
+
+void GastricGlandSimulation::configureRun(
+    GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params, bool isResume)
+{
+    GastricGlandCellPopulation<2>& r_population = static_cast<GastricGlandCellPopulation<2>&>(rSimulator.rGetCellPopulation());
+    double start_time = SimulationTime::Instance()->GetTime();
 
-    simulator.FixBottomCells();
-    if (params.label_ancestors)
+    rSimulator.rGetGlandContext().rGetProfiler().SetEnabled(params.profile);
+
+    if (params.legacy_text_output)
     {
-        simulator.LabelBaseCellAncestors();
-        simulator.LabelIsthmusCellAncestors();
-        simulator.LabelNeckCellAncestors();
+        r_population.AddPopulationWriter<VoronoiDataWriter>();
+        r_population.AddPopulationWriter<CellPopulationAreaWriter>();
+        r_population.AddCellWriter<CellVolumesWriter>();
+        r_population.AddCellWriter<CellAncestorWriter>();
+        r_population.AddCellWriter<CellAgesWriter>();
+    }
+    else
+    {
+        // One columnar file per run; gastric_gland_convert_output recreates the per-cell text files
+        if (params.async_output)
+        {
+            r_population.AddPopulationWriter<AsyncGlandBinaryOutputWriter>();
+        }
+        else
+        {
+            r_population.AddPopulationWriter<GlandBinaryOutputWriter>();
+        }
     }
 
+    rSimulator.SetOutputDirectory(params.output_directory + "/sim_" + params.simulation_id);
+    if (!mQuiet)
+    {
+        std::cout << "Writing to output directory: " << rSimulator.GetOutputDirectory() << std::endl;
+    }
+    rSimulator.SetSamplingTimestepMultiple(params.sampling_timestep_multiple);
+    rSimulator.SetCheckpointFormat(GlandCheckpoint::ParseFormat(params.checkpoint_format));
 
-    std::cout << "Beginning Solve()..." << std::endl;
-    simulator.Solve();
+    configureThreads(rSimulator, params);
+    configureTimestep(rSimulator, params);
 
-    CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Save(&simulator);
+    if (params.do_parietal_killing_experiment)
+    {
+        // A resumed run has already carried out the experiment if the saved run reached its time
+        bool has_activated = isResume && !(start_time < params.parietal_killing_experiment_time);
+        MAKE_PTR_ARGS(ExperimentalParietalCellKiller<2>, p_experiment, (&r_population,
+            params.parietal_killing_ratio, params.parietal_killing_experiment_time, has_activated));
+        rSimulator.AddCellKiller(p_experiment);
+    }
 
-    for (int i = 1; i <= 4; i++)
+    if (params.label_ancestors && !isResume)
     {
-        // Load where left off
-        GastricGlandSimulation2d* p_simulator =
-            CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Load(
-                params.output_directory + "/sim_" + params.simulation_id, params.simulation_time*i);
-        
-        p_simulator->LabelBaseCellAncestors();
-        p_simulator->LabelIsthmusCellAncestors();
-        p_simulator->LabelNeckCellAncestors();
-        p_simulator->SetEndTime(params.simulation_time*(i+1));
-        p_simulator->Solve();
-        CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Save(p_simulator);
-        delete p_simulator;
+        rSimulator.LabelBaseCellAncestors();
+        rSimulator.LabelIsthmusCellAncestors();
+        rSimulator.LabelNeckCellAncestors();
     }
 
-    tearDown();
-    std::cout << "Completed Toy Gastric Gland Model" << std::endl;
+    /*
+     * The run is split into num_epochs+1 periods of simulation_time. At the end of each
+     * period we relabel the ancestors in process, optionally writing a checkpoint.
+     * A warm-started or resumed run begins part way through, so epochs it has skipped are dropped.
+     */
+    unsigned epoch_actions = EPOCH_LABEL_BASE_ANCESTORS | EPOCH_LABEL_ISTHMUS_ANCESTORS | EPOCH_LABEL_NECK_ANCESTORS;
+    if (params.checkpoint_epochs)
+    {
+        epoch_actions |= EPOCH_CHECKPOINT;
+    }
+    for (unsigned i = 1; i <= params.num_epochs; i++)
+    {
+        if (params.simulation_time*i > start_time)
+        {
+            rSimulator.AddEpoch(params.simulation_time*i, epoch_actions);
+        }
+    }
+    rSimulator.SetEndTime(params.simulation_time*(params.num_epochs + 1));
+}
+
+void GastricGlandSimulation::configureThreads(
+    GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params)
+{
+    // Thread counts are not archived, so they are applied here rather than in configureGland()
+    if (params.num_threads > 1)
+    {
+        MAKE_PTR(GlandForwardEulerNumericalMethod<2>, p_numerical_method);
+        p_numerical_method->SetNumThreads(params.num_threads);
+        rSimulator.SetNumericalMethod(p_numerical_method);
+    }
+    for (auto p_force : rSimulator.rGetForceCollection())
+    {
+        if (boost::shared_ptr<GlandSpringForce<2> > p_gland_force = boost::dynamic_pointer_cast<GlandSpringForce<2> >(p_force))
+        {
+            p_gland_force->SetNumThreads(params.num_threads);
+        }
+    }
+}
+
+void GastricGlandSimulation::configureTimestep(
+    GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params)
+{
+    // Not archived, so applied here rather than in configureGland()
+    if (params.adaptive_dt)
+    {
+        rSimulator.SetAdaptiveDt(params.min_dt, params.max_dt, params.adaptive_displacement);
+    }
+}
+
+void GastricGlandSimulation::solveAndSave(
+    GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params)
+{
+    if (!mQuiet)
+    {
+        std::cout << "Beginning Solve()..." << std::endl;
+    }
+    rSimulator.Solve();
+    rSimulator.WriteProfileSummary();
+
+    if (!mQuiet && !params.legacy_text_output && params.async_output)
+    {
+        std::cout << "Time stalled on output: " << AsyncGlandBinaryOutputWriter<2>::GetTotalStallTime() << " s" << std::endl;
+    }
+
+    rSimulator.SaveCheckpoint();
 }
@@ -66,19 +66,119 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "RandomNumberGenerator.hpp"
 #include "CellPropertyRegistry.hpp"
 #include "CellId.hpp"
-#include "SignalGradient.hpp"
 #include "WntConcentration.hpp"
 #include "Parameters.hpp"
-#include "GastricGlandBasePosition.hpp"
+
+class GastricGlandSimulation2d;
 
 class GastricGlandSimulation
 {
+private:
+
+    /** Seed used for every warm start burn-in, which is shared between seeds. */
+    static const unsigned WARM_START_SEED = 0;
+
+    /** Whether to suppress progress messages for a single run. */
+    bool mQuiet = false;
+
+    /**
+     * Build a gland on a fresh honeycomb lattice and run it.
+     *
+     * @param params the run parameters
+     * @param rBurnInDirectory if not empty, instead run a warm start burn-in to
+     *     params.burn_in_time and save it in this output directory
+     */
+    void runFromLattice(const GastricGlandParameters& params, const std::string& rBurnInDirectory);
+
+    /**
+     * Run from the cached warm start state for the gland shape in params, burning it
+     * in first if the cache does not hold it yet.
+     *
+     * @param params the run parameters
+     */
+    void runFromWarmStart(const GastricGlandParameters& params);
+
+    /**
+     * Resume the run saved at params.resume_time in the output directory
+     * params.resume_from, continuing it to the end time of params.
+     *
+     * @param params the run parameters, as for the saved run apart from the end time
+     */
+    void runFromCheckpoint(const GastricGlandParameters& params);
+
+    /**
+     * Configure the parts of a simulation which a Boost archive saves with a warm start:
+     * the gland context, mechanics, killers and modifiers. A gland checkpoint does not
+     * save them, so simulations loaded from one are configured again.
+     *
+     * @param rSimulator the simulation
+     * @param params the run parameters
+     */
+    void configureGland(GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params);
+
+    /**
+     * Configure the parts of a simulation specific to one run: output, threads,
+     * the parietal killing experiment, ancestor labels, epochs and end time.
+     *
+     * @param rSimulator the simulation, at its start time
+     * @param params the run parameters
+     * @param isResume whether the simulation continues a saved run, in which case
+     *     ancestors are not labelled afresh and an experiment already carried out is not repeated
+     */
+    void configureRun(GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params, bool isResume=false);
+
+    /**
+     * Apply the thread counts, which are never archived, to a simulation.
+     *
+     * @param rSimulator the simulation
+     * @param params the run parameters
+     */
+    void configureThreads(GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params);
+
+    /**
+     * Apply adaptive time stepping, which is never archived, to a simulation.
+     *
+     * @param rSimulator the simulation
+     * @param params the run parameters
+     */
+    void configureTimestep(GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params);
+
+    /**
+     * Solve a configured simulation, then write its profile and final archive.
+     *
+     * @param rSimulator the simulation
+     * @param params the run parameters
+     */
+    void solveAndSave(GastricGlandSimulation2d& rSimulator, const GastricGlandParameters& params);
+
+    /**
+     * Expand a sweep file into runs, write their manifest to sweep_manifest.tsv in the
+     * output directory, and execute them on a GlandEnsembleRunner.
+     *
+     * @param rSweepFile path of the sweep file, in the format read by GlandSweepSpec
+     * @param rMap parameters for every run, overriding those in the sweep file
+     * @param numJobs the maximum number of concurrent runs (0 to use every online core)
+     * @param numReplicates the number of runs of each point, overriding the sweep file (0 to keep the file's)
+     * @param dryRun whether to stop after writing the manifest
+     * @return the exit code
+     */
+    int runSweep(const std::string& rSweepFile, const std::map<std::string, std::string>& rMap,
+                 unsigned numJobs, unsigned numReplicates, bool dryRun);
+
 public:
     GastricGlandSimulation() = default;
     ~GastricGlandSimulation() = default;
 
     int run(int argc, char *argv[]);
 
+    /**
+     * Set whether to suppress the parameter listing and progress messages, as --quiet does.
+     * Errors are still reported.
+     *
+     * @param quiet whether to be quiet (defaults to false)
+     */
+    void SetQuiet(bool quiet);
+
     void simplifiedModel(
         const GastricGlandParameters& params
     );
@@ -102,8 +202,6 @@ public:
         RandomNumberGenerator::Destroy();
         CellPropertyRegistry::Instance()->Clear(); // Destroys properties which are still held by a shared pointer
         WntConcentration<2>::Destroy();
-        SignalGradient<2>::Destroy();
-        GastricGlandBasePosition<2>::Destroy();
     }
 };
 
@@ -0,0 +1,179 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandCellIndex.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+/** Bands above this one are merged into it, so that a stray cell cannot allocate without bound. */
+static const unsigned MAX_BAND = 4095u;
+
+template<unsigned DIM>
+GlandCellIndex<DIM>::GlandCellIndex(double origin, double bandHeight)
+    : mOrigin(origin),
+      mBandHeight(bandHeight),
+      mIsBuilt(false),
+      mTime(0.0),
+      mNumCells(0)
+{
+    assert(bandHeight > 0.0);
+}
+
+template<unsigned DIM>
+unsigned GlandCellIndex<DIM>::GetBand(double height) const
+{
+    double offset = (height - mOrigin)/mBandHeight;
+    return offset < 1.0 ? 0u : offset >= MAX_BAND ? MAX_BAND : static_cast<unsigned>(offset);
+}
+
+template<unsigned DIM>
+void GlandCellIndex<DIM>::Rebuild(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    // Keep the buckets' storage from step to step
+    for (unsigned i=0; i<mBands.size(); i++)
+    {
+        mBands[i].clear();
+        mBandHeights[i].clear();
+    }
+    for (unsigned i=0; i<mCellsOfType.size(); i++)
+    {
+        mCellsOfType[i].clear();
+    }
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        CellPtr p_cell = *cell_iter;
+        double height = rCellPopulation.GetLocationOfCellCentre(p_cell)[DIM-1];
+
+        unsigned band = GetBand(height);
+        if (band >= mBands.size())
+        {
+            mBands.resize(band + 1);
+            mBandHeights.resize(band + 1);
+        }
+        mBands[band].push_back(p_cell);
+        mBandHeights[band].push_back(height);
+
+        // There are only a handful of types, so a linear search is cheapest
+        boost::shared_ptr<AbstractCellProperty> p_type = p_cell->GetCellProliferativeType();
+        unsigned type_index = 0;
+        while (type_index < mTypes.size() && !mTypes[type_index]->IsSame(p_type))
+        {
+            type_index++;
+        }
+        if (type_index == mTypes.size())
+        {
+            mTypes.push_back(p_type);
+            mCellsOfType.push_back(std::vector<CellPtr>());
+        }
+        mCellsOfType[type_index].push_back(p_cell);
+    }
+
+    mIsBuilt = true;
+    mTime = SimulationTime::Instance()->GetTime();
+    mNumCells = rCellPopulation.rGetCells().size();
+}
+
+template<unsigned DIM>
+void GlandCellIndex<DIM>::Refresh(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    if (!mIsBuilt
+        || mTime != SimulationTime::Instance()->GetTime()
+        || mNumCells != rCellPopulation.rGetCells().size())
+    {
+        Rebuild(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void GlandCellIndex<DIM>::Invalidate()
+{
+    mIsBuilt = false;
+}
+
+template<unsigned DIM>
+void GlandCellIndex<DIM>::GetCellsAbove(double height, std::vector<CellPtr>& rCells) const
+{
+    rCells.clear();
+    for (unsigned band = GetBand(height); band < mBands.size(); band++)
+    {
+        for (unsigned i=0; i<mBands[band].size(); i++)
+        {
+            if (mBandHeights[band][i] > height)
+            {
+                rCells.push_back(mBands[band][i]);
+            }
+        }
+    }
+}
+
+template<unsigned DIM>
+void GlandCellIndex<DIM>::GetCellsBelow(double height, std::vector<CellPtr>& rCells) const
+{
+    rCells.clear();
+    unsigned last_band = std::min<unsigned>(GetBand(height) + 1, mBands.size());
+    for (unsigned band = 0; band < last_band; band++)
+    {
+        for (unsigned i=0; i<mBands[band].size(); i++)
+        {
+            if (mBandHeights[band][i] < height)
+            {
+                rCells.push_back(mBands[band][i]);
+            }
+        }
+    }
+}
+
+template<unsigned DIM>
+const std::vector<CellPtr>& GlandCellIndex<DIM>::rGetCellsOfType(boost::shared_ptr<AbstractCellProperty> pType) const
+{
+    for (unsigned i=0; i<mTypes.size(); i++)
+    {
+        if (mTypes[i]->IsSame(pType))
+        {
+            return mCellsOfType[i];
+        }
+    }
+    return mNoCells;
+}
+
+// Explicit instantiation
+template class GlandCellIndex<1>;
+template class GlandCellIndex<2>;
+template class GlandCellIndex<3>;
@@ -0,0 +1,158 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDCELLINDEX_HPP_
+#define GLANDCELLINDEX_HPP_
+
+#include "AbstractCellPopulation.hpp"
+#include "CellPropertyRegistry.hpp"
+
+#include <vector>
+
+/**
+ * A per-step index of the cells of a population by height band and by proliferative
+ * type, so that the cell killers visit only the cells they could kill rather than each
+ * scanning the whole population.
+ *
+ * The index is built in one pass over the population and reused by every killer in the
+ * same step; cells killed in the meantime stay in the index, so callers skip dead cells.
+ * Within a band and within a type, cells keep their population order.
+ *
+ * The index is derived state: it is rebuilt rather than archived.
+ */
+template<unsigned DIM>
+class GlandCellIndex
+{
+private:
+
+    /** Height of the bottom of the first band. Lower cells also fall into the first band. */
+    double mOrigin;
+
+    /** Height of each band. */
+    double mBandHeight;
+
+    /** The cells in each height band. */
+    std::vector<std::vector<CellPtr> > mBands;
+
+    /** The height of each cell in mBands, in the same layout. */
+    std::vector<std::vector<double> > mBandHeights;
+
+    /** The proliferative types seen, matching mCellsOfType. */
+    std::vector<boost::shared_ptr<AbstractCellProperty> > mTypes;
+
+    /** The cells of each of mTypes. */
+    std::vector<std::vector<CellPtr> > mCellsOfType;
+
+    /** Returned for types with no cells. */
+    std::vector<CellPtr> mNoCells;
+
+    /** Whether the index has been built since it was last invalidated. */
+    bool mIsBuilt;
+
+    /** The simulation time when the index was built. The step count is not used, as it restarts when the time step changes. */
+    double mTime;
+
+    /** The number of cells in the population when the index was built. */
+    unsigned mNumCells;
+
+    /**
+     * @param height a cell height
+     * @return the band which holds cells at this height
+     */
+    unsigned GetBand(double height) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param origin height of the bottom of the first band (defaults to -5.0)
+     * @param bandHeight height of each band (defaults to 1.0, a cell diameter)
+     */
+    GlandCellIndex(double origin=-5.0, double bandHeight=1.0);
+
+    /**
+     * Rebuild the index from a population.
+     *
+     * @param rCellPopulation the population
+     */
+    void Rebuild(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Rebuild the index unless it was already built for this population at the current time.
+     *
+     * @param rCellPopulation the population
+     */
+    void Refresh(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Mark the index out of date, so that the next Refresh() rebuilds it. Called at the start
+     * of each step, since Solve() may run births and deaths twice at the same time step.
+     */
+    void Invalidate();
+
+    /**
+     * Collect the cells whose height is greater than a given height.
+     *
+     * @param height the height
+     * @param rCells filled with the cells, which may include dead ones
+     */
+    void GetCellsAbove(double height, std::vector<CellPtr>& rCells) const;
+
+    /**
+     * Collect the cells whose height is less than a given height.
+     *
+     * @param height the height
+     * @param rCells filled with the cells, which may include dead ones
+     */
+    void GetCellsBelow(double height, std::vector<CellPtr>& rCells) const;
+
+    /**
+     * @param pType a proliferative type, as held by the CellPropertyRegistry
+     * @return the cells of exactly this type, in population order, which may include dead ones
+     */
+    const std::vector<CellPtr>& rGetCellsOfType(boost::shared_ptr<AbstractCellProperty> pType) const;
+
+    /**
+     * @return the cells of exactly proliferative type TYPE, in population order, which may include dead ones
+     */
+    template<typename TYPE>
+    const std::vector<CellPtr>& rGetCellsOfType() const
+    {
+        return rGetCellsOfType(CellPropertyRegistry::Instance()->Get<TYPE>());
+    }
+};
+
+#endif /*GLANDCELLINDEX_HPP_*/
@@ -0,0 +1,210 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandContext.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+GlandContext<DIM>::GlandContext()
+    : mBasePosition(zero_vector<double>(DIM)),
+      mBaseHeight(3.0),
+      mIsthmusBeginHeight(28.0),
+      mIsthmusEndHeight(32.0),
+      mIsRecordingNewFoveolarCells(false),
+      mNumCellTypeChanges(0)
+{
+    for (unsigned signal=0; signal<NUM_GLAND_SIGNALS; signal++)
+    {
+        rGetSignal(GlandSignal(signal)).SetField(&mFields[signal]);
+    }
+}
+
+template<unsigned DIM>
+GlandContext<DIM>::~GlandContext()
+{
+}
+
+template<unsigned DIM>
+const c_vector<double, DIM>& GlandContext<DIM>::rGetBasePosition() const
+{
+    return mBasePosition;
+}
+
+template<unsigned DIM>
+void GlandContext<DIM>::SetBasePosition(const c_vector<double, DIM>& rPosition)
+{
+    mBasePosition = rPosition;
+}
+
+template<unsigned DIM>
+SignalGradient<DIM>& GlandContext<DIM>::rGetSignal()
+{
+    return mSignal;
+}
+
+template<unsigned DIM>
+SignalGradient<DIM>& GlandContext<DIM>::rGetBmpSignal()
+{
+    return mBmpSignal;
+}
+
+template<unsigned DIM>
+SignalGradient<DIM>& GlandContext<DIM>::rGetEgfSignal()
+{
+    return mEgfSignal;
+}
+
+template<unsigned DIM>
+SignalGradient<DIM>& GlandContext<DIM>::rGetSignal(GlandSignal signal)
+{
+    switch (signal)
+    {
+        case GLAND_SIGNAL_WNT:
+            return mSignal;
+        case GLAND_SIGNAL_BMP:
+            return mBmpSignal;
+        case GLAND_SIGNAL_EGF:
+            return mEgfSignal;
+        default:
+            NEVER_REACHED;
+    }
+}
+
+template<unsigned DIM>
+GlandMorphogenField& GlandContext<DIM>::rGetField(GlandSignal signal)
+{
+    assert(signal < NUM_GLAND_SIGNALS);
+    return mFields[signal];
+}
+
+template<unsigned DIM>
+double GlandContext<DIM>::GetBaseHeight() const { return mBaseHeight; }
+template<unsigned DIM>
+void GlandContext<DIM>::SetBaseHeight(double height) { mBaseHeight = height; }
+
+template<unsigned DIM>
+double GlandContext<DIM>::GetIsthmusBeginHeight() const { return mIsthmusBeginHeight; }
+template<unsigned DIM>
+void GlandContext<DIM>::SetIsthmusBeginHeight(double height) { mIsthmusBeginHeight = height; }
+
+template<unsigned DIM>
+double GlandContext<DIM>::GetIsthmusEndHeight() const { return mIsthmusEndHeight; }
+template<unsigned DIM>
+void GlandContext<DIM>::SetIsthmusEndHeight(double height) { mIsthmusEndHeight = height; }
+
+template<unsigned DIM>
+std::vector<double>& GlandContext<DIM>::rGetNodeHeights()
+{
+    return mNodeHeights;
+}
+
+template<unsigned DIM>
+void GlandContext<DIM>::ClassifyNodeZones()
+{
+    const unsigned num_nodes = mNodeHeights.size();
+    mNodeZones.resize(num_nodes);
+
+    const double base_top = mBasePosition[DIM-1] + mBaseHeight;
+    const double isthmus_begin = mIsthmusBeginHeight;
+    const double isthmus_end = mIsthmusEndHeight;
+    const double* p_heights = mNodeHeights.data();
+    unsigned char* p_zones = mNodeZones.data();
+
+    // Kept free of calls and aliasing so that the compiler can vectorise it
+    for (unsigned i=0; i<num_nodes; i++)
+    {
+        const double height = p_heights[i];
+        p_zones[i] = height < base_top ? GLAND_ZONE_BASE
+                   : height < isthmus_begin ? GLAND_ZONE_NECK
+                   : height < isthmus_end ? GLAND_ZONE_ISTHMUS
+                   : GLAND_ZONE_FOVEOLAR;
+    }
+}
+
+template<unsigned DIM>
+const std::vector<unsigned char>& GlandContext<DIM>::rGetNodeZones() const
+{
+    return mNodeZones;
+}
+
+template<unsigned DIM>
+GlandCellIndex<DIM>& GlandContext<DIM>::rGetCellIndex()
+{
+    return mCellIndex;
+}
+
+template<unsigned DIM>
+GlandProfiler& GlandContext<DIM>::rGetProfiler()
+{
+    return mProfiler;
+}
+
+template<unsigned DIM>
+void GlandContext<DIM>::RecordNewFoveolarCell(CellPtr pCell)
+{
+    if (mIsRecordingNewFoveolarCells)
+    {
+        mNewFoveolarCells.push_back(pCell);
+    }
+}
+
+template<unsigned DIM>
+void GlandContext<DIM>::StartRecordingNewFoveolarCells()
+{
+    mIsRecordingNewFoveolarCells = true;
+}
+
+template<unsigned DIM>
+void GlandContext<DIM>::RecordCellTypeChange()
+{
+    mNumCellTypeChanges++;
+}
+
+template<unsigned DIM>
+unsigned GlandContext<DIM>::GetNumCellTypeChanges() const
+{
+    return mNumCellTypeChanges;
+}
+
+template<unsigned DIM>
+std::vector<CellPtr>& GlandContext<DIM>::rGetNewFoveolarCells()
+{
+    return mNewFoveolarCells;
+}
+
+// Explicit instantiation
+template class GlandContext<1>;
+template class GlandContext<2>;
+template class GlandContext<3>;
@@ -0,0 +1,315 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDCONTEXT_HPP_
+#define GLANDCONTEXT_HPP_
+
+#include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
+
+#include "UblasVectorInclude.hpp"
+#include "SignalGradient.hpp"
+#include "GlandMorphogenField.hpp"
+#include "GlandCellIndex.hpp"
+#include "GlandProfiler.hpp"
+
+#include <boost/serialization/vector.hpp>
+#include <cassert>
+#include <vector>
+
+/**
+ * The zones of the gastric gland, from base to surface. Stored as one byte per node
+ * or cell. GLAND_ZONE_UNSET marks a cell whose zone has not yet been classified.
+ */
+typedef enum GlandZone_
+{
+    GLAND_ZONE_BASE = 0,
+    GLAND_ZONE_NECK = 1,
+    GLAND_ZONE_ISTHMUS = 2,
+    GLAND_ZONE_FOVEOLAR = 3,
+    GLAND_ZONE_UNSET = 255
+} GlandZone;
+
+/**
+ * The signal fields held by a GlandContext, used to select one of them.
+ */
+typedef enum GlandSignal_
+{
+    GLAND_SIGNAL_WNT = 0,
+    GLAND_SIGNAL_BMP = 1,
+    GLAND_SIGNAL_EGF = 2,
+    NUM_GLAND_SIGNALS = 3
+} GlandSignal;
+
+/**
+ * Per-simulation state shared by the components of a gastric gland simulation.
+ *
+ * This replaces what used to be held in the GastricGlandBasePosition and
+ * SignalGradient singletons: the position of the gland base and the signal
+ * fields. The context is owned by the simulation and attached to its
+ * GastricGlandCellPopulation, through which modifiers and killers reach it, so
+ * the gland itself keeps no global state and nothing needs destroying between runs.
+ *
+ * GastricGlandCellCycleModelV2 reaches the context through the population it is
+ * given by GlandBaseTrackingModifier. This still does not let several simulations
+ * share one address space: the original GastricGlandCellCycleModel finds the
+ * population through the WntConcentration singleton, and SimulationTime and
+ * RandomNumberGenerator are process-global too (see GlandEnsembleRunner).
+ */
+template<unsigned DIM>
+class GlandContext
+{
+private:
+
+    /** The location of the lowest cell in the gland, updated by GlandBaseTrackingModifier. */
+    c_vector<double, DIM> mBasePosition;
+
+    /** The Wnt signal field. */
+    SignalGradient<DIM> mSignal;
+
+    /** The BMP signal field. */
+    SignalGradient<DIM> mBmpSignal;
+
+    /** The EGF signal field. */
+    SignalGradient<DIM> mEgfSignal;
+
+    /** A diffusing morphogen for each signal, sampled by the signal when its type is SG_FIELD. */
+    GlandMorphogenField mFields[NUM_GLAND_SIGNALS];
+
+    /** Height above the base position below which cells are in the base zone. */
+    double mBaseHeight;
+
+    /** Height at which the isthmus begins. */
+    double mIsthmusBeginHeight;
+
+    /** Height at which the isthmus ends and the foveolar zone begins. */
+    double mIsthmusEndHeight;
+
+    /** Height of each node, indexed by location index. Filled once per step by GlandBaseTrackingModifier. */
+    std::vector<double> mNodeHeights;
+
+    /** Zone of each node, indexed by location index, classified from mNodeHeights. */
+    std::vector<unsigned char> mNodeZones;
+
+    /** Index of cells by height band and proliferative type, shared by the cell killers. Rebuilt rather than archived. */
+    GlandCellIndex<DIM> mCellIndex;
+
+    /** Phase timers for the simulation. Not archived. */
+    GlandProfiler mProfiler;
+
+    /** Cells which have become foveolar since the foveolar cell killer last collected them. Not archived. */
+    std::vector<CellPtr> mNewFoveolarCells;
+
+    /** Whether a foveolar cell killer is collecting mNewFoveolarCells; until one is, nothing is recorded. */
+    bool mIsRecordingNewFoveolarCells;
+
+    /** Number of cell type changes recorded by the cell-cycle models. Not archived. */
+    unsigned mNumCellTypeChanges;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mBasePosition;
+        archive & mSignal;
+        archive & mBmpSignal;
+        archive & mEgfSignal;
+        archive & mBaseHeight;
+        archive & mIsthmusBeginHeight;
+        archive & mIsthmusEndHeight;
+        if (version >= 1)
+        {
+            for (unsigned signal=0; signal<NUM_GLAND_SIGNALS; signal++)
+            {
+                archive & mFields[signal];
+            }
+        }
+    }
+
+public:
+
+    /**
+     * Constructor. The base position starts at the origin.
+     */
+    GlandContext();
+
+    /**
+     * Destructor.
+     */
+    virtual ~GlandContext();
+
+    /**
+     * @return the location of the lowest cell in the gland
+     */
+    const c_vector<double, DIM>& rGetBasePosition() const;
+
+    /**
+     * Set the location of the lowest cell in the gland.
+     *
+     * @param rPosition the location of the lowest cell
+     */
+    void SetBasePosition(const c_vector<double, DIM>& rPosition);
+
+    /**
+     * @return the Wnt signal field
+     */
+    SignalGradient<DIM>& rGetSignal();
+
+    /**
+     * @return the BMP signal field
+     */
+    SignalGradient<DIM>& rGetBmpSignal();
+
+    /**
+     * @return the EGF signal field
+     */
+    SignalGradient<DIM>& rGetEgfSignal();
+
+    /**
+     * @param signal a GlandSignal
+     * @return that signal field
+     */
+    SignalGradient<DIM>& rGetSignal(GlandSignal signal);
+
+    /**
+     * @param signal a GlandSignal
+     * @return the morphogen field behind that signal
+     */
+    GlandMorphogenField& rGetField(GlandSignal signal);
+
+    double GetBaseHeight() const;
+    void SetBaseHeight(double height);
+
+    double GetIsthmusBeginHeight() const;
+    void SetIsthmusBeginHeight(double height);
+
+    double GetIsthmusEndHeight() const;
+    void SetIsthmusEndHeight(double height);
+
+    /**
+     * Classify a height into a gland zone, using the current base position.
+     *
+     * @param height the height of a cell
+     * @return the GlandZone containing this height
+     */
+    inline unsigned char ClassifyZone(double height) const
+    {
+        return height < mBasePosition[DIM-1] + mBaseHeight ? GLAND_ZONE_BASE
+             : height < mIsthmusBeginHeight ? GLAND_ZONE_NECK
+             : height < mIsthmusEndHeight ? GLAND_ZONE_ISTHMUS
+             : GLAND_ZONE_FOVEOLAR;
+    }
+
+    /**
+     * @return the node height buffer, to be filled before calling ClassifyNodeZones()
+     */
+    std::vector<double>& rGetNodeHeights();
+
+    /**
+     * Classify every entry of the node height buffer into the node zone buffer in one sweep.
+     */
+    void ClassifyNodeZones();
+
+    /**
+     * @return the zone of each node, as computed by the last call to ClassifyNodeZones()
+     */
+    const std::vector<unsigned char>& rGetNodeZones() const;
+
+    /**
+     * @return the per-step index of cells shared by the cell killers
+     */
+    GlandCellIndex<DIM>& rGetCellIndex();
+
+    /**
+     * @return the phase timers for the simulation
+     */
+    GlandProfiler& rGetProfiler();
+
+    /**
+     * Record that a cell has just become foveolar, so that the foveolar cell killer can
+     * schedule its death. Does nothing until StartRecordingNewFoveolarCells() is called.
+     *
+     * @param pCell the cell
+     */
+    void RecordNewFoveolarCell(CellPtr pCell);
+
+    /**
+     * Start recording cells as they become foveolar. Called by the foveolar cell killer
+     * once it has scheduled the cells which are already foveolar.
+     */
+    void StartRecordingNewFoveolarCells();
+
+    /**
+     * Record that a cell-cycle model has changed the proliferative type of its cell, so
+     * that the population knows to rebuild its rest lengths.
+     */
+    void RecordCellTypeChange();
+
+    /**
+     * @return the number of cell type changes recorded since this context was created
+     */
+    unsigned GetNumCellTypeChanges() const;
+
+    /**
+     * @return the cells which have become foveolar since recording started or the buffer
+     *     was last cleared; the caller clears it once it has collected them
+     */
+    std::vector<CellPtr>& rGetNewFoveolarCells();
+};
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Version 1 adds the morphogen fields; older archives load with empty fields.
+ */
+template<unsigned DIM>
+struct version<GlandContext<DIM> >
+{
+    ///Macro to set the version number of templated archive in known versions of Boost
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
+#endif /*GLANDCONTEXT_HPP_*/
@@ -0,0 +1,397 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandMorphogenField.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+GlandMorphogenField::GlandMorphogenField()
+    : mWidth(0.0),
+      mBottom(0.0),
+      mTop(0.0),
+      mNumX(0),
+      mNumY(0),
+      mDx(0.0),
+      mDy(0.0),
+      mDiffusivity(1.0),
+      mDecayRate(0.1),
+      mSecretionRate(1.0),
+      mTimeStep(0.1),
+      mPendingTime(0.0),
+      mIsFactorised(false)
+{
+}
+
+void GlandMorphogenField::SetUpGrid(double width, double bottom, double top, double spacing)
+{
+    if (!(width > 0.0) || !(top > bottom) || !(spacing > 0.0))
+    {
+        EXCEPTION("GlandMorphogenField needs a positive width, top above bottom and a positive spacing");
+    }
+
+    // The periodic solve needs at least three columns
+    mWidth = width;
+    mBottom = bottom;
+    mTop = top;
+    mNumX = std::max(3u, static_cast<unsigned>(ceil(width/spacing)));
+    mNumY = std::max(2u, static_cast<unsigned>(ceil((top - bottom)/spacing)) + 1);
+    mDx = width/mNumX;
+    mDy = (top - bottom)/(mNumY - 1);
+
+    mConcentration.assign(mNumX*mNumY, 0.0);
+    mSource.assign(mNumX*mNumY, 0.0);
+    mPendingTime = 0.0;
+    mIsFactorised = false;
+}
+
+bool GlandMorphogenField::IsSetUp() const
+{
+    return mNumX > 0;
+}
+
+double GlandMorphogenField::GetDiffusivity() const { return mDiffusivity; }
+void GlandMorphogenField::SetDiffusivity(double diffusivity)
+{
+    assert(diffusivity >= 0.0);
+    mDiffusivity = diffusivity;
+    mIsFactorised = false;
+}
+
+double GlandMorphogenField::GetDecayRate() const { return mDecayRate; }
+void GlandMorphogenField::SetDecayRate(double decayRate)
+{
+    assert(decayRate >= 0.0);
+    mDecayRate = decayRate;
+    mIsFactorised = false;
+}
+
+double GlandMorphogenField::GetSecretionRate() const { return mSecretionRate; }
+void GlandMorphogenField::SetSecretionRate(double secretionRate) { mSecretionRate = secretionRate; }
+
+double GlandMorphogenField::GetTimeStep() const { return mTimeStep; }
+void GlandMorphogenField::SetTimeStep(double timeStep)
+{
+    assert(timeStep > 0.0);
+    mTimeStep = timeStep;
+    mIsFactorised = false;
+}
+
+unsigned GlandMorphogenField::GetNumX() const { return mNumX; }
+unsigned GlandMorphogenField::GetNumY() const { return mNumY; }
+
+double GlandMorphogenField::GetRowHeight(unsigned row) const
+{
+    assert(row < mNumY);
+    return mBottom + row*mDy;
+}
+
+const std::vector<double>& GlandMorphogenField::rGetConcentration() const
+{
+    return mConcentration;
+}
+
+void GlandMorphogenField::Factorise()
+{
+    /*
+     * Each half step is implicit in one direction with half the decay, and explicit in the
+     * other. Both implicit operators are (1 + 2r + q) on the diagonal and -r off it, with
+     * r = D dt/(2 h^2) and q = k dt/4.
+     */
+    const double q = 0.25*mDecayRate*mTimeStep;
+
+    // x: periodic, solved as a tridiagonal system plus a Sherman-Morrison correction
+    const double rx = 0.5*mDiffusivity*mTimeStep/(mDx*mDx);
+    const double bx = 1.0 + 2.0*rx + q;
+    const double ax = -rx;
+    const double gamma = -bx;
+    std::vector<double> diag(mNumX, bx);
+    diag[0] = bx - gamma;
+    diag[mNumX-1] = bx - ax*ax/gamma;
+    mXUpper.resize(mNumX);
+    mXInvPivot.resize(mNumX);
+    mXInvPivot[0] = 1.0/diag[0];
+    mXUpper[0] = ax*mXInvPivot[0];
+    for (unsigned i=1; i<mNumX; i++)
+    {
+        mXInvPivot[i] = 1.0/(diag[i] - ax*mXUpper[i-1]);
+        mXUpper[i] = ax*mXInvPivot[i];
+    }
+
+    // Solve the modified system for u = (gamma, 0, ..., 0, ax) once
+    mXCorrection.assign(mNumX, 0.0);
+    mXCorrection[0] = gamma;
+    mXCorrection[mNumX-1] = ax;
+    mXCorrection[0] *= mXInvPivot[0];
+    for (unsigned i=1; i<mNumX; i++)
+    {
+        mXCorrection[i] = (mXCorrection[i] - ax*mXCorrection[i-1])*mXInvPivot[i];
+    }
+    for (unsigned i=mNumX-1; i-- > 0;)
+    {
+        mXCorrection[i] -= mXUpper[i]*mXCorrection[i+1];
+    }
+
+    // y: zero flux, so the boundary rows couple twice to their only neighbour
+    const double ry = 0.5*mDiffusivity*mTimeStep/(mDy*mDy);
+    const double by = 1.0 + 2.0*ry + q;
+    mYUpper.resize(mNumY);
+    mYInvPivot.resize(mNumY);
+    mYInvPivot[0] = 1.0/by;
+    mYUpper[0] = -2.0*ry*mYInvPivot[0];
+    for (unsigned j=1; j<mNumY; j++)
+    {
+        double lower = (j == mNumY-1) ? -2.0*ry : -ry;
+        mYInvPivot[j] = 1.0/(by - lower*mYUpper[j-1]);
+        mYUpper[j] = -ry*mYInvPivot[j];
+    }
+
+    mHalfStep.resize(mNumX*mNumY);
+    mRhs.resize(std::max(mNumX, mNumY));
+    mIsFactorised = true;
+}
+
+void GlandMorphogenField::Step()
+{
+    const double q = 0.25*mDecayRate*mTimeStep;
+    const double half_dt = 0.5*mTimeStep;
+    const double rx = 0.5*mDiffusivity*mTimeStep/(mDx*mDx);
+    const double ry = 0.5*mDiffusivity*mTimeStep/(mDy*mDy);
+    const double ax = -rx;
+    const double gamma = -(1.0 + 2.0*rx + q);
+    const unsigned nx = mNumX;
+    const unsigned ny = mNumY;
+    const double* p_c = mConcentration.data();
+    double* p_half = mHalfStep.data();
+    double* p_rhs = mRhs.data();
+
+    // First half step: implicit in x, explicit in y, one row at a time
+    for (unsigned j=0; j<ny; j++)
+    {
+        const double* p_row = p_c + j*nx;
+        const double* p_below = p_c + (j > 0 ? j-1 : 1)*nx;
+        const double* p_above = p_c + (j < ny-1 ? j+1 : ny-2)*nx;
+        for (unsigned i=0; i<nx; i++)
+        {
+            p_rhs[i] = (1.0 - q)*p_row[i] + ry*(p_below[i] - 2.0*p_row[i] + p_above[i])
+                       + half_dt*mSource[j*nx + i];
+        }
+
+        // Thomas forward and back substitution on the modified system
+        p_rhs[0] *= mXInvPivot[0];
+        for (unsigned i=1; i<nx; i++)
+        {
+            p_rhs[i] = (p_rhs[i] - ax*p_rhs[i-1])*mXInvPivot[i];
+        }
+        for (unsigned i=nx-1; i-- > 0;)
+        {
+            p_rhs[i] -= mXUpper[i]*p_rhs[i+1];
+        }
+
+        // Sherman-Morrison correction for the periodic corners
+        double factor = (p_rhs[0] + ax*p_rhs[nx-1]/gamma)
+                        /(1.0 + mXCorrection[0] + ax*mXCorrection[nx-1]/gamma);
+        double* p_out = p_half + j*nx;
+        for (unsigned i=0; i<nx; i++)
+        {
+            p_out[i] = p_rhs[i] - factor*mXCorrection[i];
+        }
+    }
+
+    // Second half step: implicit in y, explicit in x, all columns at once row by row
+    double* p_new = mConcentration.data();
+    for (unsigned j=0; j<ny; j++)
+    {
+        const double* p_row = p_half + j*nx;
+        double* p_out = p_new + j*nx;
+        for (unsigned i=0; i<nx; i++)
+        {
+            double left = p_row[i > 0 ? i-1 : nx-1];
+            double right = p_row[i < nx-1 ? i+1 : 0];
+            p_out[i] = (1.0 - q)*p_row[i] + rx*(left - 2.0*p_row[i] + right)
+                       + half_dt*mSource[j*nx + i];
+        }
+    }
+    for (unsigned i=0; i<nx; i++)
+    {
+        p_new[i] *= mYInvPivot[0];
+    }
+    for (unsigned j=1; j<ny; j++)
+    {
+        double lower = (j == ny-1) ? -2.0*ry : -ry;
+        double* p_row = p_new + j*nx;
+        const double* p_prev = p_new + (j-1)*nx;
+        for (unsigned i=0; i<nx; i++)
+        {
+            p_row[i] = (p_row[i] - lower*p_prev[i])*mYInvPivot[j];
+        }
+    }
+    for (unsigned j=ny-1; j-- > 0;)
+    {
+        double* p_row = p_new + j*nx;
+        const double* p_next = p_new + (j+1)*nx;
+        for (unsigned i=0; i<nx; i++)
+        {
+            p_row[i] -= mYUpper[j]*p_next[i];
+        }
+    }
+}
+
+void GlandMorphogenField::Locate(double x, double y, unsigned& rI0, unsigned& rI1, unsigned& rJ0, double& rTx, double& rTy) const
+{
+    double position_x = (x - mWidth*floor(x/mWidth))/mDx;
+    rI0 = std::min(static_cast<unsigned>(position_x), mNumX - 1);
+    rI1 = (rI0 + 1 == mNumX) ? 0 : rI0 + 1;
+    rTx = position_x - rI0;
+
+    double position_y = std::min(std::max((y - mBottom)/mDy, 0.0), mNumY - 1.0);
+    rJ0 = std::min(static_cast<unsigned>(position_y), mNumY - 2);
+    rTy = position_y - rJ0;
+}
+
+void GlandMorphogenField::ClearSources()
+{
+    std::fill(mSource.begin(), mSource.end(), 0.0);
+}
+
+void GlandMorphogenField::AddSource(double x, double y, double rate)
+{
+    assert(IsSetUp());
+    unsigned i0, i1, j0;
+    double tx, ty;
+    Locate(x, y, i0, i1, j0, tx, ty);
+
+    // Spread the amount over the grid cell area, so that it becomes a density
+    double density = rate/(mDx*mDy);
+    unsigned row0 = j0*mNumX;
+    unsigned row1 = row0 + mNumX;
+    mSource[row0 + i0] += density*(1.0 - tx)*(1.0 - ty);
+    mSource[row0 + i1] += density*tx*(1.0 - ty);
+    mSource[row1 + i0] += density*(1.0 - tx)*ty;
+    mSource[row1 + i1] += density*tx*ty;
+}
+
+void GlandMorphogenField::AddSecretingCell(double x, double y)
+{
+    AddSource(x, y, mSecretionRate);
+}
+
+void GlandMorphogenField::Advance(double duration)
+{
+    assert(IsSetUp());
+    if (!mIsFactorised)
+    {
+        Factorise();
+    }
+
+    // Round so that steps which add up to mTimeStep in floating point still trigger one
+    mPendingTime += duration;
+    while (mPendingTime > mTimeStep*(1.0 - 1e-9))
+    {
+        Step();
+        mPendingTime -= mTimeStep;
+    }
+    mPendingTime = std::max(mPendingTime, 0.0);
+}
+
+double GlandMorphogenField::Sample(double x, double y) const
+{
+    assert(IsSetUp());
+    unsigned i0, i1, j0;
+    double tx, ty;
+    Locate(x, y, i0, i1, j0, tx, ty);
+
+    const double* p_row0 = mConcentration.data() + j0*mNumX;
+    const double* p_row1 = p_row0 + mNumX;
+    return (1.0 - ty)*((1.0 - tx)*p_row0[i0] + tx*p_row0[i1])
+           + ty*((1.0 - tx)*p_row1[i0] + tx*p_row1[i1]);
+}
+
+c_vector<double, 2> GlandMorphogenField::SampleGradient(double x, double y) const
+{
+    assert(IsSetUp());
+    unsigned i0, i1, j0;
+    double tx, ty;
+    Locate(x, y, i0, i1, j0, tx, ty);
+
+    const double* p_row0 = mConcentration.data() + j0*mNumX;
+    const double* p_row1 = p_row0 + mNumX;
+    c_vector<double, 2> gradient;
+    gradient[0] = ((1.0 - ty)*(p_row0[i1] - p_row0[i0]) + ty*(p_row1[i1] - p_row1[i0]))/mDx;
+    gradient[1] = ((1.0 - tx)*(p_row1[i0] - p_row0[i0]) + tx*(p_row1[i1] - p_row0[i1]))/mDy;
+    if (y < mBottom || y > mTop)
+    {
+        gradient[1] = 0.0;
+    }
+    return gradient;
+}
+
+double GlandMorphogenField::GetMeanAtHeight(double y) const
+{
+    assert(IsSetUp());
+    double position_y = std::min(std::max((y - mBottom)/mDy, 0.0), mNumY - 1.0);
+    unsigned j0 = std::min(static_cast<unsigned>(position_y), mNumY - 2);
+    double ty = position_y - j0;
+
+    const double* p_row0 = mConcentration.data() + j0*mNumX;
+    const double* p_row1 = p_row0 + mNumX;
+    double sum = 0.0;
+    for (unsigned i=0; i<mNumX; i++)
+    {
+        sum += (1.0 - ty)*p_row0[i] + ty*p_row1[i];
+    }
+    return sum/mNumX;
+}
+
+double GlandMorphogenField::GetMeanGradientAtHeight(double y) const
+{
+    assert(IsSetUp());
+    if (y < mBottom || y > mTop)
+    {
+        return 0.0;
+    }
+    unsigned j0 = std::min(static_cast<unsigned>((y - mBottom)/mDy), mNumY - 2);
+
+    const double* p_row0 = mConcentration.data() + j0*mNumX;
+    const double* p_row1 = p_row0 + mNumX;
+    double sum = 0.0;
+    for (unsigned i=0; i<mNumX; i++)
+    {
+        sum += p_row1[i] - p_row0[i];
+    }
+    return sum/(mNumX*mDy);
+}
@@ -0,0 +1,300 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDMORPHOGENFIELD_HPP_
+#define GLANDMORPHOGENFIELD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/vector.hpp>
+
+#include "UblasVectorInclude.hpp"
+
+#include <vector>
+
+/**
+ * A morphogen concentration c on a structured grid over the unrolled cylindrical gland,
+ * periodic in x with the gland's circumference and with zero flux through the bottom and
+ * top rows, obeying
+ *
+ *     dc/dt = D (c_xx + c_yy) - k c + s(x, y),
+ *
+ * where the source s is deposited by cells. The grid is independent of the cell mesh.
+ *
+ * The field is advanced by Peaceman-Rachford ADI steps of a fixed length: each step solves
+ * one periodic tridiagonal system per row and one tridiagonal system per column, so it is
+ * unconditionally stable and costs O(grid points). Both systems have constant coefficients
+ * and are factorised once. Time passed to Advance() which does not make up a whole step is
+ * carried over to the next call. Sampling and deposition use bilinear weights and are O(1).
+ */
+class GlandMorphogenField
+{
+private:
+
+    /** Circumference of the gland, the period in x. */
+    double mWidth;
+
+    /** Height of the bottom row of grid points. */
+    double mBottom;
+
+    /** Height of the top row of grid points. */
+    double mTop;
+
+    /** Number of grid points around the gland. */
+    unsigned mNumX;
+
+    /** Number of grid points along the gland. */
+    unsigned mNumY;
+
+    /** Grid spacing in x. */
+    double mDx;
+
+    /** Grid spacing in y. */
+    double mDy;
+
+    /** The diffusivity D. */
+    double mDiffusivity;
+
+    /** The decay rate k. */
+    double mDecayRate;
+
+    /** The amount secreted per unit time by each secreting cell, used by AddSecretingCell(). */
+    double mSecretionRate;
+
+    /** The length of each ADI step. */
+    double mTimeStep;
+
+    /** Time passed to Advance() which has not yet made up a whole step. */
+    double mPendingTime;
+
+    /** The concentration at each grid point, row by row from the bottom. */
+    std::vector<double> mConcentration;
+
+    /** The source density at each grid point, deposited since the last ClearSources(). Not archived. */
+    std::vector<double> mSource;
+
+    /** Scratch: the field after the first half step. */
+    std::vector<double> mHalfStep;
+
+    /** Scratch: one row or column of right-hand sides. */
+    std::vector<double> mRhs;
+
+    /** Whether the factorisations below match the current grid and parameters. */
+    bool mIsFactorised;
+
+    /** Thomas algorithm factors for the x systems: modified upper diagonal and reciprocal pivots. */
+    std::vector<double> mXUpper, mXInvPivot;
+
+    /** Sherman-Morrison correction vector for the periodic x systems. */
+    std::vector<double> mXCorrection;
+
+    /** Thomas algorithm factors for the y systems. */
+    std::vector<double> mYUpper, mYInvPivot;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the field and its parameters. Sources are redeposited every step, and the
+     * factorisations are rebuilt, so neither is archived.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mWidth;
+        archive & mBottom;
+        archive & mTop;
+        archive & mNumX;
+        archive & mNumY;
+        archive & mDx;
+        archive & mDy;
+        archive & mDiffusivity;
+        archive & mDecayRate;
+        archive & mSecretionRate;
+        archive & mTimeStep;
+        archive & mPendingTime;
+        archive & mConcentration;
+        if (Archive::is_loading::value)
+        {
+            mSource.assign(mConcentration.size(), 0.0);
+            mIsFactorised = false;
+        }
+    }
+
+    /**
+     * Factorise the row and column systems for the current grid and parameters.
+     */
+    void Factorise();
+
+    /**
+     * Take one ADI step of length mTimeStep with the current sources.
+     */
+    void Step();
+
+    /**
+     * Find the grid cell containing a point and the bilinear weights within it.
+     *
+     * @param x the position around the gland, wrapped into one period
+     * @param y the height, clamped to the grid
+     * @param rI0 set to the column to the left of the point
+     * @param rI1 set to the column to its right
+     * @param rJ0 set to the row below the point
+     * @param rTx set to the fraction of the way from column rI0 to rI1
+     * @param rTy set to the fraction of the way from row rJ0 to the row above
+     */
+    void Locate(double x, double y, unsigned& rI0, unsigned& rI1, unsigned& rJ0, double& rTx, double& rTy) const;
+
+public:
+
+    /**
+     * Constructor. The field has no grid until SetUpGrid() is called.
+     */
+    GlandMorphogenField();
+
+    /**
+     * Lay out the grid and set the concentration to zero.
+     *
+     * @param width the circumference of the gland
+     * @param bottom the height of the bottom row
+     * @param top the height of the top row
+     * @param spacing the largest grid spacing to use
+     */
+    void SetUpGrid(double width, double bottom, double top, double spacing);
+
+    /**
+     * @return whether SetUpGrid() has been called
+     */
+    bool IsSetUp() const;
+
+    /** @return the diffusivity D */
+    double GetDiffusivity() const;
+
+    /** @param diffusivity the new diffusivity D */
+    void SetDiffusivity(double diffusivity);
+
+    /** @return the decay rate k */
+    double GetDecayRate() const;
+
+    /** @param decayRate the new decay rate k */
+    void SetDecayRate(double decayRate);
+
+    /** @return the amount secreted per unit time by each secreting cell */
+    double GetSecretionRate() const;
+
+    /** @param secretionRate the new amount secreted per unit time by each secreting cell */
+    void SetSecretionRate(double secretionRate);
+
+    /** @return the length of each ADI step */
+    double GetTimeStep() const;
+
+    /** @param timeStep the new length of each ADI step */
+    void SetTimeStep(double timeStep);
+
+    /** @return the number of grid points around the gland */
+    unsigned GetNumX() const;
+
+    /** @return the number of grid points along the gland */
+    unsigned GetNumY() const;
+
+    /**
+     * @param row a row of grid points, counted from the bottom
+     * @return the height of that row
+     */
+    double GetRowHeight(unsigned row) const;
+
+    /**
+     * @return the concentration at each grid point, row by row from the bottom
+     */
+    const std::vector<double>& rGetConcentration() const;
+
+    /**
+     * Remove all deposited sources.
+     */
+    void ClearSources();
+
+    /**
+     * Deposit a point source, spread bilinearly over the surrounding grid points.
+     *
+     * @param x the position around the gland
+     * @param y the height
+     * @param rate the amount released per unit time
+     */
+    void AddSource(double x, double y, double rate);
+
+    /**
+     * Deposit the source of one secreting cell, at the secretion rate.
+     *
+     * @param x the position around the gland
+     * @param y the height
+     */
+    void AddSecretingCell(double x, double y);
+
+    /**
+     * Advance the field by whole ADI steps covering the given time plus any carried over,
+     * with the sources currently deposited.
+     *
+     * @param duration the time to advance by
+     */
+    void Advance(double duration);
+
+    /**
+     * @param x the position around the gland
+     * @param y the height; points beyond the grid take the value of the nearest row
+     * @return the bilinearly interpolated concentration
+     */
+    double Sample(double x, double y) const;
+
+    /**
+     * @param x the position around the gland
+     * @param y the height
+     * @return the gradient of the bilinear interpolant, zero in y beyond the grid
+     */
+    c_vector<double, 2> SampleGradient(double x, double y) const;
+
+    /**
+     * @param y the height
+     * @return the concentration averaged around the gland at this height
+     */
+    double GetMeanAtHeight(double y) const;
+
+    /**
+     * @param y the height
+     * @return the derivative with height of GetMeanAtHeight(), zero beyond the grid
+     */
+    double GetMeanGradientAtHeight(double y) const;
+};
+
+#endif /*GLANDMORPHOGENFIELD_HPP_*/
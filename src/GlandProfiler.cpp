@@ -0,0 +1,246 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandProfiler.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+GlandProfiler::GlandProfiler()
+    : mEnabled(false)
+{
+    Reset();
+}
+
+void GlandProfiler::SetEnabled(bool enabled)
+{
+    mEnabled = enabled;
+}
+
+void GlandProfiler::Reset()
+{
+    for (unsigned i = 0; i < PROFILE_NUM_PHASES; i++)
+    {
+        PhaseRecord& r_record = mPhases[i];
+        r_record.totalTime = 0.0;
+        r_record.selfTime = 0.0;
+        r_record.stepTime = 0.0;
+        r_record.numCalls = 0;
+        std::fill(r_record.histogram, r_record.histogram + NUM_BUCKETS, 0ul);
+    }
+    std::fill(mStepHistogram, mStepHistogram + NUM_BUCKETS, 0ul);
+
+    mOpenPhases.clear();
+    mIsInStep = false;
+    mStepNumCells = 0;
+    mNumSteps = 0;
+    mNumCellSteps = 0.0;
+    mTotalStepTime = 0.0;
+}
+
+void GlandProfiler::Begin(GlandProfilePhase phase)
+{
+    OpenPhase open_phase;
+    open_phase.phase = phase;
+    open_phase.childTime = 0.0;
+    open_phase.start = Clock::now();
+    mOpenPhases.push_back(open_phase);
+}
+
+void GlandProfiler::End(GlandProfilePhase phase)
+{
+    assert(!mOpenPhases.empty() && mOpenPhases.back().phase == phase);
+
+    const OpenPhase& r_open_phase = mOpenPhases.back();
+    double elapsed = std::chrono::duration<double>(Clock::now() - r_open_phase.start).count();
+
+    PhaseRecord& r_record = mPhases[phase];
+    r_record.totalTime += elapsed;
+    r_record.selfTime += elapsed - r_open_phase.childTime;
+    r_record.stepTime += elapsed;
+    r_record.numCalls++;
+
+    mOpenPhases.pop_back();
+    if (!mOpenPhases.empty())
+    {
+        mOpenPhases.back().childTime += elapsed;
+    }
+}
+
+void GlandProfiler::BeginStep(unsigned numCells)
+{
+    EndStep();
+
+    mIsInStep = true;
+    mStepNumCells = numCells;
+    mStepStart = Clock::now();
+}
+
+void GlandProfiler::EndStep()
+{
+    if (!mIsInStep)
+    {
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - mStepStart).count();
+    mStepHistogram[GetBucket(elapsed)]++;
+    mTotalStepTime += elapsed;
+    mNumCellSteps += mStepNumCells;
+    mNumSteps++;
+
+    // Only phases which ran in the step are counted in its histograms
+    for (unsigned i = 0; i < PROFILE_NUM_PHASES; i++)
+    {
+        PhaseRecord& r_record = mPhases[i];
+        if (r_record.stepTime > 0.0)
+        {
+            r_record.histogram[GetBucket(r_record.stepTime)]++;
+            r_record.stepTime = 0.0;
+        }
+    }
+    mIsInStep = false;
+}
+
+unsigned GlandProfiler::GetBucket(double seconds)
+{
+    double microseconds = seconds*1e6;
+    if (microseconds < 1.0)
+    {
+        return 0;
+    }
+    unsigned bucket = 1 + static_cast<unsigned>(std::log2(microseconds));
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+double GlandProfiler::GetTotalTime(GlandProfilePhase phase) const
+{
+    return mPhases[phase].totalTime;
+}
+
+double GlandProfiler::GetSelfTime(GlandProfilePhase phase) const
+{
+    return mPhases[phase].selfTime;
+}
+
+unsigned long GlandProfiler::GetNumSteps() const
+{
+    return mNumSteps;
+}
+
+double GlandProfiler::GetCellsPerSecond() const
+{
+    return mTotalStepTime > 0.0 ? mNumCellSteps/mTotalStepTime : 0.0;
+}
+
+std::string GlandProfiler::GetPhaseName(GlandProfilePhase phase)
+{
+    switch (phase)
+    {
+        case PROFILE_UPDATE_CELL_POPULATION:
+            return "update_cell_population";
+        case PROFILE_CELL_CYCLE:
+            return "cell_cycle";
+        case PROFILE_KILLERS:
+            return "killers";
+        case PROFILE_REMESH:
+            return "remesh";
+        case PROFILE_EPOCHS:
+            return "epochs";
+        case PROFILE_UPDATE_CELL_LOCATIONS:
+            return "update_cell_locations";
+        case PROFILE_FORCES:
+            return "forces";
+        case PROFILE_BOUNDARY_CONDITION:
+            return "boundary_condition";
+        case PROFILE_BASE_TRACKING:
+            return "base_tracking";
+        case PROFILE_FIELDS:
+            return "fields";
+        case PROFILE_OUTPUT:
+            return "output";
+        default:
+            return "unknown";
+    }
+}
+
+void GlandProfiler::WriteHistogram(std::ostream& rStream, const unsigned long* pHistogram)
+{
+    rStream << "[";
+    bool first = true;
+    for (unsigned i = 0; i < NUM_BUCKETS; i++)
+    {
+        if (pHistogram[i] > 0)
+        {
+            rStream << (first ? "" : ", ") << "{\"below_us\": " << (1ul << i) << ", \"count\": " << pHistogram[i] << "}";
+            first = false;
+        }
+    }
+    rStream << "]";
+}
+
+void GlandProfiler::WriteSummary(std::ostream& rStream) const
+{
+    std::ios::fmtflags old_flags = rStream.flags();
+    std::streamsize old_precision = rStream.precision(9);
+
+    rStream << "{\n";
+    rStream << "  \"num_steps\": " << mNumSteps << ",\n";
+    rStream << "  \"total_step_time\": " << mTotalStepTime << ",\n";
+    rStream << "  \"mean_cells\": " << (mNumSteps > 0 ? mNumCellSteps/mNumSteps : 0.0) << ",\n";
+    rStream << "  \"cells_per_second\": " << GetCellsPerSecond() << ",\n";
+    rStream << "  \"step_histogram\": ";
+    WriteHistogram(rStream, mStepHistogram);
+    rStream << ",\n";
+    rStream << "  \"phases\": {\n";
+    for (unsigned i = 0; i < PROFILE_NUM_PHASES; i++)
+    {
+        const PhaseRecord& r_record = mPhases[i];
+        rStream << "    \"" << GetPhaseName(static_cast<GlandProfilePhase>(i)) << "\": {"
+                << "\"calls\": " << r_record.numCalls
+                << ", \"total_time\": " << r_record.totalTime
+                << ", \"self_time\": " << r_record.selfTime
+                << ", \"mean_time_per_step\": " << (mNumSteps > 0 ? r_record.totalTime/mNumSteps : 0.0)
+                << ", \"step_histogram\": ";
+        WriteHistogram(rStream, r_record.histogram);
+        rStream << "}" << (i + 1 < PROFILE_NUM_PHASES ? "," : "") << "\n";
+    }
+    rStream << "  }\n";
+    rStream << "}\n";
+
+    rStream.flags(old_flags);
+    rStream.precision(old_precision);
+}
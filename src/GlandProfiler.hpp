@@ -0,0 +1,298 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDPROFILER_HPP_
+#define GLANDPROFILER_HPP_
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * The phases of a gastric gland time step timed by GlandProfiler. Phases nest: the
+ * self time of a phase excludes the time spent in phases started inside it.
+ */
+typedef enum GlandProfilePhase_
+{
+    /** Deaths and the rest of the population update (self time), containing the three phases below. */
+    PROFILE_UPDATE_CELL_POPULATION = 0,
+    /** Cell-cycle updates and births. */
+    PROFILE_CELL_CYCLE,
+    /** The gland cell killers. */
+    PROFILE_KILLERS,
+    /** The population update: remeshing and tessellation. */
+    PROFILE_REMESH,
+    /** Scheduled epoch actions, including checkpoints. */
+    PROFILE_EPOCHS,
+    /** Position integration (self time), containing the two phases below. */
+    PROFILE_UPDATE_CELL_LOCATIONS,
+    /** Force evaluation. */
+    PROFILE_FORCES,
+    /** The GastricGlandSimulationBoundaryCondition. */
+    PROFILE_BOUNDARY_CONDITION,
+    /** The GlandBaseTrackingModifier. */
+    PROFILE_BASE_TRACKING,
+    /** The GlandMorphogenFieldModifier. */
+    PROFILE_FIELDS,
+    /** The population writers. */
+    PROFILE_OUTPUT,
+    PROFILE_NUM_PHASES
+} GlandProfilePhase;
+
+/**
+ * Wall-clock timers and counters for the phases of a gastric gland simulation.
+ *
+ * Components time themselves with a GlandProfileScope, which does nothing unless the
+ * profiler is enabled. The simulation marks the start of each time step, so that as well
+ * as run totals the profiler keeps a histogram of the time each phase takes per step.
+ */
+class GlandProfiler
+{
+public:
+
+    /** Number of histogram buckets; bucket i counts steps taking [2^(i-1), 2^i) microseconds. */
+    static const unsigned NUM_BUCKETS = 32;
+
+private:
+
+    /** The clock used for all timings. */
+    typedef std::chrono::steady_clock Clock;
+
+    /** Accumulated timings of one phase. */
+    struct PhaseRecord
+    {
+        /** Total time in the phase, in seconds. */
+        double totalTime;
+        /** Total time in the phase excluding nested phases, in seconds. */
+        double selfTime;
+        /** Time in the phase during the current step, in seconds. */
+        double stepTime;
+        /** Number of times the phase has run. */
+        unsigned long numCalls;
+        /** Histogram of per-step times. */
+        unsigned long histogram[NUM_BUCKETS];
+    };
+
+    /** A phase which has begun but not yet ended. */
+    struct OpenPhase
+    {
+        /** The phase. */
+        GlandProfilePhase phase;
+        /** When it began. */
+        Clock::time_point start;
+        /** Time spent in phases nested inside it so far, in seconds. */
+        double childTime;
+    };
+
+    /** Whether timers record anything. */
+    bool mEnabled;
+
+    /** Timings of each phase. */
+    PhaseRecord mPhases[PROFILE_NUM_PHASES];
+
+    /** Phases currently open, innermost last. */
+    std::vector<OpenPhase> mOpenPhases;
+
+    /** Whether a step has begun and not yet ended. */
+    bool mIsInStep;
+
+    /** When the current step began. */
+    Clock::time_point mStepStart;
+
+    /** Number of cells at the start of the current step. */
+    unsigned mStepNumCells;
+
+    /** Number of completed steps. */
+    unsigned long mNumSteps;
+
+    /** Sum over completed steps of the number of cells. */
+    double mNumCellSteps;
+
+    /** Total wall-clock time of completed steps, in seconds. */
+    double mTotalStepTime;
+
+    /** Histogram of whole-step times. */
+    unsigned long mStepHistogram[NUM_BUCKETS];
+
+    /**
+     * @param seconds a duration
+     * @return the histogram bucket for the duration
+     */
+    static unsigned GetBucket(double seconds);
+
+    /**
+     * Write a histogram as a JSON array of {"below_us", "count"} objects, skipping empty buckets.
+     *
+     * @param rStream the stream to write to
+     * @param pHistogram the histogram
+     */
+    static void WriteHistogram(std::ostream& rStream, const unsigned long* pHistogram);
+
+public:
+
+    /**
+     * Constructor. The profiler starts disabled.
+     */
+    GlandProfiler();
+
+    /**
+     * @return whether the profiler is recording
+     */
+    inline bool IsEnabled() const
+    {
+        return mEnabled;
+    }
+
+    /**
+     * Enable or disable the profiler.
+     *
+     * @param enabled whether to record timings
+     */
+    void SetEnabled(bool enabled);
+
+    /**
+     * Discard all recorded timings.
+     */
+    void Reset();
+
+    /**
+     * Start timing a phase. Must be matched by End() in reverse order of nesting.
+     *
+     * @param phase the phase
+     */
+    void Begin(GlandProfilePhase phase);
+
+    /**
+     * Stop timing the innermost open phase.
+     *
+     * @param phase the phase, which must be the innermost open one
+     */
+    void End(GlandProfilePhase phase);
+
+    /**
+     * Mark the start of a time step, ending the previous one if there is one.
+     *
+     * @param numCells the number of cells at the start of the step
+     */
+    void BeginStep(unsigned numCells);
+
+    /**
+     * End the current time step, if there is one, adding its times to the histograms.
+     */
+    void EndStep();
+
+    /**
+     * @param phase a phase
+     * @return the total time spent in the phase, in seconds
+     */
+    double GetTotalTime(GlandProfilePhase phase) const;
+
+    /**
+     * @param phase a phase
+     * @return the time spent in the phase excluding nested phases, in seconds
+     */
+    double GetSelfTime(GlandProfilePhase phase) const;
+
+    /**
+     * @return the number of completed steps
+     */
+    unsigned long GetNumSteps() const;
+
+    /**
+     * @return the number of cell updates per second of wall-clock time over completed steps
+     */
+    double GetCellsPerSecond() const;
+
+    /**
+     * @param phase a phase
+     * @return the name of the phase, as used in the summary
+     */
+    static std::string GetPhaseName(GlandProfilePhase phase);
+
+    /**
+     * Write a JSON summary of the run: per-phase totals and per-step histograms,
+     * whole-step histogram and throughput.
+     *
+     * @param rStream the stream to write to
+     */
+    void WriteSummary(std::ostream& rStream) const;
+};
+
+/**
+ * Times a GlandProfilePhase for as long as it is in scope. Costs a single test when
+ * the profiler is null or disabled.
+ */
+class GlandProfileScope
+{
+private:
+
+    /** The profiler being recorded to, or null if it is not recording. */
+    GlandProfiler* mpProfiler;
+
+    /** The phase being timed. */
+    GlandProfilePhase mPhase;
+
+public:
+
+    /**
+     * Constructor. Begins the phase.
+     *
+     * @param pProfiler the profiler, which may be null
+     * @param phase the phase to time
+     */
+    GlandProfileScope(GlandProfiler* pProfiler, GlandProfilePhase phase)
+        : mpProfiler((pProfiler && pProfiler->IsEnabled()) ? pProfiler : nullptr),
+          mPhase(phase)
+    {
+        if (mpProfiler)
+        {
+            mpProfiler->Begin(mPhase);
+        }
+    }
+
+    /**
+     * Destructor. Ends the phase.
+     */
+    ~GlandProfileScope()
+    {
+        if (mpProfiler)
+        {
+            mpProfiler->End(mPhase);
+        }
+    }
+};
+
+#endif /*GLANDPROFILER_HPP_*/
@@ -1,57 +1,323 @@
 #include <stdexcept>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <set>
 #include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
+#include <cmath>
+#include <limits>
 
 #include "Exception.hpp"
 
 #include "Parameters.hpp"
 
-template <typename T>
-inline void retrieve(const std::map<std::string, std::string>& map, const std::string& key, T& out)
+namespace
 {
-    if (map.find(key) != map.end())
+
+// Returns false, leaving rParsed unchanged, unless the whole value is a non-negative integer which fits
+bool tryParseUnsigned(const std::string& value, unsigned& rParsed)
+{
+    // strtoul would silently negate a leading minus sign
+    if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])))
+    {
+        return false;
+    }
+    char* p_end = nullptr;
+    errno = 0;
+    unsigned long parsed = std::strtoul(value.c_str(), &p_end, 10);
+    if (*p_end != '\0' || errno == ERANGE || parsed > std::numeric_limits<unsigned>::max())
+    {
+        return false;
+    }
+    rParsed = static_cast<unsigned>(parsed);
+    return true;
+}
+
+/**
+ * One entry of the parameter registry: a key and the member of GastricGlandParameters
+ * it sets. Exactly one of the member pointers is set, according to the type.
+ */
+struct ParameterEntry
+{
+    enum Type { STRING, UNSIGNED, DOUBLE, BOOL };
+
+    const char* mKey;
+    Type mType;
+    std::string GastricGlandParameters::* mpString;
+    unsigned GastricGlandParameters::* mpUnsigned;
+    double GastricGlandParameters::* mpDouble;
+    bool GastricGlandParameters::* mpBool;
+
+    ParameterEntry(const char* key, std::string GastricGlandParameters::* pMember)
+        : mKey(key), mType(STRING), mpString(pMember), mpUnsigned(nullptr), mpDouble(nullptr), mpBool(nullptr) {}
+    ParameterEntry(const char* key, unsigned GastricGlandParameters::* pMember)
+        : mKey(key), mType(UNSIGNED), mpString(nullptr), mpUnsigned(pMember), mpDouble(nullptr), mpBool(nullptr) {}
+    ParameterEntry(const char* key, double GastricGlandParameters::* pMember)
+        : mKey(key), mType(DOUBLE), mpString(nullptr), mpUnsigned(nullptr), mpDouble(pMember), mpBool(nullptr) {}
+    ParameterEntry(const char* key, bool GastricGlandParameters::* pMember)
+        : mKey(key), mType(BOOL), mpString(nullptr), mpUnsigned(nullptr), mpDouble(nullptr), mpBool(pMember) {}
+
+    const char* typeName() const
+    {
+        switch (mType)
+        {
+            case STRING:
+                return "a string";
+            case UNSIGNED:
+                return "a non-negative integer";
+            case DOUBLE:
+                return "a finite number";
+            case BOOL:
+                return "true or false";
+        }
+        return "";
+    }
+
+    // Returns false, leaving the parameters unchanged, if the value does not parse as this type
+    bool parse(GastricGlandParameters& rParams, const std::string& value) const
     {
-        std::stringstream ss(map.at(key));
-        ss >> out;
+        const char* p_begin = value.c_str();
+        char* p_end = nullptr;
+        errno = 0;
+        switch (mType)
+        {
+            case STRING:
+                rParams.*mpString = value;
+                return true;
+            case UNSIGNED:
+                return tryParseUnsigned(value, rParams.*mpUnsigned);
+            case DOUBLE:
+            {
+                double parsed = std::strtod(p_begin, &p_end);
+                if (value.empty() || *p_end != '\0' || errno == ERANGE || !std::isfinite(parsed))
+                {
+                    return false;
+                }
+                rParams.*mpDouble = parsed;
+                return true;
+            }
+            case BOOL:
+                // Flags are given as true/false as well as 1/0
+                if (value == "true" || value == "1")
+                {
+                    rParams.*mpBool = true;
+                    return true;
+                }
+                if (value == "false" || value == "0")
+                {
+                    rParams.*mpBool = false;
+                    return true;
+                }
+                return false;
+        }
+        return false;
+    }
+
+    std::string format(const GastricGlandParameters& rParams) const
+    {
+        std::stringstream ss;
+        switch (mType)
+        {
+            case STRING:
+                ss << '"' << rParams.*mpString << '"';
+                break;
+            case UNSIGNED:
+                ss << rParams.*mpUnsigned;
+                break;
+            case DOUBLE:
+                ss << rParams.*mpDouble;
+                break;
+            case BOOL:
+                ss << (rParams.*mpBool ? "true" : "false");
+                break;
+        }
+        return ss.str();
     }
+};
+
+// Every parameter, in the order they are listed by help()
+const std::vector<ParameterEntry>& parameterTable()
+{
+    static const std::vector<ParameterEntry> table = {
+        ParameterEntry("output-directory", &GastricGlandParameters::output_directory),
+        ParameterEntry("simulation-id", &GastricGlandParameters::simulation_id),
+        ParameterEntry("seed", &GastricGlandParameters::seed),
+        ParameterEntry("simulation-time", &GastricGlandParameters::simulation_time),
+        ParameterEntry("dt", &GastricGlandParameters::dt),
+        ParameterEntry("sampling-timestep-multiple", &GastricGlandParameters::sampling_timestep_multiple),
+        ParameterEntry("adaptive-dt", &GastricGlandParameters::adaptive_dt),
+        ParameterEntry("min-dt", &GastricGlandParameters::min_dt),
+        ParameterEntry("max-dt", &GastricGlandParameters::max_dt),
+        ParameterEntry("adaptive-displacement", &GastricGlandParameters::adaptive_displacement),
+        ParameterEntry("num-epochs", &GastricGlandParameters::num_epochs),
+        ParameterEntry("checkpoint-epochs", &GastricGlandParameters::checkpoint_epochs),
+        ParameterEntry("checkpoint-format", &GastricGlandParameters::checkpoint_format),
+        ParameterEntry("num-threads", &GastricGlandParameters::num_threads),
+        ParameterEntry("legacy-text-output", &GastricGlandParameters::legacy_text_output),
+        ParameterEntry("async-output", &GastricGlandParameters::async_output),
+        ParameterEntry("profile", &GastricGlandParameters::profile),
+        ParameterEntry("warm-start-cache", &GastricGlandParameters::warm_start_cache),
+        ParameterEntry("burn-in-time", &GastricGlandParameters::burn_in_time),
+        ParameterEntry("resume-from", &GastricGlandParameters::resume_from),
+        ParameterEntry("resume-time", &GastricGlandParameters::resume_time),
+
+        ParameterEntry("num-cells-across", &GastricGlandParameters::num_cells_across),
+        ParameterEntry("num-cells-high", &GastricGlandParameters::num_cells_high),
+        ParameterEntry("num-ghost-layers", &GastricGlandParameters::num_ghost_layers),
+        ParameterEntry("gland-height", &GastricGlandParameters::gland_height),
+        ParameterEntry("max-cells", &GastricGlandParameters::max_cells),
+
+        ParameterEntry("base-height", &GastricGlandParameters::base_height),
+        ParameterEntry("isthmus-begin-height", &GastricGlandParameters::isthmus_begin_height),
+        ParameterEntry("isthmus-end-height", &GastricGlandParameters::isthmus_end_height),
+
+        ParameterEntry("label-ancestors", &GastricGlandParameters::label_ancestors),
+        ParameterEntry("damping-constant", &GastricGlandParameters::damping_constant),
+        ParameterEntry("use-area-based-damping-constant", &GastricGlandParameters::use_area_based_damping_constant),
+        ParameterEntry("use-edge-based-spring-constant", &GastricGlandParameters::use_edge_based_spring_constant),
+        ParameterEntry("use-gland-spring-force", &GastricGlandParameters::use_gland_spring_force),
+
+        ParameterEntry("foveolar-cell-size-multiplier", &GastricGlandParameters::foveolar_cell_size_multiplier),
+        ParameterEntry("use-foveolar-max-age", &GastricGlandParameters::use_foveolar_max_age),
+        ParameterEntry("foveolar-cell-max-age", &GastricGlandParameters::foveolar_cell_max_age),
+        ParameterEntry("use-sloughing", &GastricGlandParameters::use_sloughing),
+        ParameterEntry("base-g1-duration", &GastricGlandParameters::base_g1_duration),
+        ParameterEntry("isthmus-g1-duration", &GastricGlandParameters::isthmus_g1_duration),
+
+        ParameterEntry("use-bmp-field", &GastricGlandParameters::use_bmp_field),
+        ParameterEntry("field-diffusivity", &GastricGlandParameters::field_diffusivity),
+        ParameterEntry("field-decay-rate", &GastricGlandParameters::field_decay_rate),
+        ParameterEntry("field-secretion-rate", &GastricGlandParameters::field_secretion_rate),
+        ParameterEntry("field-grid-spacing", &GastricGlandParameters::field_grid_spacing),
+        ParameterEntry("field-dt", &GastricGlandParameters::field_dt),
+
+        ParameterEntry("do-parietal-killing-experiment", &GastricGlandParameters::do_parietal_killing_experiment),
+        ParameterEntry("parietal-killing-experiment-time", &GastricGlandParameters::parietal_killing_experiment_time),
+        ParameterEntry("parietal-killing-ratio", &GastricGlandParameters::parietal_killing_ratio)
+    };
+    return table;
+}
+
+bool entryKeyLess(const ParameterEntry* pEntry, const std::string& key)
+{
+    return key.compare(pEntry->mKey) > 0;
 }
 
+// The table sorted by key, for lookups by binary search
+const std::vector<const ParameterEntry*>& sortedParameterIndex()
+{
+    static const std::vector<const ParameterEntry*> index = []()
+    {
+        std::vector<const ParameterEntry*> sorted;
+        for (const ParameterEntry& r_entry : parameterTable())
+        {
+            sorted.push_back(&r_entry);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const ParameterEntry* pA, const ParameterEntry* pB)
+        {
+            return std::string(pA->mKey) < pB->mKey;
+        });
+        return sorted;
+    }();
+    return index;
+}
+
+const ParameterEntry* findParameter(const std::string& key)
+{
+    const std::vector<const ParameterEntry*>& r_index = sortedParameterIndex();
+    auto it = std::lower_bound(r_index.begin(), r_index.end(), key, entryKeyLess);
+    if (it == r_index.end() || key != (*it)->mKey)
+    {
+        return nullptr;
+    }
+    return *it;
+}
+
+std::vector<std::string> sortedKeys()
+{
+    std::vector<std::string> keys;
+    for (const ParameterEntry* p_entry : sortedParameterIndex())
+    {
+        keys.push_back(p_entry->mKey);
+    }
+    return keys;
+}
+
+} // namespace
+
 void GastricGlandParameters::update(const std::map<std::string, std::string>& map)
 {
-    retrieve<std::string>(map, "output-directory", output_directory);
-    retrieve<std::string>(map, "simulation-id", simulation_id);
-    retrieve<unsigned>(map, "seed", seed);
-    retrieve<double>(map, "simulation-time", simulation_time);
-    retrieve<double>(map, "dt", dt);
-    retrieve<unsigned>(map, "sampling-timestep-multiple", sampling_timestep_multiple);
-    
-    retrieve<unsigned>(map, "num-cells-across", num_cells_across);
-    retrieve<unsigned>(map, "num-cells-high", num_cells_high);
-    retrieve<unsigned>(map, "num-ghost-layers", num_ghost_layers);
-    retrieve<double>(map, "gland-height", gland_height);
-    retrieve<unsigned>(map, "max-cells", max_cells);
-
-    retrieve<double>(map, "base-height", base_height);
-    retrieve<double>(map, "isthmus-begin-height", isthmus_begin_height);
-    retrieve<double>(map, "isthmus-end-height", isthmus_end_height);
-
-    retrieve<bool>(map, "label-ancestors", label_ancestors);
-    retrieve<double>(map, "damping-constant", damping_constant);
-    retrieve<bool>(map, "use-area-based-damping-constant", use_area_based_damping_constant);
-    retrieve<bool>(map, "use-edge-based-spring-constant", use_edge_based_spring_constant);
-
-    retrieve<double>(map, "foveolar-cell-size-multiplier", foveolar_cell_size_multiplier);
-    retrieve<bool>(map, "use-foveolar-max-age", use_foveolar_max_age);
-    retrieve<double>(map, "foveolar-cell-max-age", foveolar_cell_max_age);
-    retrieve<bool>(map, "use-sloughing", use_sloughing);
-    retrieve<double>(map, "base-g1-duration", base_g1_duration);
-    retrieve<double>(map, "isthmus-g1-duration", isthmus_g1_duration);
-
-    retrieve<bool>(map, "do-parietal-killing-experiment", do_parietal_killing_experiment);
-    retrieve<double>(map, "parietal-killing-experiment-time", parietal_killing_experiment_time);
-    retrieve<double>(map, "parietal-killing-ratio", parietal_killing_ratio);
+    validate(map);
+
+    // Report every bad value at once, rather than one per attempt
+    std::stringstream errors;
+    for (const auto& p : map)
+    {
+        const ParameterEntry* p_entry = findParameter(p.first);
+        if (!p_entry->parse(*this, p.second))
+        {
+            errors << "    " << p.first << "=" << p.second << ": expected " << p_entry->typeName() << std::endl;
+        }
+    }
+    if (!errors.str().empty())
+    {
+        EXCEPTION("Invalid values passed for GastricGlandParameters: \n" + errors.str());
+    }
+
+    check();
+}
+
+void GastricGlandParameters::check() const
+{
+    std::stringstream errors;
+    if (!(dt > 0.0))
+    {
+        errors << "    dt must be positive" << std::endl;
+    }
+    if (simulation_time < 0.0)
+    {
+        errors << "    simulation-time must not be negative" << std::endl;
+    }
+    if (sampling_timestep_multiple == 0)
+    {
+        errors << "    sampling-timestep-multiple must be at least 1" << std::endl;
+    }
+    if (adaptive_dt && !(min_dt > 0.0 && min_dt <= max_dt && adaptive_displacement > 0.0))
+    {
+        errors << "    adaptive-dt needs 0 < min-dt <= max-dt and a positive adaptive-displacement" << std::endl;
+    }
+    if (!(gland_height > 0.0))
+    {
+        errors << "    gland-height must be positive" << std::endl;
+    }
+    if (isthmus_begin_height > isthmus_end_height)
+    {
+        errors << "    isthmus-begin-height must not be above isthmus-end-height" << std::endl;
+    }
+    // Caches and checkpoints are read and written through OutputFileHandler, which only works below CHASTE_TEST_OUTPUT
+    if (!warm_start_cache.empty() && warm_start_cache[0] == '/')
+    {
+        errors << "    warm-start-cache must be relative to CHASTE_TEST_OUTPUT, not an absolute path" << std::endl;
+    }
+    if (!resume_from.empty() && resume_from[0] == '/')
+    {
+        errors << "    resume-from must be relative to CHASTE_TEST_OUTPUT, not an absolute path" << std::endl;
+    }
+    if (use_bmp_field && !(field_diffusivity >= 0.0 && field_decay_rate >= 0.0
+                           && field_grid_spacing > 0.0 && field_dt > 0.0))
+    {
+        errors << "    use-bmp-field needs non-negative field-diffusivity and field-decay-rate, "
+               << "and positive field-grid-spacing and field-dt" << std::endl;
+    }
+    if (!errors.str().empty())
+    {
+        EXCEPTION("Inconsistent GastricGlandParameters: \n" + errors.str());
+    }
 }
 
 std::ostream& operator<<(std::ostream& os, const GastricGlandParameters& p)
@@ -64,6 +330,21 @@ std::ostream& operator<<(std::ostream& os, const GastricGlandParameters& p)
     os << "    simulation-time: " << p.simulation_time << std::endl;
     os << "    dt: " << p.dt << std::endl;
     os << "    sampling-timestep-multiple: " << p.sampling_timestep_multiple << std::endl;
+    os << "    adaptive-dt: " << p.adaptive_dt << std::endl;
+    os << "    min-dt: " << p.min_dt << std::endl;
+    os << "    max-dt: " << p.max_dt << std::endl;
+    os << "    adaptive-displacement: " << p.adaptive_displacement << std::endl;
+    os << "    num-epochs: " << p.num_epochs << std::endl;
+    os << "    checkpoint-epochs: " << p.checkpoint_epochs << std::endl;
+    os << "    checkpoint-format: " << p.checkpoint_format << std::endl;
+    os << "    num-threads: " << p.num_threads << std::endl;
+    os << "    legacy-text-output: " << p.legacy_text_output << std::endl;
+    os << "    async-output: " << p.async_output << std::endl;
+    os << "    profile: " << p.profile << std::endl;
+    os << "    warm-start-cache: " << p.warm_start_cache << std::endl;
+    os << "    burn-in-time: " << p.burn_in_time << std::endl;
+    os << "    resume-from: " << p.resume_from << std::endl;
+    os << "    resume-time: " << p.resume_time << std::endl;
 
     os << "\nGland Config:" << std::endl;
     os << "    num-cells-across: " << p.num_cells_across << std::endl;
@@ -85,6 +366,15 @@ std::ostream& operator<<(std::ostream& os, const GastricGlandParameters& p)
     os << "    damping-constant: " << p.damping_constant << std::endl;
     os << "    use-area-based-damping-constant: " << p.use_area_based_damping_constant << std::endl;
     os << "    use-edge-based-spring-constant: " << p.use_edge_based_spring_constant << std::endl;
+    os << "    use-gland-spring-force: " << p.use_gland_spring_force << std::endl;
+
+    os << "\nBMP Field:" << std::endl;
+    os << "    use-bmp-field: " << p.use_bmp_field << std::endl;
+    os << "    field-diffusivity: " << p.field_diffusivity << std::endl;
+    os << "    field-decay-rate: " << p.field_decay_rate << std::endl;
+    os << "    field-secretion-rate: " << p.field_secretion_rate << std::endl;
+    os << "    field-grid-spacing: " << p.field_grid_spacing << std::endl;
+    os << "    field-dt: " << p.field_dt << std::endl;
 
     os << "\nParietal Cell Killing Experiment:" << std::endl;
     os << "    do-parietal-killing-experiment: " << p.do_parietal_killing_experiment << std::endl;
@@ -94,29 +384,67 @@ std::ostream& operator<<(std::ostream& os, const GastricGlandParameters& p)
     return os;
 }
 
-const std::vector<std::string> GastricGlandParameters::valid_keys = {
-    "output-directory", "simulation-id", "seed", "simulation-time",
-    "dt", "sampling-timestep-multiple",
+const std::vector<std::string> GastricGlandParameters::valid_keys = sortedKeys();
 
-    "num-cells-across", "num-cells-high", "num-ghost-layers", "gland-height", "max-cells",
-    "base-height", "isthmus-begin-height", "isthmus-end-height",
+std::string GastricGlandParameters::warmStartKey() const
+{
+    std::stringstream ss;
+    ss.precision(17);
+    ss << "v1"
+       << ";dt=" << dt
+       << ";burn-in-time=" << burn_in_time
+       << ";num-cells-across=" << num_cells_across
+       << ";num-cells-high=" << num_cells_high
+       << ";num-ghost-layers=" << num_ghost_layers
+       << ";gland-height=" << gland_height
+       << ";max-cells=" << max_cells
+       << ";base-height=" << base_height
+       << ";isthmus-begin-height=" << isthmus_begin_height
+       << ";isthmus-end-height=" << isthmus_end_height
+       << ";damping-constant=" << damping_constant
+       << ";use-area-based-damping-constant=" << use_area_based_damping_constant
+       << ";use-edge-based-spring-constant=" << use_edge_based_spring_constant
+       << ";use-gland-spring-force=" << use_gland_spring_force
+       << ";foveolar-cell-size-multiplier=" << foveolar_cell_size_multiplier
+       << ";use-foveolar-max-age=" << use_foveolar_max_age
+       << ";foveolar-cell-max-age=" << foveolar_cell_max_age
+       << ";use-sloughing=" << use_sloughing
+       << ";base-g1-duration=" << base_g1_duration
+       << ";isthmus-g1-duration=" << isthmus_g1_duration;
+
+    // Only appended when enabled, so that caches built without the field keep their keys
+    if (use_bmp_field)
+    {
+        ss << ";use-bmp-field=" << use_bmp_field
+           << ";field-diffusivity=" << field_diffusivity
+           << ";field-decay-rate=" << field_decay_rate
+           << ";field-secretion-rate=" << field_secretion_rate
+           << ";field-grid-spacing=" << field_grid_spacing
+           << ";field-dt=" << field_dt;
+    }
 
-    "foveolar-cell-size-multiplier", "use-foveolar-max-age", "foveolar-cell-max-age",
-    "use-sloughing", "base-g1-duration", "isthmus-g1-duration",
-    "label-ancestors", "damping_constant", "use-area-based-damping-constant",
-    "use-edge-based-spring-constant",
+    // 64-bit FNV-1a
+    const std::string key = ss.str();
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
 
-    "do-parietal-killing-experiment", "parietal-killing-experiment-time",
-    "parietal-killing-ratio"
-};
+    std::stringstream name;
+    name << "gland_" << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name.str();
+}
 
 std::string GastricGlandParameters::help()
 {
+    const GastricGlandParameters defaults;
     std::stringstream ss;
-    ss << "Vaild keys for GastricGlandParameters:" << std::endl;
-    for (const std::string& s : GastricGlandParameters::valid_keys)
+    ss << "Valid keys for GastricGlandParameters, with their defaults:" << std::endl;
+    for (const ParameterEntry& r_entry : parameterTable())
     {
-        ss << "    \"" << s << '"' << std::endl;
+        ss << "    " << std::left << std::setw(36) << r_entry.mKey << r_entry.format(defaults) << std::endl;
     }
     return ss.str();
 }
@@ -125,6 +453,7 @@ bool is_whitespace(const char letter)
 {
     return (letter == ' ')
         || (letter == '\t')
+        || (letter == '\r')
         || (letter == '\n');
 }
 
@@ -133,12 +462,12 @@ void remove_trailing_whitespace(std::string& str)
     auto pos = str.cend();
 
     // Iterate backwards until non-whitespace character is found
-    while (is_whitespace(*--pos));
-
-    // pos is off by one
-    pos++;
+    while (pos != str.cbegin() && is_whitespace(*(pos - 1)))
+    {
+        pos--;
+    }
 
-    // Erase trailing whitespace and return string
+    // Erase trailing whitespace
     str.erase(pos, str.cend());
 }
 
@@ -146,13 +475,13 @@ void remove_leading_whitespace(std::string& str)
 {
     auto pos = str.cbegin();
 
-    // Iterate backwards until non-whitespace character is found
-    while (is_whitespace(*pos))
+    // Iterate forwards until non-whitespace character is found
+    while (pos != str.cend() && is_whitespace(*pos))
     {
         pos++;
     }
 
-    // Erase trailing whitespace and return string
+    // Erase leading whitespace
     str.erase(str.cbegin(), pos);
 }
 
@@ -162,36 +491,47 @@ void remove_leading_trailing_whitespace(std::string& str)
     remove_trailing_whitespace(str);
 }
 
+unsigned parseUnsigned(const std::string& rValue, const std::string& rName)
+{
+    unsigned parsed;
+    if (!tryParseUnsigned(rValue, parsed))
+    {
+        EXCEPTION(rName + " must be a non-negative integer, not \"" + rValue + "\"");
+    }
+    return parsed;
+}
+
 std::map<std::string, std::string> makeMap(const std::string& input)
 {
     // Initialise dictionary
     std::map<std::string, std::string> dict;
 
-    std::stringstream ss(input);
-    std::string line;
-    while (std::getline(ss, line))
+    std::string::size_type begin = 0;
+    while (begin < input.size())
     {
-        // Split line by '='
-        std::stringstream line_ss(line);
-
-        std::string key;
-        std::getline(line_ss, key, '=');
+        std::string::size_type end = input.find('\n', begin);
+        if (end == std::string::npos)
+        {
+            end = input.size();
+        }
+        std::string line = input.substr(begin, end - begin);
+        begin = end + 1;
 
-        // Skip line if no '=' is found
-        if (line_ss.eof())
+        // Blank lines and comments are allowed, as in config files
+        remove_leading_trailing_whitespace(line);
+        if (line.empty() || line[0] == '#')
         {
             continue;
         }
 
-        // Because I skip when no '=' is found, and I am using a stringstream,
-        // it should not fail
-        if (!line_ss)
+        // Split line at the first '='
+        std::string::size_type equals = line.find('=');
+        if (equals == std::string::npos)
         {
-            NEVER_REACHED;
+            EXCEPTION("\"" + line + "\" is not a KEY=VALUE pair");
         }
-
-        std::string value;
-        std::getline(line_ss, value, '=');
+        std::string key = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
 
         // Remove leading and trailing whitespace
         remove_leading_trailing_whitespace(key);
@@ -199,31 +539,42 @@ std::map<std::string, std::string> makeMap(const std::string& input)
 
         if ((key.size() == 0) || (value.size() == 0))
         {
-            std::string error_msg;
-            error_msg += "\"";
-            error_msg += line;
-            error_msg += "\" is missing key or value";
-            EXCEPTION(error_msg);
+            EXCEPTION("\"" + line + "\" is missing key or value");
         }
 
         dict[key] = value;
     }
 
-    for (const auto& p : dict)
+    return dict;
+}
+
+std::map<std::string, std::string> readConfigFile(const std::string& rFileName)
+{
+    std::ifstream file(rFileName.c_str());
+    if (!file.is_open())
     {
-        std::cout << '"' << p.first << "\": \"" << p.second << '"' << std::endl;
+        EXCEPTION("Could not open config file " + rFileName);
     }
-    std::cout << std::endl;
+    std::stringstream contents;
+    contents << file.rdbuf();
 
-    return dict;
+    try
+    {
+        return makeMap(contents.str());
+    }
+    catch (const Exception& e)
+    {
+        EXCEPTION(rFileName + ": " + e.GetShortMessage());
+    }
 }
 
 void validate(const std::map<std::string, std::string>& map)
 {
+    // Both the map's keys and valid_keys are sorted
     std::vector<std::string> invalid_keys = std::vector<std::string>();
     std::vector<std::string> input_keys = std::vector<std::string>();
     for (const auto& p : map) input_keys.push_back(p.first);
-    
+
     std::set_difference(input_keys.cbegin(), input_keys.cend(),
         GastricGlandParameters::valid_keys.cbegin(), GastricGlandParameters::valid_keys.cend(),
         std::back_inserter(invalid_keys));
@@ -233,7 +584,7 @@ void validate(const std::map<std::string, std::string>& map)
         std::stringstream ss;
         ss << "Invalid arguments passed for GastricGlandParameters: " << std::endl;
         for (const std::string& s : invalid_keys) ss << "    \"" << s << '"' << std::endl;
-        ss << "Try runnnig with -h or --help for a list of valid keys." << std::endl;
+        ss << "Try running with -h or --help for a list of valid keys." << std::endl;
         EXCEPTION(ss.str());
     }
-}
\ No newline at end of file
+}
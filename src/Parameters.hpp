@@ -15,6 +15,22 @@ struct GastricGlandParameters
     double simulation_time = 100;
     double dt = 1.0/120.0;
     unsigned sampling_timestep_multiple = 12;
+    bool adaptive_dt = false;
+    double min_dt = 1.0/1200.0;
+    double max_dt = 1.0/30.0;
+    double adaptive_displacement = 0.05;
+    unsigned num_epochs = 4;
+    bool checkpoint_epochs = false;
+    std::string checkpoint_format = "gland";
+    unsigned num_threads = 1;
+    bool legacy_text_output = false;
+    bool async_output = true;
+    bool profile = false;
+    // warm_start_cache and resume_from are relative to CHASTE_TEST_OUTPUT, like output_directory
+    std::string warm_start_cache = "";
+    double burn_in_time = 50.0;
+    std::string resume_from = "";
+    double resume_time = 0.0;
 
     unsigned num_cells_across = 10;
     unsigned num_cells_high = 40;
@@ -30,6 +46,7 @@ struct GastricGlandParameters
     double damping_constant = 1.0;
     bool use_area_based_damping_constant = true;
     bool use_edge_based_spring_constant = false;
+    bool use_gland_spring_force = true;
 
     double foveolar_cell_size_multiplier = 0.8;
     bool use_foveolar_max_age = false;
@@ -38,23 +55,68 @@ struct GastricGlandParameters
     double base_g1_duration = 200;
     double isthmus_g1_duration = 10;
 
+    // BMP secreted by foveolar cells, diffusing on its own grid. Output only: nothing reads
+    // the BMP level yet, and the field's profile is written to bmp_field.dat
+    bool use_bmp_field = false;
+    double field_diffusivity = 1.0;
+    double field_decay_rate = 0.1;
+    double field_secretion_rate = 1.0;
+    double field_grid_spacing = 1.0;
+    double field_dt = 0.1;
 
     // Parietal Killing Experiment
     bool do_parietal_killing_experiment = false;
     double parietal_killing_experiment_time = 100;
     double parietal_killing_ratio = 0.4;
 
+    /**
+     * Set the parameters named in a map of KEY=VALUE pairs. Every key must be valid and
+     * every value must parse as its parameter's type; all problems are reported in one
+     * exception. The result is then checked with check().
+     */
     void update(const std::map<std::string, std::string>& map);
 
+    /**
+     * Throw if the parameters are inconsistent, e.g. a non-positive time step, listing
+     * every problem found.
+     */
+    void check() const;
+
     static std::string help();
 
+    /**
+     * @return a directory name identifying the warm start state for these parameters: a hash
+     *     of everything that shapes the burn-in, but not the seed or the run's output settings
+     */
+    std::string warmStartKey() const;
+
+    /** Every parameter key, sorted. */
     static const std::vector<std::string> valid_keys;
 };
 
 std::ostream& operator<<(std::ostream& os, const GastricGlandParameters& p);
 
+/**
+ * Parse a non-negative integer as the parameter registry does, rejecting signs, trailing
+ * text and values which do not fit; e.g. for command line options.
+ *
+ * @param rValue the text to parse
+ * @param rName the option or key it was given for, used in the error message
+ * @return the value
+ */
+unsigned parseUnsigned(const std::string& rValue, const std::string& rName);
+
+/**
+ * Split input into KEY=VALUE pairs, one per line. Blank lines and lines starting with '#'
+ * are skipped; any other line without '=' is an error. Later pairs override earlier ones.
+ */
 std::map<std::string, std::string> makeMap(const std::string& input);
 
+/**
+ * Read KEY=VALUE pairs from a config file, in the format accepted by makeMap().
+ */
+std::map<std::string, std::string> readConfigFile(const std::string& rFileName);
+
 bool is_whitespace(const char letter);
 void remove_trailing_whitespace(std::string& str);
 void remove_leading_whitespace(std::string& str);
@@ -34,41 +34,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "SignalGradient.hpp"
 
-/** Pointer to the single instance */
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::mpInstance = nullptr;
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::mpBmpInstance = nullptr;
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::mpEgfInstance = nullptr;
-
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::Instance()
-{
-    if (mpInstance == nullptr)
-    {
-        mpInstance = new SignalGradient;
-    }
-    return mpInstance;
-}
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::BmpInstance()
-{
-    if (mpBmpInstance == nullptr)
-    {
-        mpBmpInstance = new SignalGradient;
-    }
-    return mpBmpInstance;
-}
-template<unsigned DIM>
-SignalGradient<DIM>* SignalGradient<DIM>::EgfInstance()
-{
-    if (mpEgfInstance == nullptr)
-    {
-        mpEgfInstance = new SignalGradient;
-    }
-    return mpEgfInstance;
-}
+#include <algorithm>
 
 template<unsigned DIM>
 SignalGradient<DIM>::SignalGradient()
@@ -81,10 +47,13 @@ SignalGradient<DIM>::SignalGradient()
       mUseConstantValueForTesting(false),
       mConcentrationParameter(1.0),
       mCryptProjectionParameterA(0.5),
-      mCryptProjectionParameterB(2.0)
+      mCryptProjectionParameterB(2.0),
+      mpField(nullptr),
+      mUseTable(false),
+      mTableSize(1024),
+      mTableIsBuilt(false),
+      mTableScale(0.0)
 {
-    // Make sure there's only one instance - enforces correct serialization
-    assert(mpInstance == nullptr);
 }
 
 template<unsigned DIM>
@@ -93,35 +62,34 @@ SignalGradient<DIM>::~SignalGradient()
 }
 
 template<unsigned DIM>
-void SignalGradient<DIM>::Destroy()
+double SignalGradient<DIM>::GetLevel(CellPtr pCell)
 {
-    if (mpInstance)
-    {
-        delete mpInstance;
-        mpInstance = nullptr;
-    }
-    if (mpBmpInstance)
-    {
-        delete mpBmpInstance;
-        mpBmpInstance = nullptr;
-    }
-    if (mpEgfInstance)
+    if (mUseConstantValueForTesting)  // to test a cell and cell-cycle models without a cell population
     {
-        delete mpEgfInstance;
-        mpEgfInstance = nullptr;
+        return mConstantValueForTesting;
     }
+
+    assert(mpCellPopulation!=nullptr);
+    assert(mTypeSet);
+
+    return GetLevelAtLocation(mpCellPopulation->GetLocationOfCellCentre(pCell));
 }
 
 template<unsigned DIM>
-double SignalGradient<DIM>::GetLevel(CellPtr pCell)
+double SignalGradient<DIM>::GetLevelAtLocation(const c_vector<double, DIM>& rLocation)
 {
-    if (mUseConstantValueForTesting)  // to test a cell and cell-cycle models without a cell population
+    if (mUseConstantValueForTesting)
     {
         return mConstantValueForTesting;
     }
 
-    assert(mpCellPopulation!=nullptr);
-    assert(mTypeSet);
+    if (mType == SG_FIELD)
+    {
+        assert(mpField != nullptr);
+        return mpField->Sample(rLocation[0], rLocation[DIM-1]);
+    }
+
+    // Need to call SetCryptLength first
     assert(mLengthSet);
 
     double height;
@@ -130,11 +98,11 @@ double SignalGradient<DIM>::GetLevel(CellPtr pCell)
     {
         double a = GetCryptProjectionParameterA();
         double b = GetCryptProjectionParameterB();
-        height = a*pow(norm_2(mpCellPopulation->GetLocationOfCellCentre(pCell)), b);
+        height = a*pow(norm_2(rLocation), b);
     }
     else
     {
-        height = mpCellPopulation->GetLocationOfCellCentre(pCell)[DIM-1];
+        height = rLocation[DIM-1];
     }
 
     return GetLevel(height);
@@ -149,13 +117,25 @@ c_vector<double, DIM> SignalGradient<DIM>::GetGradient(CellPtr pCell)
     }
     assert(mpCellPopulation!=nullptr);
     assert(mTypeSet);
-    assert(mLengthSet);
+    assert(mLengthSet || mType == SG_FIELD);
 
     c_vector<double, DIM> location_of_cell = mpCellPopulation->GetLocationOfCellCentre(pCell);
 
     return GetGradient(location_of_cell);
 }
 
+template<unsigned DIM>
+void SignalGradient<DIM>::SetField(GlandMorphogenField* pField)
+{
+    mpField = pField;
+}
+
+template<unsigned DIM>
+GlandMorphogenField* SignalGradient<DIM>::GetField()
+{
+    return mpField;
+}
+
 template<unsigned DIM>
 void SignalGradient<DIM>::SetCellPopulation(AbstractCellPopulation<DIM>& rCellPopulation)
 {
@@ -180,11 +160,12 @@ void SignalGradient<DIM>::SetCryptLength(double cryptLength)
     assert(cryptLength > 0.0);
     if (mLengthSet==true)
     {
-        EXCEPTION("Destroy has not been called");
+        EXCEPTION("SignalGradient crypt length has already been set");
     }
 
     mCryptLength = cryptLength;
     mLengthSet = true;
+    mTableIsBuilt = false;
 }
 
 template<unsigned DIM>
@@ -198,10 +179,79 @@ void SignalGradient<DIM>::SetType(SignalGradientType type)
 {
     if (mTypeSet==true)
     {
-        EXCEPTION("Destroy has not been called");
+        EXCEPTION("SignalGradient type has already been set");
     }
     mType = type;
     mTypeSet = true;
+    mTableIsBuilt = false;
+}
+
+template<unsigned DIM>
+double SignalGradient<DIM>::GetSupportLength()
+{
+    if (mType==SG_EXPONENTIAL || mType==SG_NEGEXPONENTIAL)
+    {
+        return GetCryptLength();
+    }
+    return mConcentrationParameter*GetCryptLength();
+}
+
+template<unsigned DIM>
+double SignalGradient<DIM>::ComputeLevelInSupport(double height)
+{
+    switch (mType)
+    {
+        case SG_LINEAR:
+        case SG_RADIAL:
+            return 1.0 - height/(mConcentrationParameter*GetCryptLength());
+        case SG_EXPONENTIAL:
+            return exp(-height/(GetCryptLength()*mConcentrationParameter));
+        case SG_NEGLINEAR:
+            return height/(mConcentrationParameter*GetCryptLength());
+        case SG_NEGEXPONENTIAL:
+            return exp(-(GetCryptLength()-height)/(GetCryptLength()*mConcentrationParameter));
+        default:
+            return 0.0;
+    }
+}
+
+template<unsigned DIM>
+double SignalGradient<DIM>::ComputeDerivativeInSupport(double height)
+{
+    switch (mType)
+    {
+        case SG_LINEAR:
+        case SG_RADIAL:
+            return -1.0/(mConcentrationParameter*GetCryptLength());
+        case SG_EXPONENTIAL:
+            return -ComputeLevelInSupport(height)/(GetCryptLength()*mConcentrationParameter);
+        case SG_NEGLINEAR:
+            return 1.0/(mConcentrationParameter*GetCryptLength());
+        case SG_NEGEXPONENTIAL:
+            return ComputeLevelInSupport(height)/(GetCryptLength()*mConcentrationParameter);
+        default:
+            return 0.0;
+    }
+}
+
+template<unsigned DIM>
+void SignalGradient<DIM>::BuildTables()
+{
+    // Need to call SetCryptLength first
+    assert(mLengthSet);
+
+    const double support = GetSupportLength();
+    mTableScale = (mTableSize - 1.0)/support;
+    mLevelTable.resize(mTableSize);
+    mDerivativeTable.resize(mTableSize);
+    for (unsigned i=0; i<mTableSize; i++)
+    {
+        // The last entry is the limit from below, which is non-zero for the exponential types
+        double height = support*i/(mTableSize - 1.0);
+        mLevelTable[i] = ComputeLevelInSupport(height);
+        mDerivativeTable[i] = ComputeDerivativeInSupport(height);
+    }
+    mTableIsBuilt = true;
 }
 
 template<unsigned DIM>
@@ -212,63 +262,110 @@ double SignalGradient<DIM>::GetLevel(double height)
         return 0.0;
     }
 
+    if (mType == SG_FIELD)
+    {
+        assert(mpField != nullptr);
+        return mpField->GetMeanAtHeight(height);
+    }
+
     // Need to call SetCryptLength first
     assert(mLengthSet);
 
-    double wnt_level = -1.0; // Test this is changed before leaving method.
-
-    // The first type of Wnt concentration to try
-    if (mType==SG_LINEAR || mType==SG_RADIAL)
+    if (mUseTable)
     {
-        if ((height >= -1e-9) && (height < mConcentrationParameter*GetCryptLength()))
-        {
-            wnt_level = 1.0 - height/(mConcentrationParameter*GetCryptLength());
-        }
-        else
+        if (!mTableIsBuilt)
         {
-            wnt_level = 0.0;
+            BuildTables();
         }
+        return Interpolate(mLevelTable, height);
     }
 
-    if (mType==SG_EXPONENTIAL)
+    double wnt_level = 0.0;
+    if ((height >= -1e-9) && (height < GetSupportLength()))
     {
-        if ((height >= -1e-9) && (height < GetCryptLength()))
-        {
-            wnt_level = exp(-height/(GetCryptLength()*mConcentrationParameter));
-        }
-        else
+        wnt_level = ComputeLevelInSupport(height);
+    }
+
+    assert(wnt_level >= 0.0);
+
+    return wnt_level;
+}
+
+template<unsigned DIM>
+double SignalGradient<DIM>::GetLevelDerivative(double height)
+{
+    if (mType == SG_NONE)
+    {
+        return 0.0;
+    }
+
+    if (mType == SG_FIELD)
+    {
+        assert(mpField != nullptr);
+        return mpField->GetMeanGradientAtHeight(height);
+    }
+
+    // Need to call SetCryptLength first
+    assert(mLengthSet);
+
+    if (mUseTable)
+    {
+        if (!mTableIsBuilt)
         {
-            wnt_level = 0.0;
+            BuildTables();
         }
+        return Interpolate(mDerivativeTable, height);
     }
 
-    if (mType==SG_NEGLINEAR)
+    if ((height >= -1e-9) && (height < GetSupportLength()))
     {
-        if ((height >= -1e-9) && (height < mConcentrationParameter*GetCryptLength()))
+        return ComputeDerivativeInSupport(height);
+    }
+    return 0.0;
+}
+
+template<unsigned DIM>
+void SignalGradient<DIM>::GetLevels(const double* pHeights, double* pLevels, size_t n)
+{
+    if (mUseTable && mType != SG_NONE && mType != SG_FIELD)
+    {
+        if (!mTableIsBuilt)
         {
-            wnt_level = height/(mConcentrationParameter*GetCryptLength());
+            BuildTables();
         }
-        else
+        for (size_t i=0; i<n; i++)
         {
-            wnt_level = 0.0;
+            pLevels[i] = Interpolate(mLevelTable, pHeights[i]);
         }
+        return;
     }
 
-    if (mType==SG_NEGEXPONENTIAL)
+    for (size_t i=0; i<n; i++)
+    {
+        pLevels[i] = GetLevel(pHeights[i]);
+    }
+}
+
+template<unsigned DIM>
+void SignalGradient<DIM>::GetLevelDerivatives(const double* pHeights, double* pDerivatives, size_t n)
+{
+    if (mUseTable && mType != SG_NONE && mType != SG_FIELD)
     {
-        if ((height >= -1e-9) && (height < GetCryptLength()))
+        if (!mTableIsBuilt)
         {
-            wnt_level = exp(-(GetCryptLength()-height)/(GetCryptLength()*mConcentrationParameter));
+            BuildTables();
         }
-        else
+        for (size_t i=0; i<n; i++)
         {
-            wnt_level = 0.0;
+            pDerivatives[i] = Interpolate(mDerivativeTable, pHeights[i]);
         }
+        return;
     }
 
-    assert(wnt_level >= 0.0);
-
-    return wnt_level;
+    for (size_t i=0; i<n; i++)
+    {
+        pDerivatives[i] = GetLevelDerivative(pHeights[i]);
+    }
 }
 
 template<unsigned DIM>
@@ -278,12 +375,12 @@ c_vector<double, DIM> SignalGradient<DIM>::GetGradient(c_vector<double, DIM>& rL
 
     if (mType!=SG_NONE)
     {
-        if (mType==SG_LINEAR)
+        if (mType==SG_FIELD)
         {
-            if ((rLocation[DIM-1] >= -1e-9) && (rLocation[DIM-1] < mConcentrationParameter*GetCryptLength()))
-            {
-                wnt_gradient[DIM-1] = -1.0/(mConcentrationParameter*GetCryptLength());
-            }
+            assert(mpField != nullptr);
+            c_vector<double, 2> field_gradient = mpField->SampleGradient(rLocation[0], rLocation[DIM-1]);
+            wnt_gradient[0] = field_gradient[0];
+            wnt_gradient[DIM-1] = field_gradient[1];
         }
         else if (mType==SG_RADIAL) // RADIAL Wnt concentration
         {
@@ -304,16 +401,9 @@ c_vector<double, DIM> SignalGradient<DIM>::GetGradient(c_vector<double, DIM>& rL
                 wnt_gradient[i] = rLocation[i]*dwdr/r;
             }
         }
-        else if (mType == SG_NEGLINEAR)
-        {
-            if ((rLocation[DIM-1] >= -1e-9) && (rLocation[DIM-1] < mConcentrationParameter*GetCryptLength()))
-            {
-                wnt_gradient[DIM-1] = 1.0/(mConcentrationParameter*GetCryptLength());
-            }
-        }
         else
         {
-            EXCEPTION("No method to calculate gradient of this signal gradient type");
+            wnt_gradient[DIM-1] = GetLevelDerivative(rLocation[DIM-1]);
         }
     }
     return wnt_gradient;
@@ -323,7 +413,11 @@ template<unsigned DIM>
 bool SignalGradient<DIM>::IsSetUp()
 {
     bool result = false;
-    if (mTypeSet && mLengthSet && mpCellPopulation!=nullptr && mType!=SG_NONE)
+    if (mType==SG_FIELD)
+    {
+        result = mTypeSet && mpField!=nullptr && mpField->IsSetUp();
+    }
+    else if (mTypeSet && mLengthSet && mpCellPopulation!=nullptr && mType!=SG_NONE)
     {
         result = true;
     }
@@ -345,6 +439,24 @@ void SignalGradient<DIM>::SetConstantValueForTesting(double value)
     }
 }
 
+template<unsigned DIM>
+void SignalGradient<DIM>::SetUseTable(bool useTable, unsigned tableSize)
+{
+    if (tableSize < 2)
+    {
+        EXCEPTION("SignalGradient tables need at least two entries");
+    }
+    mUseTable = useTable;
+    mTableSize = tableSize;
+    mTableIsBuilt = false;
+}
+
+template<unsigned DIM>
+bool SignalGradient<DIM>::GetUseTable() const
+{
+    return mUseTable;
+}
+
 template<unsigned DIM>
 double SignalGradient<DIM>::GetConcentrationParameter()
 {
@@ -356,6 +468,7 @@ void SignalGradient<DIM>::SetConcentrationParameter(double concentrationParamete
 {
     assert(concentrationParameter > 0.0);
     mConcentrationParameter = concentrationParameter;
+    mTableIsBuilt = false;
 }
 
 template<unsigned DIM>
@@ -375,6 +488,7 @@ void SignalGradient<DIM>::SetCryptProjectionParameterA(double cryptProjectionPar
 {
     assert(cryptProjectionParameterA >= 0.0);
     mCryptProjectionParameterA = cryptProjectionParameterA;
+    mTableIsBuilt = false;
 }
 
 template<unsigned DIM>
@@ -382,6 +496,7 @@ void SignalGradient<DIM>::SetCryptProjectionParameterB(double cryptProjectionPar
 {
     assert(cryptProjectionParameterB >= 0.0);
     mCryptProjectionParameterB = cryptProjectionParameterB;
+    mTableIsBuilt = false;
 }
 
 // Explicit instantiation
@@ -37,18 +37,21 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define SIGNALGRADIENT_HPP_
 
 #include "ChasteSerialization.hpp"
-#include "SerializableSingleton.hpp"
-#include <boost/serialization/base_object.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <vector>
 
 #include "AbstractCellPopulation.hpp"
+#include "GlandMorphogenField.hpp"
 
 /**
  * Possible types of WntConcentration, currently:
  *  NONE - for testing and to remove Wnt dependence
  *  LINEAR - for cylindrical crypt model
  *  RADIAL - for crypt projection model
+ *  FIELD - sampled from a GlandMorphogenField at each location
  */
 
 
@@ -59,23 +62,21 @@ typedef enum SignalGradientType_
     SG_RADIAL,
     SG_EXPONENTIAL,
     SG_NEGLINEAR,
-    SG_NEGEXPONENTIAL
+    SG_NEGEXPONENTIAL,
+    SG_FIELD
 } SignalGradientType;
 
 
 /**
- *  Singleton Wnt concentration object.
+ * A signal (e.g. Wnt, BMP or EGF) concentration profile along the gland.
+ *
+ * Instances are owned by a GlandContext, so each simulation has its own signals.
  */
 template<unsigned DIM>
-class SignalGradient : public SerializableSingleton<SignalGradient<DIM> >
+class SignalGradient
 {
 private:
 
-    /** Pointer to the singleton instance of WntConcentration */
-    static SignalGradient* mpInstance;
-    static SignalGradient* mpBmpInstance;
-    static SignalGradient* mpEgfInstance;
-
     /**
      * The length of the crypt.
      */
@@ -140,6 +141,70 @@ private:
      */
     double mCryptProjectionParameterB;
 
+    /**
+     * For FIELD type: the field to sample. Not owned, and not archived; the GlandContext
+     * which owns both the signal and the field links them on construction.
+     */
+    GlandMorphogenField* mpField;
+
+    /** Whether GetLevel(double) and GetLevelDerivative() interpolate in tables. Not archived. */
+    bool mUseTable;
+
+    /** Number of equally spaced heights in each table. Not archived. */
+    unsigned mTableSize;
+
+    /** Whether the tables match the current type and parameters. */
+    bool mTableIsBuilt;
+
+    /** Reciprocal of the table spacing. */
+    double mTableScale;
+
+    /** The level at each table height, from 0 to GetSupportLength(). */
+    std::vector<double> mLevelTable;
+
+    /** The derivative of the level with respect to height at each table height. */
+    std::vector<double> mDerivativeTable;
+
+    /**
+     * @return the height below which the signal is non-zero
+     */
+    double GetSupportLength();
+
+    /**
+     * @param height a height between 0 and GetSupportLength()
+     * @return the level at this height
+     */
+    double ComputeLevelInSupport(double height);
+
+    /**
+     * @param height a height between 0 and GetSupportLength()
+     * @return the derivative of the level with respect to height at this height
+     */
+    double ComputeDerivativeInSupport(double height);
+
+    /**
+     * Fill the level and derivative tables for the current type and parameters.
+     */
+    void BuildTables();
+
+    /**
+     * Interpolate linearly in a table, without branching on the height.
+     *
+     * @param rTable the level or derivative table
+     * @param height the height
+     * @return the interpolated value, or zero outside the support
+     */
+    inline double Interpolate(const std::vector<double>& rTable, double height) const
+    {
+        const double max_position = mTableSize - 1.0;
+        double position = std::min(std::max(height*mTableScale, 0.0), max_position);
+        unsigned index = std::min(static_cast<unsigned>(position), mTableSize - 2);
+        double fraction = position - index;
+        double value = rTable[index] + fraction*(rTable[index+1] - rTable[index]);
+        bool in_support = (height >= -1e-9) & (height*mTableScale < max_position);
+        return in_support ? value : 0.0;
+    }
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -168,43 +233,60 @@ private:
         }
     }
 
-protected:
+public:
 
     /**
-     * Protected constuctor. Not to be called, use Instance() instead.
+     * Constructor.
      */
     SignalGradient();
 
-public:
+    /**
+     * Destructor.
+     */
+    virtual ~SignalGradient();
 
     /**
-     * Return a pointer to the WntConcentration object.
-     * The first time this is called, the object is created.
+     * Get the Wnt level at a given height in the crypt. For a FIELD signal this is the
+     * field averaged around the gland at this height.
      *
-     * @return  A pointer to the singleton WntConcentration object.
+     * @param height the height of the cell at which we want the Wnt concentration
+     * @return the Wnt concentration at this height in the crypt (dimensionless)
      */
-    static SignalGradient* Instance();
-    static SignalGradient* BmpInstance();
-    static SignalGradient* EgfInstance();
+    double GetLevel(double height);
 
     /**
-     * Destructor - frees up the singleton instance.
+     * Get the level at a given location, as GetLevel(CellPtr) gives for a cell there.
+     *
+     * @param rLocation the location
+     * @return the level at this location
      */
-    virtual ~SignalGradient();
+    double GetLevelAtLocation(const c_vector<double, DIM>& rLocation);
 
     /**
-     * Destroy the current WntConcentration instance.
-     *  Should be called at the end of a simulation.
+     * Get the derivative of the Wnt level with respect to height, for every type of gradient.
+     *
+     * @param height the height in the crypt
+     * @return the rate of change of the level with height, zero outside the support
      */
-    static void Destroy();
+    double GetLevelDerivative(double height);
 
     /**
-     * Get the Wnt level at a given height in the crypt.
+     * Get the levels at many heights at once.
      *
-     * @param height the height of the cell at which we want the Wnt concentration
-     * @return the Wnt concentration at this height in the crypt (dimensionless)
+     * @param pHeights the heights
+     * @param pLevels filled with the level at each height
+     * @param n the number of heights
      */
-    double GetLevel(double height);
+    void GetLevels(const double* pHeights, double* pLevels, size_t n);
+
+    /**
+     * Get the derivatives of the level with respect to height at many heights at once.
+     *
+     * @param pHeights the heights
+     * @param pDerivatives filled with the derivative at each height
+     * @param n the number of heights
+     */
+    void GetLevelDerivatives(const double* pHeights, double* pDerivatives, size_t n);
 
     /**
      * Get the Wnt level at a given cell in the crypt. The crypt
@@ -216,7 +298,8 @@ public:
     double GetLevel(CellPtr pCell);
 
     /**
-     * @return the Wnt gradient at a given location in the crypt.
+     * @return the Wnt gradient at a given location in the crypt. For every type but RADIAL
+     *     and FIELD this points along the height axis, with size GetLevelDerivative() of the height.
      *
      * @param rLocation  the location at which we want the Wnt gradient
      */
@@ -229,6 +312,18 @@ public:
      */
     c_vector<double, DIM> GetGradient(CellPtr pCell);
 
+    /**
+     * Set the field sampled by a FIELD signal.
+     *
+     * @param pField the field, which must outlive this signal
+     */
+    void SetField(GlandMorphogenField* pField);
+
+    /**
+     * @return the field sampled by a FIELD signal, or nullptr if none has been set
+     */
+    GlandMorphogenField* GetField();
+
     /**
      * Set the crypt. Must be called before GetWntLevel().
      *
@@ -279,7 +374,9 @@ public:
      * For archiving, and to let a CellBasedSimulation
      * find out whether whether a WntConcentration has
      * been set up or not, i.e. whether stem cells should
-     * be motile.
+     * be motile. A FIELD signal is set up once its field has
+     * a grid; it needs neither a crypt length nor a population,
+     * except to look up cells in GetLevel(CellPtr).
      *
      * @return whether the Wnt concentration is set up
      */
@@ -320,6 +417,23 @@ public:
      * @param cryptProjectionParameterB  the new value of mCryptProjectionParameterB
      */
     void SetCryptProjectionParameterB(double cryptProjectionParameterB);
+
+    /**
+     * Interpolate levels and derivatives in tables rather than evaluating them. The tables
+     * are built on the first lookup after the type or a parameter changes. With the default
+     * size the interpolation is exact for the linear types and accurate to about 1e-7 of
+     * the level for the exponential ones. The RADIAL projection onto height and the RADIAL
+     * gradient are still computed directly.
+     *
+     * @param useTable whether to use tables
+     * @param tableSize the number of heights in each table (at least 2; defaults to 1024)
+     */
+    void SetUseTable(bool useTable, unsigned tableSize=1024);
+
+    /**
+     * @return whether levels and derivatives are interpolated in tables
+     */
+    bool GetUseTable() const;
 };
 
 #endif /*SIGNALGRADIENTTYPE_HPP_*/
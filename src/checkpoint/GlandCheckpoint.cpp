@@ -0,0 +1,601 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CheckpointArchiveTypes.hpp"
+#include "GlandCheckpoint.hpp"
+
+#include "Exception.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "SimulationTime.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "CellId.hpp"
+#include "CellLabel.hpp"
+#include "CellAncestor.hpp"
+#include "CellData.hpp"
+#include "WntConcentration.hpp"
+#include "Cylindrical2dMesh.hpp"
+#include "TrianglesMeshReader.hpp"
+#include "TrianglesMeshWriter.hpp"
+
+#include "StemCellProliferativeType.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "DefaultCellProliferativeType.hpp"
+#include "BaseCellProliferativeType.hpp"
+#include "FoveolarCellProliferativeType.hpp"
+#include "NeckCellProliferativeType.hpp"
+#include "IsthmusCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "ApcOneHitCellMutationState.hpp"
+#include "ApcTwoHitCellMutationState.hpp"
+#include "BetaCateninOneHitCellMutationState.hpp"
+
+#include "GastricGlandSimulation2d.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "GastricGlandSimulationBoundaryCondition.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace
+{
+
+/**
+ * @param pCell a cell
+ * @return the checkpoint code of the cell's proliferative type
+ */
+uint8_t GetProliferativeTypeCode(CellPtr pCell)
+{
+    boost::shared_ptr<AbstractCellProliferativeType> p_type = pCell->GetCellProliferativeType();
+    if (p_type->IsType<StemCellProliferativeType>()) return 0;
+    if (p_type->IsType<TransitCellProliferativeType>()) return 1;
+    if (p_type->IsType<DifferentiatedCellProliferativeType>()) return 2;
+    if (p_type->IsType<DefaultCellProliferativeType>()) return 3;
+    if (p_type->IsType<BaseCellProliferativeType>()) return 4;
+    if (p_type->IsType<FoveolarCellProliferativeType>()) return 5;
+    if (p_type->IsType<NeckCellProliferativeType>()) return 6;
+    if (p_type->IsType<IsthmusCellProliferativeType>()) return 7;
+    EXCEPTION("GlandCheckpoint cannot save a cell of this proliferative type");
+}
+
+/**
+ * @param code the checkpoint code of a proliferative type
+ * @return the registered proliferative type
+ */
+boost::shared_ptr<AbstractCellProperty> GetProliferativeType(uint8_t code)
+{
+    CellPropertyRegistry* p_registry = CellPropertyRegistry::Instance();
+    switch (code)
+    {
+        case 0: return p_registry->Get<StemCellProliferativeType>();
+        case 1: return p_registry->Get<TransitCellProliferativeType>();
+        case 2: return p_registry->Get<DifferentiatedCellProliferativeType>();
+        case 3: return p_registry->Get<DefaultCellProliferativeType>();
+        case 4: return p_registry->Get<BaseCellProliferativeType>();
+        case 5: return p_registry->Get<FoveolarCellProliferativeType>();
+        case 6: return p_registry->Get<NeckCellProliferativeType>();
+        case 7: return p_registry->Get<IsthmusCellProliferativeType>();
+        default: EXCEPTION("Unknown proliferative type in gland checkpoint");
+    }
+}
+
+/**
+ * @param pCell a cell
+ * @return the checkpoint code of the cell's mutation state
+ */
+uint8_t GetMutationStateCode(CellPtr pCell)
+{
+    boost::shared_ptr<AbstractCellMutationState> p_state = pCell->GetMutationState();
+    if (p_state->IsType<WildTypeCellMutationState>()) return 0;
+    if (p_state->IsType<ApcOneHitCellMutationState>()) return 1;
+    if (p_state->IsType<ApcTwoHitCellMutationState>()) return 2;
+    if (p_state->IsType<BetaCateninOneHitCellMutationState>()) return 3;
+    EXCEPTION("GlandCheckpoint cannot save a cell with this mutation state");
+}
+
+/**
+ * @param code the checkpoint code of a mutation state
+ * @return the registered mutation state
+ */
+boost::shared_ptr<AbstractCellProperty> GetMutationState(uint8_t code)
+{
+    CellPropertyRegistry* p_registry = CellPropertyRegistry::Instance();
+    switch (code)
+    {
+        case 0: return p_registry->Get<WildTypeCellMutationState>();
+        case 1: return p_registry->Get<ApcOneHitCellMutationState>();
+        case 2: return p_registry->Get<ApcTwoHitCellMutationState>();
+        case 3: return p_registry->Get<BetaCateninOneHitCellMutationState>();
+        default: EXCEPTION("Unknown mutation state in gland checkpoint");
+    }
+}
+
+} // namespace
+
+template<typename T>
+void GlandCheckpoint::WriteValue(std::ostream& rStream, const T& value)
+{
+    rStream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T GlandCheckpoint::ReadValue(std::istream& rStream)
+{
+    T value;
+    rStream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+template<typename T>
+void GlandCheckpoint::WriteColumn(std::ostream& rStream, const std::vector<T>& rColumn)
+{
+    rStream.write(reinterpret_cast<const char*>(rColumn.data()), rColumn.size()*sizeof(T));
+}
+
+template<typename T>
+void GlandCheckpoint::ReadColumn(std::istream& rStream, std::vector<T>& rColumn, unsigned numEntries)
+{
+    rColumn.resize(numEntries);
+    rStream.read(reinterpret_cast<char*>(rColumn.data()), numEntries*sizeof(T));
+}
+
+void GlandCheckpoint::WriteString(std::ostream& rStream, const std::string& rString)
+{
+    WriteValue<uint32_t>(rStream, rString.size());
+    rStream.write(rString.data(), rString.size());
+}
+
+std::string GlandCheckpoint::ReadString(std::istream& rStream)
+{
+    uint32_t length = ReadValue<uint32_t>(rStream);
+    if (!rStream)
+    {
+        return std::string();
+    }
+    std::string string(length, '\0');
+    rStream.read(&string[0], length);
+    return string;
+}
+
+std::string GlandCheckpoint::GetCheckpointName(double time)
+{
+    // Matches the time stamps of CellBasedSimulationArchiver
+    std::ostringstream name;
+    name << "gland_checkpoint_at_time_" << time;
+    return name.str();
+}
+
+GlandCheckpointFormat GlandCheckpoint::ParseFormat(const std::string& rName)
+{
+    if (rName == "gland")
+    {
+        return CHECKPOINT_FORMAT_GLAND;
+    }
+    if (rName == "boost")
+    {
+        return CHECKPOINT_FORMAT_BOOST;
+    }
+    EXCEPTION("Unknown checkpoint format \"" + rName + "\"; expected gland or boost");
+}
+
+std::string GlandCheckpoint::GetFormatName(GlandCheckpointFormat format)
+{
+    return (format == CHECKPOINT_FORMAT_GLAND) ? "gland" : "boost";
+}
+
+void GlandCheckpoint::Save(GastricGlandSimulation2d& rSimulation)
+{
+    GastricGlandCellPopulation<2>* p_population = dynamic_cast<GastricGlandCellPopulation<2>*>(&rSimulation.rGetCellPopulation());
+    if (p_population == nullptr)
+    {
+        EXCEPTION("GlandCheckpoint can only save simulations of a GastricGlandCellPopulation");
+    }
+    Cylindrical2dMesh* p_mesh = dynamic_cast<Cylindrical2dMesh*>(&p_population->rGetMesh());
+    if (p_mesh == nullptr)
+    {
+        EXCEPTION("GlandCheckpoint can only save simulations on a Cylindrical2dMesh");
+    }
+    if (p_mesh->GetNumAllNodes() != p_mesh->GetNumNodes())
+    {
+        EXCEPTION("GlandCheckpoint cannot save a mesh with deleted nodes; save after the population has been updated");
+    }
+
+    // Gather the cells first, so that nothing is written for a simulation we cannot save
+    std::list<CellPtr>& r_cells = p_population->rGetCells();
+    GlandCheckpointCells cells;
+    std::vector<std::vector<std::string> > data_keys;
+    std::vector<std::vector<double> > data_values;
+    for (std::list<CellPtr>::iterator cell_iter = r_cells.begin(); cell_iter != r_cells.end(); ++cell_iter)
+    {
+        CellPtr p_cell = *cell_iter;
+        if (p_cell->IsDead() || p_cell->HasApoptosisBegun())
+        {
+            EXCEPTION("GlandCheckpoint cannot save dead or apoptotic cells; use the boost checkpoint format");
+        }
+        GastricGlandCellCycleModelV2* p_model = dynamic_cast<GastricGlandCellCycleModelV2*>(p_cell->GetCellCycleModel());
+        if (p_model == nullptr)
+        {
+            EXCEPTION("GlandCheckpoint can only save GastricGlandCellCycleModelV2 cells; use the boost checkpoint format");
+        }
+
+        cells.locationIndices.push_back(p_population->GetLocationIndexUsingCell(p_cell));
+        cells.cellIds.push_back(p_cell->GetCellId());
+        cells.types.push_back(GetProliferativeTypeCode(p_cell));
+        cells.mutationStates.push_back(GetMutationStateCode(p_cell));
+        cells.labels.push_back(p_cell->HasCellProperty<CellLabel>());
+        cells.ancestors.push_back(p_cell->GetAncestor());
+
+        // Read the phase and division flag directly: their getters advance the cell cycle
+        cells.birthTimes.push_back(p_model->GetBirthTime());
+        cells.g1Durations.push_back(p_model->mG1Duration);
+        cells.phases.push_back(p_model->mCurrentCellCyclePhase);
+        cells.readyToDivide.push_back(p_model->mReadyToDivide);
+        cells.zones.push_back(p_model->GetZone());
+        cells.baseG1Durations.push_back(p_model->GetBaseG1Duration());
+        cells.isthmusG1Durations.push_back(p_model->GetIsthmusG1Duration());
+        cells.stemG1Durations.push_back(p_model->GetStemCellG1Duration());
+        cells.transitG1Durations.push_back(p_model->GetTransitCellG1Duration());
+        cells.sDurations.push_back(p_model->GetSDuration());
+        cells.g2Durations.push_back(p_model->GetG2Duration());
+        cells.mDurations.push_back(p_model->GetMDuration());
+        cells.minimumGapDurations.push_back(p_model->GetMinimumGapDuration());
+
+        boost::shared_ptr<CellData> p_data = p_cell->GetCellData();
+        data_keys.push_back(p_data->GetKeys());
+        data_values.push_back(std::vector<double>());
+        for (const std::string& r_key : data_keys.back())
+        {
+            data_values.back().push_back(p_data->GetItem(r_key));
+        }
+    }
+
+    std::string archive_directory = rSimulation.GetOutputDirectory() + "/archive/";
+    std::string name = GetCheckpointName(SimulationTime::Instance()->GetTime());
+
+    TrianglesMeshWriter<2,2> mesh_writer(archive_directory, name + "_mesh", false);
+    mesh_writer.SetWriteFilesAsBinary();
+    mesh_writer.WriteFilesUsingMesh(*p_mesh);
+
+    std::string time_state;
+    std::string rng_state;
+    std::string context_state;
+    {
+        std::ostringstream stream;
+        boost::archive::text_oarchive archive(stream);
+        const SimulationTime& r_time = *SimulationTime::Instance();
+        archive << r_time;
+        stream.flush();
+        time_state = stream.str();
+    }
+    {
+        std::ostringstream stream;
+        boost::archive::text_oarchive archive(stream);
+        const RandomNumberGenerator& r_gen = *RandomNumberGenerator::Instance();
+        archive << r_gen;
+        stream.flush();
+        rng_state = stream.str();
+    }
+    {
+        std::ostringstream stream;
+        boost::archive::text_oarchive archive(stream);
+        const GlandContext<2>& r_context = rSimulation.rGetGlandContext();
+        archive << r_context;
+        stream.flush();
+        context_state = stream.str();
+    }
+
+    WntConcentration<2>* p_wnt = WntConcentration<2>::Instance();
+    uint32_t wnt_type = p_wnt->GetType();
+    double crypt_length = (p_wnt->GetType() == NONE) ? 0.0 : p_wnt->GetCryptLength();
+
+    OutputFileHandler handler(archive_directory, false);
+    out_stream p_file = handler.OpenOutputFile(name + ".gchk", std::ios::out | std::ios::trunc | std::ios::binary);
+
+    p_file->write(GLAND_CHECKPOINT_MAGIC, std::strlen(GLAND_CHECKPOINT_MAGIC));
+    WriteValue<uint32_t>(*p_file, GLAND_CHECKPOINT_FORMAT_VERSION);
+
+    WriteString(*p_file, time_state);
+    WriteString(*p_file, rng_state);
+    WriteString(*p_file, context_state);
+    WriteValue<uint32_t>(*p_file, wnt_type);
+    WriteValue<double>(*p_file, crypt_length);
+
+    WriteValue<double>(*p_file, rSimulation.GetDt());
+    WriteValue<uint32_t>(*p_file, rSimulation.GetCellAncestorIndex());
+    WriteValue<uint32_t>(*p_file, rSimulation.GetMaxCells());
+    WriteValue<uint32_t>(*p_file, rSimulation.mNumBirths);
+    WriteValue<uint32_t>(*p_file, rSimulation.mNumDeaths);
+
+    WriteValue<double>(*p_file, p_mesh->GetWidth(0));
+    WriteValue<double>(*p_file, p_population->GetMitosisRequiredSize());
+    WriteValue<double>(*p_file, p_population->GetFoveolarSizeMultiplier());
+    WriteValue<double>(*p_file, p_population->mGhostSpringStiffness);
+
+    // The id counter is shared by all cells, so an unassigned id reads it without advancing it
+    MAKE_PTR(CellId, p_counter);
+    WriteValue<uint32_t>(*p_file, p_counter->GetMaxCellId());
+    WriteValue<uint32_t>(*p_file, cells.cellIds.size());
+
+    WriteColumn(*p_file, cells.locationIndices);
+    WriteColumn(*p_file, cells.cellIds);
+    WriteColumn(*p_file, cells.types);
+    WriteColumn(*p_file, cells.mutationStates);
+    WriteColumn(*p_file, cells.labels);
+    WriteColumn(*p_file, cells.ancestors);
+    WriteColumn(*p_file, cells.birthTimes);
+    WriteColumn(*p_file, cells.g1Durations);
+    WriteColumn(*p_file, cells.phases);
+    WriteColumn(*p_file, cells.readyToDivide);
+    WriteColumn(*p_file, cells.zones);
+    WriteColumn(*p_file, cells.baseG1Durations);
+    WriteColumn(*p_file, cells.isthmusG1Durations);
+    WriteColumn(*p_file, cells.stemG1Durations);
+    WriteColumn(*p_file, cells.transitG1Durations);
+    WriteColumn(*p_file, cells.sDurations);
+    WriteColumn(*p_file, cells.g2Durations);
+    WriteColumn(*p_file, cells.mDurations);
+    WriteColumn(*p_file, cells.minimumGapDurations);
+
+    for (unsigned i = 0; i < data_keys.size(); i++)
+    {
+        WriteValue<uint32_t>(*p_file, data_keys[i].size());
+        for (unsigned j = 0; j < data_keys[i].size(); j++)
+        {
+            WriteString(*p_file, data_keys[i][j]);
+            WriteValue<double>(*p_file, data_values[i][j]);
+        }
+    }
+
+    if (!*p_file)
+    {
+        EXCEPTION("Could not write gland checkpoint " + handler.GetOutputDirectoryFullPath() + name + ".gchk");
+    }
+    p_file->close();
+}
+
+GastricGlandSimulation2d* GlandCheckpoint::Load(const std::string& rArchiveDirectory, double time)
+{
+    std::string name = GetCheckpointName(time);
+    FileFinder checkpoint(rArchiveDirectory + "/archive/" + name + ".gchk", RelativeTo::ChasteTestOutput);
+    std::string path = checkpoint.GetAbsolutePath();
+
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open gland checkpoint " + path);
+    }
+
+    char magic[8];
+    file.read(magic, sizeof(magic));
+    uint32_t version = ReadValue<uint32_t>(file);
+    if (!file || std::memcmp(magic, GLAND_CHECKPOINT_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION(path + " is not a gland checkpoint");
+    }
+    if (version > GLAND_CHECKPOINT_FORMAT_VERSION)
+    {
+        EXCEPTION(path + " was written by a newer version of GlandCheckpoint");
+    }
+
+    std::string time_state = ReadString(file);
+    std::string rng_state = ReadString(file);
+    std::string context_state = ReadString(file);
+    uint32_t wnt_type = ReadValue<uint32_t>(file);
+    double crypt_length = ReadValue<double>(file);
+
+    double dt = ReadValue<double>(file);
+    uint32_t ancestor_index = ReadValue<uint32_t>(file);
+    uint32_t max_cells = ReadValue<uint32_t>(file);
+    uint32_t num_births = ReadValue<uint32_t>(file);
+    uint32_t num_deaths = ReadValue<uint32_t>(file);
+
+    double width = ReadValue<double>(file);
+    double mitosis_required_size = ReadValue<double>(file);
+    double foveolar_size_multiplier = ReadValue<double>(file);
+    double ghost_spring_stiffness = ReadValue<double>(file);
+
+    uint32_t max_cell_id = ReadValue<uint32_t>(file);
+    uint32_t num_cells = ReadValue<uint32_t>(file);
+    if (!file)
+    {
+        EXCEPTION("Truncated gland checkpoint " + path);
+    }
+
+    GlandCheckpointCells cells;
+    ReadColumn(file, cells.locationIndices, num_cells);
+    ReadColumn(file, cells.cellIds, num_cells);
+    ReadColumn(file, cells.types, num_cells);
+    ReadColumn(file, cells.mutationStates, num_cells);
+    ReadColumn(file, cells.labels, num_cells);
+    ReadColumn(file, cells.ancestors, num_cells);
+    ReadColumn(file, cells.birthTimes, num_cells);
+    ReadColumn(file, cells.g1Durations, num_cells);
+    ReadColumn(file, cells.phases, num_cells);
+    ReadColumn(file, cells.readyToDivide, num_cells);
+    ReadColumn(file, cells.zones, num_cells);
+    ReadColumn(file, cells.baseG1Durations, num_cells);
+    ReadColumn(file, cells.isthmusG1Durations, num_cells);
+    ReadColumn(file, cells.stemG1Durations, num_cells);
+    ReadColumn(file, cells.transitG1Durations, num_cells);
+    ReadColumn(file, cells.sDurations, num_cells);
+    ReadColumn(file, cells.g2Durations, num_cells);
+    ReadColumn(file, cells.mDurations, num_cells);
+    ReadColumn(file, cells.minimumGapDurations, num_cells);
+    if (!file)
+    {
+        EXCEPTION("Truncated gland checkpoint " + path);
+    }
+
+    // Cell-cycle models take their birth time from the clock, so restore it first
+    {
+        std::istringstream stream(time_state);
+        boost::archive::text_iarchive archive(stream);
+        archive >> *SimulationTime::Instance();
+    }
+
+    /*
+     * Cells are numbered as they are created, so recreate their ids in increasing order,
+     * then leave the counter where the saved run left it.
+     */
+    std::vector<unsigned> id_order(num_cells);
+    std::iota(id_order.begin(), id_order.end(), 0);
+    std::sort(id_order.begin(), id_order.end(),
+              [&cells](unsigned a, unsigned b) { return cells.cellIds[a] < cells.cellIds[b]; });
+
+    CellId::ResetMaxCellId();
+    std::vector<boost::shared_ptr<CellId> > cell_ids(num_cells);
+    for (unsigned i : id_order)
+    {
+        MAKE_PTR(CellId, p_cell_id);
+        do
+        {
+            p_cell_id->AssignCellId();
+        }
+        while (p_cell_id->GetCellId() < cells.cellIds[i]);
+
+        if (p_cell_id->GetCellId() != cells.cellIds[i])
+        {
+            EXCEPTION("Duplicate cell ids in gland checkpoint " + path);
+        }
+        cell_ids[i] = p_cell_id;
+    }
+    MAKE_PTR(CellId, p_spare_id);
+    while (p_spare_id->GetMaxCellId() < max_cell_id)
+    {
+        p_spare_id->AssignCellId();
+    }
+
+    CellPropertyRegistry* p_registry = CellPropertyRegistry::Instance();
+    std::vector<CellPtr> cell_ptrs(num_cells);
+    for (unsigned i = 0; i < num_cells; i++)
+    {
+        GastricGlandCellCycleModelV2* p_model = new GastricGlandCellCycleModelV2;
+        p_model->SetDimension(2);
+        p_model->SetBirthTime(cells.birthTimes[i]);
+        p_model->SetStemCellG1Duration(cells.stemG1Durations[i]);
+        p_model->SetTransitCellG1Duration(cells.transitG1Durations[i]);
+        p_model->SetSDuration(cells.sDurations[i]);
+        p_model->SetG2Duration(cells.g2Durations[i]);
+        p_model->SetMDuration(cells.mDurations[i]);
+        p_model->SetMinimumGapDuration(cells.minimumGapDurations[i]);
+        p_model->SetBaseG1Duration(cells.baseG1Durations[i]);
+        p_model->SetIsthmusG1Duration(cells.isthmusG1Durations[i]);
+        p_model->SetZone(cells.zones[i]);
+        p_model->mG1Duration = cells.g1Durations[i];
+        p_model->mCurrentCellCyclePhase = static_cast<CellCyclePhase>(cells.phases[i]);
+        p_model->mReadyToDivide = cells.readyToDivide[i];
+
+        // A cell given an id keeps it rather than being assigned the next one
+        CellPropertyCollection properties;
+        properties.AddProperty(cell_ids[i]);
+        CellPtr p_cell(new Cell(GetMutationState(cells.mutationStates[i]), p_model, nullptr, false, properties));
+        p_cell->SetCellProliferativeType(GetProliferativeType(cells.types[i]));
+
+        if (cells.labels[i])
+        {
+            p_cell->AddCellProperty(p_registry->Get<CellLabel>());
+        }
+        if (cells.ancestors[i] != UINT32_MAX)
+        {
+            MAKE_PTR_ARGS(CellAncestor, p_ancestor, (cells.ancestors[i]));
+            p_cell->SetAncestor(p_ancestor);
+        }
+
+        uint32_t num_items = ReadValue<uint32_t>(file);
+        for (unsigned j = 0; j < num_items && file; j++)
+        {
+            std::string key = ReadString(file);
+            double value = ReadValue<double>(file);
+            p_cell->GetCellData()->SetItem(key, value);
+        }
+        cell_ptrs[i] = p_cell;
+    }
+    if (!file)
+    {
+        EXCEPTION("Truncated gland checkpoint " + path);
+    }
+
+    // Restore the saved connectivity rather than remeshing, which could triangulate differently
+    TrianglesMeshReader<2,2> mesh_reader(OutputFileHandler::GetChasteTestOutputDirectory() + rArchiveDirectory + "/archive/" + name + "_mesh");
+    Cylindrical2dMesh* p_mesh = new Cylindrical2dMesh(width);
+    p_mesh->ConstructFromMeshReader(mesh_reader);
+
+    std::vector<unsigned> location_indices(cells.locationIndices.begin(), cells.locationIndices.end());
+    GastricGlandCellPopulation<2>* p_population = new GastricGlandCellPopulation<2>(
+        *p_mesh, cell_ptrs, location_indices, mitosis_required_size, foveolar_size_multiplier,
+        true, ghost_spring_stiffness);
+
+    // The saved population had just been updated, so its tessellation and rest lengths were current
+    p_population->CreateVoronoiTessellation();
+    p_population->UpdateRestLengths();
+
+    if (static_cast<WntConcentrationType>(wnt_type) != NONE)
+    {
+        WntConcentration<2>::Instance()->SetType(static_cast<WntConcentrationType>(wnt_type));
+        WntConcentration<2>::Instance()->SetCryptLength(crypt_length);
+        WntConcentration<2>::Instance()->SetCellPopulation(*p_population);
+    }
+
+    GastricGlandSimulation2d* p_simulation = new GastricGlandSimulation2d(*p_population, true, false, ancestor_index);
+
+    // As when loading from a Boost archive, the constructor leaves the boundary condition to us
+    MAKE_PTR_ARGS(GastricGlandSimulationBoundaryCondition<2>, p_bc, (p_population));
+    p_simulation->AddCellPopulationBoundaryCondition(p_bc);
+
+    p_simulation->SetDt(dt);
+    p_simulation->SetMaxCells(max_cells);
+    p_simulation->mNumBirths = num_births;
+    p_simulation->mNumDeaths = num_deaths;
+
+    {
+        std::istringstream stream(context_state);
+        boost::archive::text_iarchive archive(stream);
+        archive >> p_simulation->rGetGlandContext();
+    }
+    {
+        std::istringstream stream(rng_state);
+        boost::archive::text_iarchive archive(stream);
+        archive >> *RandomNumberGenerator::Instance();
+    }
+
+    return p_simulation;
+}
@@ -0,0 +1,255 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDCHECKPOINT_HPP_
+#define GLANDCHECKPOINT_HPP_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class GastricGlandSimulation2d;
+
+/*
+ * Layout of a gland checkpoint (<name>.gchk), in native byte order:
+ *
+ *   header: "GLANDCHK" (8 bytes), uint32 format version
+ *   singleton state: SimulationTime, RandomNumberGenerator and the gland context, each as a
+ *     length-prefixed Boost text archive, then uint32 Wnt type and double crypt length
+ *   simulation scalars: double dt, uint32 ancestor index, max cells, births and deaths
+ *   population scalars: double mesh width, mitosis required size, foveolar size multiplier
+ *     and ghost spring stiffness
+ *   cells: uint32 maximum cell id, uint32 number of cells n, then the columns of
+ *     GlandCheckpointCells in declaration order, n entries each, then for each cell a
+ *     uint32 number of cell data items followed by length-prefixed key and double value pairs
+ *
+ * Node positions and mesh connectivity are written alongside in binary Triangles format
+ * (<name>_mesh.node/.ele/.edge) so that loading restores the mesh bit for bit without
+ * remeshing. Ghost nodes are those which no cell's location index refers to.
+ */
+
+/** Magic bytes at the start of a gland checkpoint file. */
+#define GLAND_CHECKPOINT_MAGIC "GLANDCHK"
+
+/** Current version of the gland checkpoint format. */
+#define GLAND_CHECKPOINT_FORMAT_VERSION 1u
+
+/**
+ * Formats in which a GastricGlandSimulation2d can write its checkpoints.
+ */
+typedef enum GlandCheckpointFormat_
+{
+    CHECKPOINT_FORMAT_GLAND,
+    CHECKPOINT_FORMAT_BOOST
+} GlandCheckpointFormat;
+
+/**
+ * The per-cell state held by a gland checkpoint, one entry per cell in each column,
+ * in the order of the population's cell list.
+ */
+struct GlandCheckpointCells
+{
+    /** Location index of each cell. */
+    std::vector<uint32_t> locationIndices;
+
+    /** Cell id. */
+    std::vector<uint32_t> cellIds;
+
+    /** Proliferative type of each cell, as a code understood by GlandCheckpoint. */
+    std::vector<uint8_t> types;
+
+    /** Mutation state of each cell, as a code understood by GlandCheckpoint. */
+    std::vector<uint8_t> mutationStates;
+
+    /** Whether each cell carries a CellLabel. */
+    std::vector<uint8_t> labels;
+
+    /** Ancestor of each cell, or UINT32_MAX if unset. */
+    std::vector<uint32_t> ancestors;
+
+    /** Birth time of each cell. */
+    std::vector<double> birthTimes;
+
+    /** G1 duration of each cell. */
+    std::vector<double> g1Durations;
+
+    /** Current cell cycle phase of each cell. */
+    std::vector<uint8_t> phases;
+
+    /** Whether each cell's cell-cycle model has flagged it ready to divide. */
+    std::vector<uint8_t> readyToDivide;
+
+    /** GlandZone of each cell, or GLAND_ZONE_UNSET. */
+    std::vector<uint8_t> zones;
+
+    /** Mean base cell G1 duration of each cell-cycle model. */
+    std::vector<double> baseG1Durations;
+
+    /** Mean isthmus cell G1 duration of each cell-cycle model. */
+    std::vector<double> isthmusG1Durations;
+
+    /** Mean stem cell G1 duration of each cell-cycle model. */
+    std::vector<double> stemG1Durations;
+
+    /** Mean transit cell G1 duration of each cell-cycle model. */
+    std::vector<double> transitG1Durations;
+
+    /** S phase duration of each cell-cycle model. */
+    std::vector<double> sDurations;
+
+    /** G2 phase duration of each cell-cycle model. */
+    std::vector<double> g2Durations;
+
+    /** M phase duration of each cell-cycle model. */
+    std::vector<double> mDurations;
+
+    /** Minimum gap duration of each cell-cycle model. */
+    std::vector<double> minimumGapDurations;
+};
+
+/**
+ * Saves and loads a GastricGlandSimulation2d in a compact binary format, as a much
+ * faster alternative to CellBasedSimulationArchiver for mesh-based gland simulations of
+ * GastricGlandCellCycleModelV2 cells.
+ *
+ * A checkpoint holds the state which evolves during a run: the mesh, the cells, the
+ * singletons and the gland context. Forces, killers, modifiers and writers are not saved;
+ * the caller configures a loaded simulation exactly as it configured the saved one.
+ */
+class GlandCheckpoint
+{
+private:
+
+    /**
+     * Write a value to a stream.
+     *
+     * @param rStream the stream
+     * @param value the value
+     */
+    template<typename T>
+    static void WriteValue(std::ostream& rStream, const T& value);
+
+    /**
+     * Read a value from a stream.
+     *
+     * @param rStream the stream
+     * @return the value
+     */
+    template<typename T>
+    static T ReadValue(std::istream& rStream);
+
+    /**
+     * Write a column of values to a stream, without its length.
+     *
+     * @param rStream the stream
+     * @param rColumn the column
+     */
+    template<typename T>
+    static void WriteColumn(std::ostream& rStream, const std::vector<T>& rColumn);
+
+    /**
+     * Read a column of values from a stream.
+     *
+     * @param rStream the stream
+     * @param rColumn the column to fill
+     * @param numEntries the number of entries to read
+     */
+    template<typename T>
+    static void ReadColumn(std::istream& rStream, std::vector<T>& rColumn, unsigned numEntries);
+
+    /**
+     * Write a length-prefixed string to a stream.
+     *
+     * @param rStream the stream
+     * @param rString the string
+     */
+    static void WriteString(std::ostream& rStream, const std::string& rString);
+
+    /**
+     * Read a length-prefixed string from a stream.
+     *
+     * @param rStream the stream
+     * @return the string
+     */
+    static std::string ReadString(std::istream& rStream);
+
+public:
+
+    /**
+     * Save a simulation to the archive folder of its output directory, alongside any
+     * archives written by CellBasedSimulationArchiver. Throws if the simulation holds
+     * state this format cannot represent.
+     *
+     * Must be called once the population has been updated, so that the mesh holds no
+     * deleted nodes and no dead cells remain: at the end of Solve() or at an epoch.
+     *
+     * @param rSimulation the simulation
+     */
+    static void Save(GastricGlandSimulation2d& rSimulation);
+
+    /**
+     * Load a simulation saved by Save(). The singletons must have been set up and Wnt
+     * not yet configured, as for CellBasedSimulationArchiver::Load().
+     *
+     * The simulation owns its population, has the usual boundary condition and no other
+     * forces, killers, modifiers or writers.
+     *
+     * @param rArchiveDirectory the output directory of the saved simulation, relative to where Chaste output is stored
+     * @param time the simulation time at which it was saved
+     * @return the simulation, to be deleted by the caller
+     */
+    static GastricGlandSimulation2d* Load(const std::string& rArchiveDirectory, double time);
+
+    /**
+     * @param time the simulation time of a checkpoint
+     * @return the base name of the files of a checkpoint saved at that time
+     */
+    static std::string GetCheckpointName(double time);
+
+    /**
+     * @param rName "gland" or "boost"
+     * @return the corresponding GlandCheckpointFormat; throws on any other name
+     */
+    static GlandCheckpointFormat ParseFormat(const std::string& rName);
+
+    /**
+     * @param format a checkpoint format
+     * @return its name, as accepted by ParseFormat()
+     */
+    static std::string GetFormatName(GlandCheckpointFormat format);
+};
+
+#endif /*GLANDCHECKPOINT_HPP_*/
@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandEnsembleRunner.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Exception.hpp"
+#include "ExecutableSupport.hpp"
+#include "OutputFileHandler.hpp"
+#include "GastricGlandSimulation.hpp"
+
+GlandEnsembleRunner::GlandEnsembleRunner(unsigned numWorkers)
+    : mNumWorkers(numWorkers),
+      mRedirectOutput(true)
+{
+    if (mNumWorkers == 0)
+    {
+        long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        mNumWorkers = (num_cores > 0) ? static_cast<unsigned>(num_cores) : 1u;
+    }
+}
+
+void GlandEnsembleRunner::AddRun(const GastricGlandParameters& rParams)
+{
+    mRuns.push_back(rParams);
+}
+
+unsigned GlandEnsembleRunner::GetNumRuns() const
+{
+    return mRuns.size();
+}
+
+unsigned GlandEnsembleRunner::GetNumWorkers() const
+{
+    return mNumWorkers;
+}
+
+void GlandEnsembleRunner::SetRedirectOutput(bool redirectOutput)
+{
+    mRedirectOutput = redirectOutput;
+}
+
+void GlandEnsembleRunner::RunWorker(const GastricGlandParameters& rParams) const
+{
+    int exit_code = ExecutableSupport::EXIT_OK;
+    try
+    {
+        if (mRedirectOutput)
+        {
+            OutputFileHandler output_file_handler(rParams.output_directory, false);
+            std::string log_file = output_file_handler.GetOutputDirectoryFullPath() + "sim_" + rParams.simulation_id + ".log";
+            if (freopen(log_file.c_str(), "w", stdout) == nullptr)
+            {
+                EXCEPTION("Could not open log file " + log_file);
+            }
+        }
+
+        GastricGlandSimulation sim;
+        sim.simplifiedModel(rParams);
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // Skip the parent's exit handlers (PETSc finalisation belongs to the parent)
+    std::cout.flush();
+    fflush(stdout);
+    _exit(exit_code);
+}
+
+unsigned GlandEnsembleRunner::Run()
+{
+    // Anything still buffered would otherwise be written once by every worker
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(stdout);
+
+    unsigned next_run = 0;
+    unsigned num_failed = 0;
+    std::map<pid_t, unsigned> active_runs;
+
+    while (next_run < mRuns.size() || !active_runs.empty())
+    {
+        if (next_run < mRuns.size() && active_runs.size() < mNumWorkers)
+        {
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                EXCEPTION("GlandEnsembleRunner could not fork a worker");
+            }
+            if (pid == 0)
+            {
+                RunWorker(mRuns[next_run]);
+            }
+            std::cout << "Started run " << mRuns[next_run].simulation_id << " (pid " << pid << ")" << std::endl;
+            active_runs[pid] = next_run++;
+            continue;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            EXCEPTION("GlandEnsembleRunner lost track of its workers");
+        }
+
+        std::map<pid_t, unsigned>::iterator it = active_runs.find(pid);
+        if (it == active_runs.end())
+        {
+            continue;
+        }
+
+        const std::string& r_id = mRuns[it->second].simulation_id;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == ExecutableSupport::EXIT_OK)
+        {
+            std::cout << "Completed run " << r_id << std::endl;
+        }
+        else
+        {
+            std::cerr << "Run " << r_id << " failed" << std::endl;
+            num_failed++;
+        }
+        active_runs.erase(it);
+    }
+
+    return num_failed;
+}
@@ -0,0 +1,112 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDENSEMBLERUNNER_HPP_
+#define GLANDENSEMBLERUNNER_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Parameters.hpp"
+
+/**
+ * Runs many gastric gland simulations from one process on a pool of workers.
+ *
+ * SimulationTime, RandomNumberGenerator, CellPropertyRegistry and WntConcentration are
+ * process-global Chaste singletons, so two simulations cannot share an address space.
+ * Each run is therefore executed in a forked worker, which inherits the already
+ * initialised PETSc environment from the parent instead of paying startup again.
+ * Intended for sequential (single MPI process) use.
+ */
+class GlandEnsembleRunner
+{
+private:
+
+    /** The parameters of every run, in launch order. */
+    std::vector<GastricGlandParameters> mRuns;
+
+    /** The maximum number of runs executing at once. */
+    unsigned mNumWorkers;
+
+    /** Whether each worker redirects its stdout to a per-run log file. */
+    bool mRedirectOutput;
+
+    /**
+     * Body of a forked worker. Never returns.
+     *
+     * @param rParams the parameters of the run to execute
+     */
+    void RunWorker(const GastricGlandParameters& rParams) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numWorkers the maximum number of concurrent runs (0 to use every online core)
+     */
+    GlandEnsembleRunner(unsigned numWorkers=0);
+
+    /**
+     * Queue a run.
+     *
+     * @param rParams the parameters of the run; its simulation-id selects the output directory
+     */
+    void AddRun(const GastricGlandParameters& rParams);
+
+    /** @return the number of queued runs. */
+    unsigned GetNumRuns() const;
+
+    /** @return the maximum number of concurrent runs. */
+    unsigned GetNumWorkers() const;
+
+    /**
+     * Set whether each worker writes its stdout to <output-directory>/sim_<id>.log.
+     *
+     * @param redirectOutput whether to redirect worker output
+     */
+    void SetRedirectOutput(bool redirectOutput);
+
+    /**
+     * Execute every queued run, at most GetNumWorkers() at a time, and wait for all
+     * of them to finish.
+     *
+     * @return the number of runs which failed
+     */
+    unsigned Run();
+};
+
+#endif /*GLANDENSEMBLERUNNER_HPP_*/
@@ -0,0 +1,548 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandSweepSpec.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "Exception.hpp"
+
+namespace
+{
+
+// Runs beyond this are almost certainly a mistake in the sweep file
+const unsigned MAX_SWEEP_RUNS = 10000000;
+
+/**
+ * Sobol direction numbers of Joe and Kuo (new-joe-kuo-6.21201) for dimensions 2 onwards:
+ * the degree s and coefficients a of the primitive polynomial, and the initial m_1..m_s.
+ */
+struct SobolDirection
+{
+    unsigned s;
+    unsigned a;
+    unsigned m[5];
+};
+
+const SobolDirection SOBOL_DIRECTIONS[] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}}
+};
+
+const unsigned NUM_SOBOL_BITS = 32;
+
+std::vector<std::string> splitWhitespace(const std::string& rLine)
+{
+    std::vector<std::string> tokens;
+    std::stringstream ss(rLine);
+    std::string token;
+    while (ss >> token)
+    {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+double parseNumber(const std::string& rToken)
+{
+    char* p_end = nullptr;
+    errno = 0;
+    double value = std::strtod(rToken.c_str(), &p_end);
+    if (rToken.empty() || *p_end != '\0' || errno == ERANGE || !std::isfinite(value))
+    {
+        EXCEPTION("\"" + rToken + "\" is not a number");
+    }
+    return value;
+}
+
+unsigned parseCount(const std::string& rToken)
+{
+    double value = parseNumber(rToken);
+    if (value < 1.0 || value != std::floor(value) || value > MAX_SWEEP_RUNS)
+    {
+        EXCEPTION("\"" + rToken + "\" is not a positive count");
+    }
+    return static_cast<unsigned>(value);
+}
+
+// The same text is passed to the parameters and written to the manifest
+std::string formatValue(double value)
+{
+    std::stringstream ss;
+    ss << std::setprecision(12) << value;
+    return ss.str();
+}
+
+// A uniform double in (0, 1) from 32 bits, the same on every platform
+double uniform(std::mt19937& rGenerator)
+{
+    return (rGenerator() + 0.5)/4294967296.0;
+}
+
+} // namespace
+
+GlandSweepSpec::GlandSweepSpec()
+    : mSampling(SWEEP_SAMPLING_NONE),
+      mNumSamples(1),
+      mSampleSeed(0),
+      mNumReplicates(1)
+{
+}
+
+void GlandSweepSpec::ReadFile(const std::string& rFileName)
+{
+    std::ifstream file(rFileName.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open sweep file " + rFileName);
+    }
+
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        try
+        {
+            Parse(line);
+        }
+        catch (const Exception& e)
+        {
+            EXCEPTION(rFileName + ":" + std::to_string(line_number) + ": " + e.GetShortMessage());
+        }
+    }
+}
+
+void GlandSweepSpec::Parse(const std::string& rInput)
+{
+    std::stringstream ss(rInput);
+    std::string line;
+    while (std::getline(ss, line))
+    {
+        remove_leading_trailing_whitespace(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        ParseStatement(line);
+    }
+}
+
+void GlandSweepSpec::CheckSweptKey(const std::string& rKey) const
+{
+    if (!std::binary_search(GastricGlandParameters::valid_keys.begin(), GastricGlandParameters::valid_keys.end(), rKey))
+    {
+        EXCEPTION("\"" + rKey + "\" is not a GastricGlandParameters key");
+    }
+    if (std::find(mLevelKeys.begin(), mLevelKeys.end(), rKey) != mLevelKeys.end()
+        || std::find(mRangeKeys.begin(), mRangeKeys.end(), rKey) != mRangeKeys.end())
+    {
+        EXCEPTION("\"" + rKey + "\" is swept more than once");
+    }
+    if (rKey == "seed" || rKey == "simulation-id")
+    {
+        EXCEPTION("\"" + rKey + "\" is set per run and cannot be swept; use replicates");
+    }
+}
+
+void GlandSweepSpec::ParseStatement(const std::string& rLine)
+{
+    if (rLine.find('=') != std::string::npos)
+    {
+        for (const auto& p : makeMap(rLine))
+        {
+            mBaseMap[p.first] = p.second;
+        }
+        return;
+    }
+
+    std::vector<std::string> tokens = splitWhitespace(rLine);
+    const std::string& r_statement = tokens[0];
+    if (r_statement == "values")
+    {
+        if (tokens.size() < 3)
+        {
+            EXCEPTION("values needs a key and at least one value");
+        }
+        CheckSweptKey(tokens[1]);
+        mLevelKeys.push_back(tokens[1]);
+        mLevels.push_back(std::vector<std::string>(tokens.begin() + 2, tokens.end()));
+    }
+    else if (r_statement == "grid")
+    {
+        if (tokens.size() != 5)
+        {
+            EXCEPTION("grid needs a key, a minimum, a maximum and a number of values");
+        }
+        CheckSweptKey(tokens[1]);
+        double min = parseNumber(tokens[2]);
+        double max = parseNumber(tokens[3]);
+        unsigned num_values = parseCount(tokens[4]);
+
+        std::vector<std::string> levels;
+        for (unsigned i=0; i<num_values; i++)
+        {
+            double fraction = (num_values > 1) ? double(i)/(num_values - 1) : 0.0;
+            levels.push_back(formatValue(min + (max - min)*fraction));
+        }
+        mLevelKeys.push_back(tokens[1]);
+        mLevels.push_back(levels);
+    }
+    else if (r_statement == "range")
+    {
+        if (tokens.size() != 4)
+        {
+            EXCEPTION("range needs a key, a minimum and a maximum");
+        }
+        CheckSweptKey(tokens[1]);
+        double min = parseNumber(tokens[2]);
+        double max = parseNumber(tokens[3]);
+        if (!(min < max))
+        {
+            EXCEPTION("range of " + tokens[1] + " is empty");
+        }
+        mRangeKeys.push_back(tokens[1]);
+        mRangeMins.push_back(min);
+        mRangeMaxs.push_back(max);
+    }
+    else if (r_statement == "sample")
+    {
+        if (tokens.size() != 3 || (tokens[1] != "lhs" && tokens[1] != "sobol"))
+        {
+            EXCEPTION("sample needs a method, lhs or sobol, and a number of points");
+        }
+        mSampling = (tokens[1] == "lhs") ? SWEEP_SAMPLING_LHS : SWEEP_SAMPLING_SOBOL;
+        mNumSamples = parseCount(tokens[2]);
+    }
+    else if (r_statement == "sample-seed")
+    {
+        if (tokens.size() != 2)
+        {
+            EXCEPTION("sample-seed needs a seed");
+        }
+        double seed = parseNumber(tokens[1]);
+        if (seed < 0.0 || seed != std::floor(seed) || seed > 4294967295.0)
+        {
+            EXCEPTION("\"" + tokens[1] + "\" is not a seed");
+        }
+        mSampleSeed = static_cast<unsigned>(seed);
+    }
+    else if (r_statement == "replicates")
+    {
+        if (tokens.size() != 2)
+        {
+            EXCEPTION("replicates needs a count");
+        }
+        mNumReplicates = parseCount(tokens[1]);
+    }
+    else
+    {
+        EXCEPTION("Unknown sweep statement \"" + rLine + "\"");
+    }
+}
+
+std::vector<std::string> GlandSweepSpec::GetSweptKeys() const
+{
+    std::vector<std::string> keys = mLevelKeys;
+    keys.insert(keys.end(), mRangeKeys.begin(), mRangeKeys.end());
+    return keys;
+}
+
+unsigned GlandSweepSpec::GetNumReplicates() const
+{
+    return mNumReplicates;
+}
+
+void GlandSweepSpec::SetNumReplicates(unsigned numReplicates)
+{
+    if (numReplicates == 0)
+    {
+        EXCEPTION("A sweep needs at least one replicate");
+    }
+    mNumReplicates = numReplicates;
+}
+
+unsigned GlandSweepSpec::GetNumRuns() const
+{
+    double num_runs = mNumReplicates;
+    for (const std::vector<std::string>& r_levels : mLevels)
+    {
+        num_runs *= r_levels.size();
+    }
+    if (!mRangeKeys.empty())
+    {
+        num_runs *= mNumSamples;
+    }
+    if (num_runs > MAX_SWEEP_RUNS)
+    {
+        EXCEPTION("Sweep expands to more than " + std::to_string(MAX_SWEEP_RUNS) + " runs");
+    }
+    return static_cast<unsigned>(num_runs);
+}
+
+std::vector<GlandSweepRun> GlandSweepSpec::Expand(const std::map<std::string, std::string>& rBaseMap) const
+{
+    if (!mRangeKeys.empty() && mSampling == SWEEP_SAMPLING_NONE)
+    {
+        EXCEPTION("Sweep has ranges but no sample statement");
+    }
+    if (mRangeKeys.empty() && mSampling != SWEEP_SAMPLING_NONE)
+    {
+        EXCEPTION("Sweep has a sample statement but no ranges");
+    }
+    if (mSampling == SWEEP_SAMPLING_SOBOL && mRangeKeys.size() > GetMaxSobolDimensions())
+    {
+        EXCEPTION("Sobol sampling supports at most " + std::to_string(GetMaxSobolDimensions()) + " ranges");
+    }
+
+    std::vector<GlandSweepRun> runs;
+    runs.reserve(GetNumRuns());
+
+    // The sampled points are shared by every combination of levels
+    const unsigned num_ranges = mRangeKeys.size();
+    const unsigned num_samples = num_ranges > 0 ? mNumSamples : 1;
+    std::vector<double> samples;
+    if (mSampling == SWEEP_SAMPLING_LHS)
+    {
+        samples = LatinHypercube(num_samples, num_ranges, mSampleSeed);
+    }
+    else if (mSampling == SWEEP_SAMPLING_SOBOL)
+    {
+        samples = Sobol(num_samples, num_ranges);
+    }
+
+    std::map<std::string, std::string> base_map = mBaseMap;
+    for (const auto& p : rBaseMap)
+    {
+        base_map[p.first] = p.second;
+    }
+    std::map<std::string, std::string>::const_iterator id_it = base_map.find("simulation-id");
+    const std::string id_prefix = (id_it != base_map.end()) ? id_it->second + "_" : "";
+
+    // Odometer over the levels, last key fastest
+    std::vector<unsigned> level_index(mLevelKeys.size(), 0);
+    unsigned point = 0;
+    bool more_levels = true;
+    while (more_levels)
+    {
+        for (unsigned sample=0; sample<num_samples; sample++, point++)
+        {
+            std::map<std::string, std::string> map = base_map;
+            std::vector<std::string> values;
+            for (unsigned k=0; k<mLevelKeys.size(); k++)
+            {
+                values.push_back(mLevels[k][level_index[k]]);
+                map[mLevelKeys[k]] = values.back();
+            }
+            for (unsigned k=0; k<num_ranges; k++)
+            {
+                double fraction = samples[sample*num_ranges + k];
+                values.push_back(formatValue(mRangeMins[k] + (mRangeMaxs[k] - mRangeMins[k])*fraction));
+                map[mRangeKeys[k]] = values.back();
+            }
+
+            GlandSweepRun run;
+            try
+            {
+                run.params.update(map);
+            }
+            catch (const Exception& e)
+            {
+                EXCEPTION("Sweep point " + std::to_string(point) + ": " + e.GetShortMessage());
+            }
+            run.values = values;
+
+            const unsigned base_seed = run.params.seed;
+            for (unsigned replicate=0; replicate<mNumReplicates; replicate++)
+            {
+                run.params.seed = base_seed + replicate;
+                run.params.simulation_id = id_prefix + std::to_string(point);
+                if (mNumReplicates > 1)
+                {
+                    run.params.simulation_id += "_" + std::to_string(replicate);
+                }
+                runs.push_back(run);
+            }
+        }
+
+        more_levels = false;
+        for (unsigned k=mLevelKeys.size(); k-- > 0;)
+        {
+            if (++level_index[k] < mLevels[k].size())
+            {
+                more_levels = true;
+                break;
+            }
+            level_index[k] = 0;
+        }
+    }
+
+    return runs;
+}
+
+void GlandSweepSpec::WriteManifest(const std::vector<GlandSweepRun>& rRuns, std::ostream& rStream) const
+{
+    rStream << "simulation-id\tseed";
+    for (const std::string& r_key : GetSweptKeys())
+    {
+        rStream << "\t" << r_key;
+    }
+    rStream << "\n";
+
+    for (const GlandSweepRun& r_run : rRuns)
+    {
+        rStream << r_run.params.simulation_id << "\t" << r_run.params.seed;
+        for (const std::string& r_value : r_run.values)
+        {
+            rStream << "\t" << r_value;
+        }
+        rStream << "\n";
+    }
+}
+
+std::vector<double> GlandSweepSpec::LatinHypercube(unsigned numPoints, unsigned numDimensions, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<double> points(numPoints*numDimensions);
+    std::vector<unsigned> strata(numPoints);
+    for (unsigned dimension=0; dimension<numDimensions; dimension++)
+    {
+        for (unsigned i=0; i<numPoints; i++)
+        {
+            strata[i] = i;
+        }
+
+        // Fisher-Yates, spelt out so that the sample does not depend on the standard library
+        for (unsigned i=numPoints; i-- > 1;)
+        {
+            std::swap(strata[i], strata[generator() % (i + 1)]);
+        }
+
+        for (unsigned i=0; i<numPoints; i++)
+        {
+            points[i*numDimensions + dimension] = (strata[i] + uniform(generator))/numPoints;
+        }
+    }
+    return points;
+}
+
+std::vector<double> GlandSweepSpec::Sobol(unsigned numPoints, unsigned numDimensions)
+{
+    assert(numDimensions <= GetMaxSobolDimensions());
+
+    // Direction numbers, scaled to 32 bits
+    std::vector<std::vector<uint32_t> > directions(numDimensions, std::vector<uint32_t>(NUM_SOBOL_BITS + 1));
+    for (unsigned dimension=0; dimension<numDimensions; dimension++)
+    {
+        std::vector<uint32_t>& r_v = directions[dimension];
+        if (dimension == 0)
+        {
+            for (unsigned k=1; k<=NUM_SOBOL_BITS; k++)
+            {
+                r_v[k] = uint32_t(1) << (NUM_SOBOL_BITS - k);
+            }
+            continue;
+        }
+
+        const SobolDirection& r_direction = SOBOL_DIRECTIONS[dimension - 1];
+        const unsigned s = r_direction.s;
+        for (unsigned k=1; k<=NUM_SOBOL_BITS; k++)
+        {
+            if (k <= s)
+            {
+                r_v[k] = r_direction.m[k-1] << (NUM_SOBOL_BITS - k);
+            }
+            else
+            {
+                r_v[k] = r_v[k-s] ^ (r_v[k-s] >> s);
+                for (unsigned l=1; l<s; l++)
+                {
+                    if ((r_direction.a >> (s - 1 - l)) & 1u)
+                    {
+                        r_v[k] ^= r_v[k-l];
+                    }
+                }
+            }
+        }
+    }
+
+    // Gray code order: each point flips the direction of the lowest zero bit of its predecessor's index
+    std::vector<double> points(numPoints*numDimensions);
+    std::vector<uint32_t> x(numDimensions, 0);
+    for (unsigned i=0; i<numPoints; i++)
+    {
+        if (i > 0)
+        {
+            unsigned c = 1;
+            for (unsigned value=i-1; value & 1u; value >>= 1)
+            {
+                c++;
+            }
+            for (unsigned dimension=0; dimension<numDimensions; dimension++)
+            {
+                x[dimension] ^= directions[dimension][c];
+            }
+        }
+        for (unsigned dimension=0; dimension<numDimensions; dimension++)
+        {
+            points[i*numDimensions + dimension] = x[dimension]/4294967296.0;
+        }
+    }
+    return points;
+}
+
+unsigned GlandSweepSpec::GetMaxSobolDimensions()
+{
+    return 1 + sizeof(SOBOL_DIRECTIONS)/sizeof(SOBOL_DIRECTIONS[0]);
+}
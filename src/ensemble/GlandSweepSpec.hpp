@@ -0,0 +1,223 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDSWEEPSPEC_HPP_
+#define GLANDSWEEPSPEC_HPP_
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Parameters.hpp"
+
+/**
+ * How the continuous dimensions of a sweep are sampled.
+ */
+typedef enum SweepSampling_
+{
+    SWEEP_SAMPLING_NONE,
+    SWEEP_SAMPLING_LHS,
+    SWEEP_SAMPLING_SOBOL
+} SweepSampling;
+
+/**
+ * One run of an expanded sweep: its parameters and the value of each swept key, as
+ * listed by GlandSweepSpec::GetSweptKeys().
+ */
+struct GlandSweepRun
+{
+    /** The parameters of the run. */
+    GastricGlandParameters params;
+
+    /** The value of each swept key for this run. */
+    std::vector<std::string> values;
+};
+
+/**
+ * A parameter sweep, read from a file of one statement per line. Blank lines and lines
+ * starting with '#' are skipped.
+ *
+ *     KEY=VALUE                set a parameter for every run, unless it is passed to Expand()
+ *     values KEY V1 V2 ...     run every listed value of KEY
+ *     grid KEY MIN MAX N       run N evenly spaced values of KEY from MIN to MAX
+ *     range KEY MIN MAX        sample KEY uniformly between MIN and MAX
+ *     sample lhs|sobol N       draw N points over the ranges, by Latin hypercube or Sobol sequence
+ *     sample-seed S            seed of the Latin hypercube (default 0)
+ *     replicates R             run every point R times, with consecutive seeds (default 1)
+ *
+ * The values and grid keys are crossed with each other and with the sampled points, so a
+ * sweep has (product of level counts) x N x R runs. Every run's parameters are parsed and
+ * checked when the sweep is expanded, before anything is launched.
+ *
+ * Runs are numbered by point, in the order the keys were given with the last varying
+ * fastest, and suffixed with _r for replicate r when R > 1. A simulation-id given in the
+ * parameters becomes a prefix.
+ */
+class GlandSweepSpec
+{
+private:
+
+    /** Parameters set for every run. */
+    std::map<std::string, std::string> mBaseMap;
+
+    /** Keys taking each of a list of levels, in file order. */
+    std::vector<std::string> mLevelKeys;
+
+    /** The levels of each of mLevelKeys. */
+    std::vector<std::vector<std::string> > mLevels;
+
+    /** Keys sampled from a range, in file order. */
+    std::vector<std::string> mRangeKeys;
+
+    /** The lower end of each range. */
+    std::vector<double> mRangeMins;
+
+    /** The upper end of each range. */
+    std::vector<double> mRangeMaxs;
+
+    /** How the ranges are sampled. */
+    SweepSampling mSampling;
+
+    /** The number of sampled points. */
+    unsigned mNumSamples;
+
+    /** The seed of the Latin hypercube. */
+    unsigned mSampleSeed;
+
+    /** The number of runs of each point. */
+    unsigned mNumReplicates;
+
+    /**
+     * Parse one statement.
+     *
+     * @param rLine the statement, without leading or trailing whitespace
+     */
+    void ParseStatement(const std::string& rLine);
+
+    /**
+     * Throw unless a key is a parameter which no other statement sweeps.
+     *
+     * @param rKey the key
+     */
+    void CheckSweptKey(const std::string& rKey) const;
+
+public:
+
+    /**
+     * Constructor. The sweep starts as a single run with default parameters.
+     */
+    GlandSweepSpec();
+
+    /**
+     * Read statements from a file, adding to any already read.
+     *
+     * @param rFileName path of the sweep file
+     */
+    void ReadFile(const std::string& rFileName);
+
+    /**
+     * Parse statements, adding to any already read.
+     *
+     * @param rInput the statements, one per line
+     */
+    void Parse(const std::string& rInput);
+
+    /**
+     * @return the swept keys: the values and grid keys, then the range keys, each in file order
+     */
+    std::vector<std::string> GetSweptKeys() const;
+
+    /**
+     * @return the number of runs of each point
+     */
+    unsigned GetNumReplicates() const;
+
+    /**
+     * Set the number of runs of each point, overriding any replicates statement.
+     *
+     * @param numReplicates the number of runs of each point, at least 1
+     */
+    void SetNumReplicates(unsigned numReplicates);
+
+    /**
+     * @return the number of runs the sweep expands to
+     */
+    unsigned GetNumRuns() const;
+
+    /**
+     * Expand the sweep into runs.
+     *
+     * @param rBaseMap parameters for every run, overriding those set in the sweep file
+     * @return every run, in launch order
+     */
+    std::vector<GlandSweepRun> Expand(const std::map<std::string, std::string>& rBaseMap) const;
+
+    /**
+     * Write a tab-separated table of each run's id, seed and swept values, with a header.
+     *
+     * @param rRuns the runs returned by Expand()
+     * @param rStream the stream to write to
+     */
+    void WriteManifest(const std::vector<GlandSweepRun>& rRuns, std::ostream& rStream) const;
+
+    /**
+     * Latin hypercube sample of the unit cube: in every dimension each of numPoints equal
+     * strata holds exactly one point.
+     *
+     * @param numPoints the number of points
+     * @param numDimensions the number of dimensions
+     * @param seed the seed of the generator which shuffles the strata and jitters the points
+     * @return the points, point by point
+     */
+    static std::vector<double> LatinHypercube(unsigned numPoints, unsigned numDimensions, unsigned seed);
+
+    /**
+     * The first points of the Sobol sequence in the unit cube, starting at the origin, with
+     * Joe and Kuo's direction numbers. Balanced best when numPoints is a power of two.
+     *
+     * @param numPoints the number of points
+     * @param numDimensions the number of dimensions, at most GetMaxSobolDimensions()
+     * @return the points, point by point
+     */
+    static std::vector<double> Sobol(unsigned numPoints, unsigned numDimensions);
+
+    /**
+     * @return the largest number of dimensions Sobol() supports
+     */
+    static unsigned GetMaxSobolDimensions();
+};
+
+#endif /*GLANDSWEEPSPEC_HPP_*/
@@ -5,6 +5,7 @@
 #include "DifferentiatedCellProliferativeType.hpp"
 #include "NeckCellProliferativeType.hpp"
 #include "Exception.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 template <unsigned DIM>
 ExperimentalParietalCellKiller<DIM>::ExperimentalParietalCellKiller(
@@ -21,6 +22,8 @@ ExperimentalParietalCellKiller<DIM>::ExperimentalParietalCellKiller(
 template <unsigned DIM>
 void ExperimentalParietalCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(*this->mpCellPopulation), PROFILE_KILLERS);
+
     if (m_hasActivated) return;
     double currentTime = SimulationTime::Instance()->GetTime();
     if (currentTime < m_activationTime) return;
@@ -28,10 +31,17 @@ void ExperimentalParietalCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath(
 
     RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
 
-    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin(); cell_iter != this->mpCellPopulation->End(); ++cell_iter)
+    // Neck cells are visited in population order, so the random draws are the same as a full scan's
+    GlandCellIndex<DIM>& r_index = GastricGlandCellPopulation<DIM>::rFindCellIndex(*this->mpCellPopulation, mOwnCellIndex);
+    const std::vector<CellPtr>& r_neck_cells = r_index.template rGetCellsOfType<NeckCellProliferativeType>();
+
+    for (unsigned i=0; i<r_neck_cells.size(); i++)
     {
-        CellPtr pCell = *cell_iter;
-        if (!pCell->GetCellProliferativeType()->IsType<NeckCellProliferativeType>())
+        CellPtr pCell = r_neck_cells[i];
+
+        // The index may have been built before an earlier killer ran this step. The population's
+        // iterator skips dead cells, so the full scan drew nothing for a cell killed since, nor must we
+        if (pCell->IsDead())
             continue;
         if (p_gen->ranf() <= m_deathChance)
         {
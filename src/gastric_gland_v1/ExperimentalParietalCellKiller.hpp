@@ -37,6 +37,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define EXPERIMENTALPARIETALCELLKILLER_HPP_
 
 #include "AbstractCellKiller.hpp"
+#include "GlandCellIndex.hpp"
 
 #include "RandomNumberGenerator.hpp"
 #include "ChasteSerialization.hpp"
@@ -57,6 +58,8 @@ private:
     double m_activationTime;
     bool m_hasActivated;
 
+    /** Index of cells used when the population has no gland context to share one. Not archived. */
+    GlandCellIndex<DIM> mOwnCellIndex;
 
     /** Needed for serialization. */
     friend class boost::serialization::access;
@@ -98,7 +101,8 @@ public:
     bool HasActivated() const;
 
     /**
-     * Loops over cells and kills cells outside boundary.
+     * Once the activation time is reached, kills each neck cell with the death chance,
+     * visiting only the neck cells.
      */
     virtual void CheckAndLabelCellsForApoptosisOrDeath();
 
@@ -4,16 +4,37 @@
 #include "DifferentiatedCellProliferativeType.hpp"
 #include "FoveolarCellProliferativeType.hpp"
 #include "Exception.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 template <unsigned DIM>
 FoveolarCellKiller<DIM>::FoveolarCellKiller(AbstractCellPopulation<DIM>* pCellPopulation, double cutoffAge) :
     AbstractCellKiller<DIM>(pCellPopulation),
-    m_cutoffAge(cutoffAge)
+    m_cutoffAge(cutoffAge),
+    mIsDeathQueueSeeded(false)
 {}
 
+template <unsigned DIM>
+void FoveolarCellKiller<DIM>::SeedDeathQueue(GlandContext<DIM>& rContext)
+{
+    mDeathQueue = std::priority_queue<ScheduledCell, std::vector<ScheduledCell>, YoungerCell>();
+
+    GlandCellIndex<DIM>& r_index = GastricGlandCellPopulation<DIM>::rFindCellIndex(*this->mpCellPopulation, mOwnCellIndex);
+    const std::vector<CellPtr>& r_foveolar_cells = r_index.template rGetCellsOfType<FoveolarCellProliferativeType>();
+    for (unsigned i=0; i<r_foveolar_cells.size(); i++)
+    {
+        mDeathQueue.push(ScheduledCell(r_foveolar_cells[i]->GetBirthTime(), r_foveolar_cells[i]));
+    }
+
+    rContext.rGetNewFoveolarCells().clear();
+    rContext.StartRecordingNewFoveolarCells();
+    mIsDeathQueueSeeded = true;
+}
+
 template <unsigned DIM>
 void FoveolarCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(*this->mpCellPopulation), PROFILE_KILLERS);
+
     switch (DIM)
     {
         case 1:
@@ -23,15 +44,61 @@ void FoveolarCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
         }
         case 2:
         {
-            for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin(); cell_iter != this->mpCellPopulation->End(); ++cell_iter)
+            GlandContext<DIM>* p_context = GastricGlandCellPopulation<DIM>::FindGlandContext(*this->mpCellPopulation);
+            if (p_context)
             {
-                c_vector<double, 2> location;
-                CellPtr pCell = *cell_iter;
+                if (!mIsDeathQueueSeeded)
+                {
+                    SeedDeathQueue(*p_context);
+                }
 
-                if (pCell->GetCellProliferativeType()->IsSubType<FoveolarCellProliferativeType>() &&
-                    pCell->GetAge() > m_cutoffAge)
+                std::vector<CellPtr>& r_new_cells = p_context->rGetNewFoveolarCells();
+                for (unsigned i=0; i<r_new_cells.size(); i++)
+                {
+                    mDeathQueue.push(ScheduledCell(r_new_cells[i]->GetBirthTime(), r_new_cells[i]));
+                }
+                r_new_cells.clear();
+
+                while (!mDeathQueue.empty())
+                {
+                    CellPtr p_cell = mDeathQueue.top().second.lock();
+                    double birth_time = mDeathQueue.top().first;
+
+                    if (!p_cell || p_cell->IsDead() || !p_cell->GetCellProliferativeType()->IsType<FoveolarCellProliferativeType>())
+                    {
+                        // Removed from the population, already killed, or moved out of the foveolar
+                        // zone; it is recorded again if it becomes foveolar again
+                        mDeathQueue.pop();
+                    }
+                    else if (p_cell->GetBirthTime() != birth_time)
+                    {
+                        // Left the foveolar zone and divided before returning; reschedule it
+                        mDeathQueue.pop();
+                        mDeathQueue.push(ScheduledCell(p_cell->GetBirthTime(), p_cell));
+                    }
+                    else if (p_cell->GetAge() > m_cutoffAge)
+                    {
+                        mDeathQueue.pop();
+                        p_cell->Kill();
+                    }
+                    else
+                    {
+                        // Every remaining cell is younger
+                        break;
+                    }
+                }
+                break;
+            }
+
+            GlandCellIndex<DIM>& r_index = GastricGlandCellPopulation<DIM>::rFindCellIndex(*this->mpCellPopulation, mOwnCellIndex);
+            const std::vector<CellPtr>& r_foveolar_cells = r_index.template rGetCellsOfType<FoveolarCellProliferativeType>();
+
+            for (unsigned i=0; i<r_foveolar_cells.size(); i++)
+            {
+                CellPtr pCell = r_foveolar_cells[i];
+                if (!pCell->IsDead() && pCell->GetAge() > m_cutoffAge)
                 {
-                    cell_iter->Kill();
+                    pCell->Kill();
                 }
             }
             break;
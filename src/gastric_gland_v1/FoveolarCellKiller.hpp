@@ -37,9 +37,15 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define FOVEOLARCELLKILLER_HPP_
 
 #include "AbstractCellKiller.hpp"
+#include "GlandCellIndex.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <queue>
+#include <utility>
+#include <vector>
 
 /**
  *  A cell killer that kills cells if they are outside the domain.
@@ -54,6 +60,43 @@ private:
 
     double m_cutoffAge;
 
+    /** Index of cells used when the population has no gland context to share one. Not archived. */
+    GlandCellIndex<DIM> mOwnCellIndex;
+
+    /**
+     * A foveolar cell and its birth time when it was scheduled. The cell is held weakly, so
+     * that a sloughed cell is freed once the population removes it rather than once it
+     * would have reached the cutoff age.
+     */
+    typedef std::pair<double, boost::weak_ptr<Cell> > ScheduledCell;
+
+    /** Orders the death queue so that the oldest cell, the next to die, is on top. */
+    struct YoungerCell
+    {
+        bool operator()(const ScheduledCell& rA, const ScheduledCell& rB) const
+        {
+            return rA.first > rB.first;
+        }
+    };
+
+    /**
+     * Foveolar cells ordered by birth time, and so by the time at which each reaches the
+     * cutoff age. Foveolar cells are differentiated and do not divide, so a birth time is
+     * fixed from the moment the cell becomes foveolar. Not archived; rebuilt from the
+     * population on the first call after construction or loading.
+     */
+    std::priority_queue<ScheduledCell, std::vector<ScheduledCell>, YoungerCell> mDeathQueue;
+
+    /** Whether mDeathQueue holds every foveolar cell and new ones are being recorded by the gland context. */
+    bool mIsDeathQueueSeeded;
+
+    /**
+     * Schedule every foveolar cell in the population and start recording new ones.
+     *
+     * @param rContext the gland context of the population
+     */
+    void SeedDeathQueue(GlandContext<DIM>& rContext);
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -81,7 +124,11 @@ public:
     double getCutoffAge() const;
 
     /**
-     * Loops over cells and kills cells outside boundary.
+     * Kills foveolar cells older than the cutoff age.
+     *
+     * With a gland context, cells are queued by birth time as they become foveolar and
+     * only those which have reached the cutoff age are visited. Otherwise every foveolar
+     * cell is checked.
      */
     virtual void CheckAndLabelCellsForApoptosisOrDeath();
 
@@ -3,6 +3,7 @@
 #include "AbstractCentreBasedCellPopulation.hpp"
 #include "DifferentiatedCellProliferativeType.hpp"
 #include "Exception.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 template <unsigned DIM>
 GastricGlandBaseCellKiller<DIM>::GastricGlandBaseCellKiller(AbstractCellPopulation<DIM>* pCellPopulation, double cutoffHeight) :
@@ -13,6 +14,8 @@ GastricGlandBaseCellKiller<DIM>::GastricGlandBaseCellKiller(AbstractCellPopulati
 template <unsigned DIM>
 void GastricGlandBaseCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(*this->mpCellPopulation), PROFILE_KILLERS);
+
     switch (DIM)
     {
         case 1:
@@ -22,16 +25,15 @@ void GastricGlandBaseCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
         }
         case 2:
         {
-            for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin(); cell_iter != this->mpCellPopulation->End(); ++cell_iter)
-            {
-                c_vector<double, 2> location;
-                location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
+            GlandCellIndex<DIM>& r_index = GastricGlandCellPopulation<DIM>::rFindCellIndex(*this->mpCellPopulation, mOwnCellIndex);
+            r_index.GetCellsBelow(m_cutoffHeight, mCandidates);
 
-                CellPtr pCell = *cell_iter;
-
-                if ((location[1] < m_cutoffHeight) && (pCell->GetAge() > 20))
+            for (unsigned i=0; i<mCandidates.size(); i++)
+            {
+                CellPtr pCell = mCandidates[i];
+                if (!pCell->IsDead() && pCell->GetAge() > 20)
                 {
-                    cell_iter->Kill();
+                    pCell->Kill();
                 }
             }
             break;
@@ -37,6 +37,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GASTRICGLANDBASECELLKILLER_HPP_
 
 #include "AbstractCellKiller.hpp"
+#include "GlandCellIndex.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -54,6 +55,12 @@ private:
 
     double m_cutoffHeight;
 
+    /** Index of cells used when the population has no gland context to share one. Not archived. */
+    GlandCellIndex<DIM> mOwnCellIndex;
+
+    /** Scratch: the cells below the cutoff height. */
+    std::vector<CellPtr> mCandidates;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -81,7 +88,7 @@ public:
     double getCutoffHeight() const { return m_cutoffHeight; }
 
     /**
-     * Loops over cells and kills cells outside boundary.
+     * Kills cells older than 20 hours below the cutoff height, visiting only the lowest height bands.
      */
     virtual void CheckAndLabelCellsForApoptosisOrDeath();
 
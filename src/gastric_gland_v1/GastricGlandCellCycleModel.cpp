@@ -45,6 +45,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ApcOneHitCellMutationState.hpp"
 #include "ApcTwoHitCellMutationState.hpp"
 #include "BetaCateninOneHitCellMutationState.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 GastricGlandCellCycleModel::GastricGlandCellCycleModel() :
   mIsthmusBeginHeight(0.7),
@@ -119,6 +120,7 @@ void GastricGlandCellCycleModel::UpdateCellCyclePhase()
         EXCEPTION("Gastric gland cell cycle model only allowed for LINEAR Wnt concentration.");
     }
     double height = 1-GetWntLevel();
+    boost::shared_ptr<AbstractCellProperty> p_previous_type = mpCell->GetCellProliferativeType();
 
     // Allow the cell to divide if in either Base or Isthmus region
     // Use Wnt signal strength to determine position in gland
@@ -170,9 +172,27 @@ void GastricGlandCellCycleModel::UpdateCellCyclePhase()
             boost::shared_ptr<AbstractCellProperty> p_neck_type =
                 mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<FoveolarCellProliferativeType>();
             mpCell->SetCellProliferativeType(p_neck_type);
+
+            // Let the foveolar cell killer schedule this cell's death
+            GlandContext<2>* p_context =
+                GastricGlandCellPopulation<2>::FindGlandContext(WntConcentration<2>::Instance()->rGetCellPopulation());
+            if (p_context)
+            {
+                p_context->RecordNewFoveolarCell(mpCell);
+            }
+        }
+    }
+
+    // The population rebuilds its rest lengths, which depend on cell types, only when told of a change
+    if (mpCell->GetCellProliferativeType() != p_previous_type)
+    {
+        GlandContext<2>* p_context =
+            GastricGlandCellPopulation<2>::FindGlandContext(WntConcentration<2>::Instance()->rGetCellPopulation());
+        if (p_context)
+        {
+            p_context->RecordCellTypeChange();
         }
     }
-    
 
     double time_since_birth = GetAge();
     assert(time_since_birth >= 0);
@@ -4,6 +4,9 @@
 #include "CellLocationIndexWriter.hpp"
 #include "FoveolarCellProliferativeType.hpp"
 #include "NeckCellProliferativeType.hpp"
+#include "CellPopulationAreaWriter.hpp"
+#include "CellVolumesWriter.hpp"
+#include "VoronoiDataWriter.hpp"
 
 
 template<unsigned DIM>
@@ -18,7 +21,8 @@ GastricGlandCellPopulation<DIM>::GastricGlandCellPopulation(
     :   MeshBasedCellPopulationWithGhostNodes<DIM>(
             rMesh, rCells, locationIndices, deleteMesh, ghostSpringStiffness),
         mMitosisRequiredSize(mitosisRequiredSize),
-        mFoveolarSizeMultiplier(foveolarSizeMultiplier)
+        mFoveolarSizeMultiplier(foveolarSizeMultiplier),
+        mRestLengthsNumTypeChanges(0)
 {}
 
 template<unsigned DIM>
@@ -29,7 +33,8 @@ GastricGlandCellPopulation<DIM>::GastricGlandCellPopulation(
     double ghostSpringStiffness)
     :   MeshBasedCellPopulationWithGhostNodes<DIM>(rMesh, ghostSpringStiffness),
         mMitosisRequiredSize(mitosisRequiredSize),
-        mFoveolarSizeMultiplier(foveolarSizeMultiplier)
+        mFoveolarSizeMultiplier(foveolarSizeMultiplier),
+        mRestLengthsNumTypeChanges(0)
 {
 }
 
@@ -65,12 +70,64 @@ bool GastricGlandCellPopulation<DIM>::IsRoomToDivide(CellPtr pCell)
 template <unsigned DIM>
 double GastricGlandCellPopulation<DIM>::GetRestLength(unsigned indexA, unsigned indexB)
 {
+    if (indexA < mNodeRestLengths.size() && indexB < mNodeRestLengths.size())
+    {
+        return mNodeRestLengths[indexA] + mNodeRestLengths[indexB];
+    }
+
+    // The table has not been built yet, e.g. just after loading from an archive
     CellPtr pCellA = this->GetCellUsingLocationIndex(indexA);
     CellPtr pCellB = this->GetCellUsingLocationIndex(indexB);
 
     return GetCellRestLength(pCellA) + GetCellRestLength(pCellB);
 }
 
+template <unsigned DIM>
+void GastricGlandCellPopulation<DIM>::Update(bool hasHadBirthsOrDeaths)
+{
+    GlandProfileScope scope(GetProfiler(), PROFILE_REMESH);
+
+    MeshBasedCellPopulationWithGhostNodes<DIM>::Update(hasHadBirthsOrDeaths);
+
+    // IsRoomToDivide() needs cell areas, which the base class only tessellates for
+    // when a Voronoi-based writer is attached
+    if (!this->UseAreaBasedDampingConstant()
+        && !this->template HasWriter<VoronoiDataWriter>()
+        && !this->template HasWriter<CellPopulationAreaWriter>()
+        && !this->template HasWriter<CellVolumesWriter>())
+    {
+        this->CreateVoronoiTessellation();
+    }
+
+    // Node indices only change with births and deaths, and rest lengths only with cell types
+    if (hasHadBirthsOrDeaths
+        || mNodeRestLengths.size() != this->rGetMesh().GetNumAllNodes()
+        || !mpGlandContext
+        || mpGlandContext->GetNumCellTypeChanges() != mRestLengthsNumTypeChanges)
+    {
+        UpdateRestLengths();
+    }
+}
+
+template <unsigned DIM>
+void GastricGlandCellPopulation<DIM>::UpdateRestLengths()
+{
+    // Ghost nodes never take part in GetRestLength(), so they keep the default
+    mNodeRestLengths.assign(this->rGetMesh().GetNumAllNodes(), 0.5);
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->Begin();
+         cell_iter != this->End();
+         ++cell_iter)
+    {
+        mNodeRestLengths[this->GetLocationIndexUsingCell(*cell_iter)] = GetCellRestLength(*cell_iter);
+    }
+
+    if (mpGlandContext)
+    {
+        mRestLengthsNumTypeChanges = mpGlandContext->GetNumCellTypeChanges();
+    }
+}
+
 template <unsigned DIM>
 double GastricGlandCellPopulation<DIM>::GetMitosisRequiredSize() const
 {
@@ -93,6 +150,71 @@ template <unsigned DIM>
 void GastricGlandCellPopulation<DIM>::SetFoveolarSizeMultiplier(double mul)
 {
     mFoveolarSizeMultiplier = mul;
+
+    if (!mNodeRestLengths.empty())
+    {
+        UpdateRestLengths();
+    }
+}
+
+template <unsigned DIM>
+void GastricGlandCellPopulation<DIM>::SetGlandContext(boost::shared_ptr<GlandContext<DIM> > pContext)
+{
+    mpGlandContext = pContext;
+}
+
+template <unsigned DIM>
+GlandContext<DIM>& GastricGlandCellPopulation<DIM>::rGetGlandContext()
+{
+    if (!mpGlandContext)
+    {
+        EXCEPTION("No GlandContext has been attached to this GastricGlandCellPopulation");
+    }
+    return *mpGlandContext;
+}
+
+template <unsigned DIM>
+bool GastricGlandCellPopulation<DIM>::HasGlandContext() const
+{
+    return bool(mpGlandContext);
+}
+
+template <unsigned DIM>
+GlandProfiler* GastricGlandCellPopulation<DIM>::GetProfiler()
+{
+    return mpGlandContext ? &(mpGlandContext->rGetProfiler()) : nullptr;
+}
+
+template <unsigned DIM>
+GlandProfiler* GastricGlandCellPopulation<DIM>::FindProfiler(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    GastricGlandCellPopulation<DIM>* p_population = dynamic_cast<GastricGlandCellPopulation<DIM>*>(&rCellPopulation);
+    return p_population ? p_population->GetProfiler() : nullptr;
+}
+
+template <unsigned DIM>
+GlandContext<DIM>* GastricGlandCellPopulation<DIM>::FindGlandContext(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    GastricGlandCellPopulation<DIM>* p_population = dynamic_cast<GastricGlandCellPopulation<DIM>*>(&rCellPopulation);
+    return (p_population && p_population->HasGlandContext()) ? p_population->mpGlandContext.get() : nullptr;
+}
+
+template <unsigned DIM>
+GlandCellIndex<DIM>& GastricGlandCellPopulation<DIM>::rFindCellIndex(AbstractCellPopulation<DIM>& rCellPopulation, GlandCellIndex<DIM>& rOwnIndex)
+{
+    GastricGlandCellPopulation<DIM>* p_population = dynamic_cast<GastricGlandCellPopulation<DIM>*>(&rCellPopulation);
+    GlandCellIndex<DIM>& r_index = (p_population && p_population->HasGlandContext())
+        ? p_population->rGetGlandContext().rGetCellIndex() : rOwnIndex;
+    r_index.Refresh(rCellPopulation);
+    return r_index;
+}
+
+template <unsigned DIM>
+void GastricGlandCellPopulation<DIM>::WriteResultsToFiles(const std::string& rDirectory)
+{
+    GlandProfileScope scope(GetProfiler(), PROFILE_OUTPUT);
+
+    MeshBasedCellPopulationWithGhostNodes<DIM>::WriteResultsToFiles(rDirectory);
 }
 
 template<unsigned DIM>
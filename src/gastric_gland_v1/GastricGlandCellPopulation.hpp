@@ -3,11 +3,13 @@
 #define GASTRICGLANDCELLPOPULATION_HPP_
 
 #include "MeshBasedCellPopulationWithGhostNodes.hpp"
+#include "GlandContext.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/set.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 template <unsigned DIM>
@@ -27,6 +29,32 @@ protected:
     double mMitosisRequiredSize;
     double mFoveolarSizeMultiplier;
 
+    /**
+     * The per-simulation gland state, owned by the simulation and attached here so that
+     * cell-cycle models and modifiers can reach it. Not archived with the population;
+     * the simulation archives it and reattaches it on load.
+     */
+    boost::shared_ptr<GlandContext<DIM> > mpGlandContext;
+
+    /**
+     * Rest length contribution of each node, indexed by location index, so that
+     * GetRestLength() reads two doubles rather than looking up two cells. Rebuilt
+     * by Update() only after divisions, deaths or type changes.
+     * Not archived; rebuilt on the first Update() after loading.
+     */
+    std::vector<double> mNodeRestLengths;
+
+    /** The gland context's count of cell type changes when mNodeRestLengths was last rebuilt. */
+    unsigned mRestLengthsNumTypeChanges;
+
+    /**
+     * Rebuild mNodeRestLengths from the current cells.
+     */
+    void UpdateRestLengths();
+
+    /** GlandCheckpoint saves and restores state which has no public accessors. */
+    friend class GlandCheckpoint;
+
 public:
     GastricGlandCellPopulation(
         MutableMesh<DIM, DIM>& rMesh,
@@ -51,12 +79,80 @@ public:
 
     virtual double GetRestLength(unsigned indexA, unsigned indexB) override;
 
+    /**
+     * Overridden Update() method.
+     *
+     * Updates the population as usual, then rebuilds the rest length table if a cell
+     * has divided, died or changed type since it was last built. Type changes are
+     * recorded in the gland context, so without one the table is rebuilt every time.
+     *
+     * @param hasHadBirthsOrDeaths whether the population has had births or deaths this step
+     */
+    virtual void Update(bool hasHadBirthsOrDeaths=true) override;
+
     double GetMitosisRequiredSize() const;
     void SetMitosisRequiredSize(double size);
 
     double GetFoveolarSizeMultiplier() const;
     void SetFoveolarSizeMultiplier(double mul);
 
+    /**
+     * Attach the per-simulation gland context.
+     *
+     * @param pContext the context owned by the simulation
+     */
+    void SetGlandContext(boost::shared_ptr<GlandContext<DIM> > pContext);
+
+    /**
+     * @return the attached gland context; throws if none has been attached
+     */
+    GlandContext<DIM>& rGetGlandContext();
+
+    /**
+     * @return whether a gland context has been attached
+     */
+    bool HasGlandContext() const;
+
+    /**
+     * @return the profiler of the attached gland context, or null if none has been attached
+     */
+    GlandProfiler* GetProfiler();
+
+    /**
+     * Find the profiler through which a component working on a population should time itself.
+     *
+     * @param rCellPopulation a cell population
+     * @return the profiler of its gland context, or null if it is not a GastricGlandCellPopulation
+     *     with a context attached
+     */
+    static GlandProfiler* FindProfiler(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find the gland context of a population.
+     *
+     * @param rCellPopulation a cell population
+     * @return its gland context, or null if it is not a GastricGlandCellPopulation with a context attached
+     */
+    static GlandContext<DIM>* FindGlandContext(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find the index through which a cell killer working on a population should find its
+     * candidate cells, brought up to date for the current time step.
+     *
+     * @param rCellPopulation a cell population
+     * @param rOwnIndex an index owned by the caller, used if the population is not a
+     *     GastricGlandCellPopulation with a context attached
+     * @return the index of the population's gland context, shared by all its killers, or rOwnIndex
+     */
+    static GlandCellIndex<DIM>& rFindCellIndex(AbstractCellPopulation<DIM>& rCellPopulation, GlandCellIndex<DIM>& rOwnIndex);
+
+    /**
+     * Overridden WriteResultsToFiles() method, timed as the output phase when profiling.
+     *
+     * @param rDirectory pathname of the output directory, relative to where Chaste output is stored
+     */
+    virtual void WriteResultsToFiles(const std::string& rDirectory) override;
+
     void OutputCellPopulationParameters(out_stream& rParamsFile);
 
 };
@@ -122,69 +122,108 @@ void GastricGlandCellsGenerator<CELL_CYCLE_MODEL>::Generate(
 
     RandomNumberGenerator* p_random_num_gen = RandomNumberGenerator::Instance();
 
+    // Resolve the mesh type once, rather than once per node
+    TetrahedralMesh<2,2>* p_tetrahedral_mesh = dynamic_cast<TetrahedralMesh<2,2>*>(pMesh);
+    PottsMesh<2>* p_potts_mesh = dynamic_cast<PottsMesh<2>*>(pMesh);
+    VertexMesh<2,2>* p_vertex_mesh = dynamic_cast<VertexMesh<2,2>*>(pMesh);
+
     unsigned mesh_size;
-    if (dynamic_cast<TetrahedralMesh<2,2>*>(pMesh))
+    if (p_tetrahedral_mesh)
     {
         mesh_size = pMesh->GetNumNodes();
-        unsigned num_cells = locationIndices.empty() ? pMesh->GetNumNodes() : locationIndices.size();
-        rCells.reserve(num_cells);
     }
-    else if (dynamic_cast<PottsMesh<2>*>(pMesh))
+    else if (p_potts_mesh)
     {
-        mesh_size = static_cast<PottsMesh<2>*>(pMesh)->GetNumElements();
-        rCells.reserve(mesh_size);
+        mesh_size = p_potts_mesh->GetNumElements();
     }
     else
     {
-        // Note the double brackets, to stop the macro thinking is has two arguments.
-        assert((dynamic_cast<VertexMesh<2,2>*>(pMesh)));
-        mesh_size = static_cast<VertexMesh<2,2>*>(pMesh)->GetNumElements();
-        rCells.reserve(mesh_size);
+        assert(p_vertex_mesh);
+        mesh_size = p_vertex_mesh->GetNumElements();
+    }
+
+    /*
+     * Mark which nodes hold real cells, so that each node is checked in constant time.
+     * Only the location indices of a tetrahedral mesh select nodes; as before, they
+     * are ignored for Potts and vertex meshes.
+     */
+    std::vector<bool> is_real_cell(mesh_size, true);
+    if (p_tetrahedral_mesh && !locationIndices.empty())
+    {
+        is_real_cell.assign(mesh_size, false);
+        for (unsigned index : locationIndices)
+        {
+            if (index < mesh_size)
+            {
+                is_real_cell[index] = true;
+            }
+        }
+    }
+    unsigned num_cells = 0;
+    for (unsigned i=0; i<mesh_size; i++)
+    {
+        num_cells += is_real_cell[i];
     }
+    rCells.reserve(num_cells);
 
-    boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
+    // Look up the shared cell properties once
+    CellPropertyRegistry* p_registry = CellPropertyRegistry::Instance();
+    boost::shared_ptr<AbstractCellProperty> p_state(p_registry->Get<WildTypeCellMutationState>());
+    boost::shared_ptr<AbstractCellProperty> p_transit_type(p_registry->Get<TransitCellProliferativeType>());
+    boost::shared_ptr<AbstractCellProperty> p_neck_type(p_registry->Get<NeckCellProliferativeType>());
+    boost::shared_ptr<AbstractCellProperty> p_foveolar_type(p_registry->Get<FoveolarCellProliferativeType>());
+
+    // Typical cycle times are the same for every newly created model of a given type
+    double typical_transit_cycle_time;
+    double typical_stem_cycle_time;
+    {
+        CELL_CYCLE_MODEL prototype_model;
+        typical_transit_cycle_time = prototype_model.GetAverageTransitCellCycleTime();
+        typical_stem_cycle_time = prototype_model.GetAverageStemCellCycleTime();
+    }
 
     // Loop over the mesh and populate rCells
     for (unsigned i=0; i<mesh_size; i++)
     {
+        /*
+         * A random birth time is drawn for every node, including ghost nodes, so that
+         * the random number sequence, and hence a simulation's results for a given seed,
+         * are as they were when a cell was made for every node. Initialising a cell-cycle
+         * model may also draw random numbers, so in that case a ghost node still gets a
+         * cell, which is then discarded.
+         */
+        double birth_time = 0.0;
+        if (randomBirthTimes)
+        {
+            birth_time = -p_random_num_gen->ranf();
+        }
+        if (!is_real_cell[i] && !initialiseCells)
+        {
+            continue;
+        }
+
         // Find the location of this cell
         double y = 0.0;
-        if (dynamic_cast<TetrahedralMesh<2,2>*>(pMesh))
+        if (p_tetrahedral_mesh)
         {
-            if (locationIndices.empty())
+            if (is_real_cell[i])
             {
-                y = pMesh->GetNode(i)->GetPoint().rGetLocation()[1];
-
-            }
-            else if (std::find(locationIndices.begin(), locationIndices.end(), i) != locationIndices.end())
-            {
-                y = pMesh->GetNode(i)->GetPoint().rGetLocation()[1];
+                y = pMesh->GetNode(i)->rGetLocation()[1];
             }
         }
-        else if (dynamic_cast<PottsMesh<2>*>(pMesh))
+        else if (p_potts_mesh)
         {
-            y = static_cast<PottsMesh<2>*>(pMesh)->GetCentroidOfElement(i)[1];
+            y = p_potts_mesh->GetCentroidOfElement(i)[1];
         }
         else
         {
-            // Note the double brackets, to stop the macro thinking is has two arguments.
-            assert((dynamic_cast<VertexMesh<2,2>*>(pMesh)));
-            y = static_cast<VertexMesh<2,2>*>(pMesh)->GetCentroidOfElement(i)[1];
+            y = p_vertex_mesh->GetCentroidOfElement(i)[1];
         }
 
         // Create a cell-cycle model and set the spatial dimension
         CELL_CYCLE_MODEL* p_cell_cycle_model = new CELL_CYCLE_MODEL;
         p_cell_cycle_model->SetDimension(2);
 
-        double typical_transit_cycle_time = p_cell_cycle_model->GetAverageTransitCellCycleTime();
-        double typical_stem_cycle_time = p_cell_cycle_model->GetAverageStemCellCycleTime();
-
-        double birth_time = 0.0;
-        if (randomBirthTimes)
-        {
-            birth_time = -p_random_num_gen->ranf();
-        }
-
         // Create a cell
         CellPtr p_cell(new Cell(p_state, p_cell_cycle_model));
 
@@ -192,25 +231,25 @@ void GastricGlandCellsGenerator<CELL_CYCLE_MODEL>::Generate(
         if (y <= yBase)
         {
             // In base
-            p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+            p_cell->SetCellProliferativeType(p_transit_type);
             birth_time *= typical_transit_cycle_time;
         }
         else if (y <= yNeck)
         {
             // In Neck
-            p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<NeckCellProliferativeType>());
+            p_cell->SetCellProliferativeType(p_neck_type);
             birth_time *= typical_transit_cycle_time;
         }
         else if (y <= yIsthmus)
         {
             // In Isthmus
-            p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+            p_cell->SetCellProliferativeType(p_transit_type);
             birth_time *= typical_stem_cycle_time;
         }
         else
         {
             // In Foveolar
-            p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<FoveolarCellProliferativeType>());
+            p_cell->SetCellProliferativeType(p_foveolar_type);
             birth_time *= typical_transit_cycle_time;
         }
 
@@ -222,11 +261,7 @@ void GastricGlandCellsGenerator<CELL_CYCLE_MODEL>::Generate(
 
         p_cell->SetBirthTime(birth_time);
 
-        if (locationIndices.empty())
-        {
-            rCells.push_back(p_cell);
-        }
-        else if (std::find(locationIndices.begin(), locationIndices.end(), i) != locationIndices.end())
+        if (is_real_cell[i])
         {
             rCells.push_back(p_cell);
         }
@@ -46,6 +46,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "VanLeeuwen2009WntSwatCellCycleModelHypothesisOne.hpp"
 #include "VanLeeuwen2009WntSwatCellCycleModelHypothesisTwo.hpp"
 #include "WntConcentration.hpp"
+#include "CellBasedSimulationArchiver.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "OutputFileHandler.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
 
 GastricGlandSimulation2d::GastricGlandSimulation2d(AbstractCellPopulation<2>& rCellPopulation,
                                      bool deleteCellPopulationInDestructor,
@@ -54,7 +61,16 @@ GastricGlandSimulation2d::GastricGlandSimulation2d(AbstractCellPopulation<2>& rC
     : OffLatticeSimulation<2>(rCellPopulation,
                              deleteCellPopulationInDestructor,
                              initialiseCells),
-      m_cellAncestorIndex(ancestorIndex)
+      m_cellAncestorIndex(ancestorIndex),
+      m_maxCells(UINT_MAX),
+      mNextEpoch(0),
+      mpGlandContext(new GlandContext<2>),
+      mCheckpointFormat(CHECKPOINT_FORMAT_GLAND),
+      mUseAdaptiveDt(false),
+      mMinDt(0.0),
+      mMaxDt(0.0),
+      mTargetDisplacement(0.0),
+      mIntervalMaxDisplacement(0.0)
 {
     /* Throw an exception message if not using a  MeshBasedCellPopulation or a VertexBasedCellPopulation.
      * This is to catch NodeBasedCellPopulations as AbstactOnLatticeBasedCellPopulations are caught in
@@ -65,6 +81,12 @@ GastricGlandSimulation2d::GastricGlandSimulation2d(AbstractCellPopulation<2>& rC
         EXCEPTION("GastricGlandSimulation2d is to be used with MeshBasedCellPopulation (or subclasses) only");
     }
 
+    // Share this simulation's context with the population, through which cell-cycle models and modifiers reach it
+    if (GastricGlandCellPopulation<2>* p_gland_population = dynamic_cast<GastricGlandCellPopulation<2>*>(&mrCellPopulation))
+    {
+        p_gland_population->SetGlandContext(mpGlandContext);
+    }
+
     if (dynamic_cast<MeshBasedCellPopulation<2>*>(&mrCellPopulation))
     {
         MAKE_PTR(CryptCentreBasedDivisionRule<2>, p_centre_div_rule);
@@ -108,6 +130,13 @@ void GastricGlandSimulation2d::SetupSolve()
     {
         *mpVizSetupFile << "BetaCatenin\n";
     }
+
+    if (mUseAdaptiveDt)
+    {
+        // The numerical method may have been replaced since SetAdaptiveDt() was called
+        mpNumericalMethod->SetUseAdaptiveTimestep(true);
+        mIntervalMaxDisplacement = 0.0;
+    }
 }
 
 bool GastricGlandSimulation2d::StoppingEventHasOccurred()
@@ -116,6 +145,161 @@ bool GastricGlandSimulation2d::StoppingEventHasOccurred()
     return false;
 }
 
+void GastricGlandSimulation2d::UpdateCellPopulation()
+{
+    // Each time step starts here, so this is where the profiler's steps begin
+    GlandProfiler& r_profiler = mpGlandContext->rGetProfiler();
+    if (r_profiler.IsEnabled())
+    {
+        r_profiler.BeginStep(mrCellPopulation.rGetCells().size());
+    }
+
+    // The killers share one index of the cells per step, built by the first of them to run
+    mpGlandContext->rGetCellIndex().Invalidate();
+
+    // Output has just been written if a sampling interval has ended, so the time step may change here
+    SimulationTime* p_time = SimulationTime::Instance();
+    if (mUseAdaptiveDt && !p_time->IsFinished() && p_time->GetTimeStepsElapsed() > 0
+        && p_time->GetTimeStepsElapsed() % mSamplingTimestepMultiple == 0)
+    {
+        AdaptDt();
+    }
+
+    {
+        GlandProfileScope scope(&r_profiler, PROFILE_UPDATE_CELL_POPULATION);
+        OffLatticeSimulation<2>::UpdateCellPopulation();
+    }
+
+    GlandProfileScope scope(&r_profiler, PROFILE_EPOCHS);
+    RunDueEpochs();
+}
+
+unsigned GastricGlandSimulation2d::DoCellBirth()
+{
+    GlandProfileScope scope(&(mpGlandContext->rGetProfiler()), PROFILE_CELL_CYCLE);
+    return OffLatticeSimulation<2>::DoCellBirth();
+}
+
+void GastricGlandSimulation2d::UpdateCellLocationsAndTopology()
+{
+    GlandProfileScope scope(&(mpGlandContext->rGetProfiler()), PROFILE_UPDATE_CELL_LOCATIONS);
+
+    if (!mUseAdaptiveDt)
+    {
+        OffLatticeSimulation<2>::UpdateCellLocationsAndTopology();
+        return;
+    }
+
+    AbstractMesh<2, 2>& r_mesh = mrCellPopulation.rGetMesh();
+    mOldNodeLocations.resize(r_mesh.GetNumAllNodes());
+    for (AbstractMesh<2, 2>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mOldNodeLocations[node_iter->GetIndex()] = node_iter->rGetLocation();
+    }
+
+    OffLatticeSimulation<2>::UpdateCellLocationsAndTopology();
+
+    // The mesh measures across its periodic boundary, so nodes crossing it are not seen to jump
+    for (AbstractMesh<2, 2>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double displacement = norm_2(r_mesh.GetVectorFromAtoB(mOldNodeLocations[node_iter->GetIndex()], node_iter->rGetLocation()));
+        mIntervalMaxDisplacement = std::max(mIntervalMaxDisplacement, displacement);
+    }
+}
+
+void GastricGlandSimulation2d::AdaptDt()
+{
+    SimulationTime* p_time = SimulationTime::Instance();
+    const double interval = mDt*mSamplingTimestepMultiple;
+    const double remaining = mEndTime - p_time->GetTime();
+
+    // Only change the step where the rest of the run is a whole number of intervals
+    unsigned num_intervals = static_cast<unsigned>(remaining/interval + 0.5);
+    if (num_intervals == 0 || fabs(num_intervals*interval - remaining) > 1e-8*interval)
+    {
+        return;
+    }
+
+    double proposed_dt = (mIntervalMaxDisplacement > 0.0)
+        ? mDt*mTargetDisplacement/mIntervalMaxDisplacement : mMaxDt;
+    proposed_dt = std::min(proposed_dt, 2.0*mDt);
+    proposed_dt = std::max(mMinDt, std::min(mMaxDt, proposed_dt));
+    mIntervalMaxDisplacement = 0.0;
+
+    // The largest step no longer than proposed_dt which divides the interval
+    unsigned steps_per_interval = std::max(1u, static_cast<unsigned>(ceil(interval/proposed_dt - 1e-9)));
+    if (steps_per_interval == mSamplingTimestepMultiple)
+    {
+        return;
+    }
+
+    mSamplingTimestepMultiple = steps_per_interval;
+    mDt = interval/steps_per_interval;
+    p_time->ResetEndTimeAndNumberOfTimeSteps(mEndTime, num_intervals*steps_per_interval);
+}
+
+void GastricGlandSimulation2d::RunDueEpochs()
+{
+    double current_time = SimulationTime::Instance()->GetTime();
+
+    while (mNextEpoch < mEpochTimes.size() && mEpochTimes[mNextEpoch] <= current_time + 0.5*mDt)
+    {
+        unsigned actions = mEpochActions[mNextEpoch];
+
+        // Advance first, so that a checkpoint taken below does not re-run this epoch on load
+        mNextEpoch++;
+
+        if (actions & EPOCH_LABEL_BASE_ANCESTORS)
+        {
+            LabelBaseCellAncestors();
+        }
+        if (actions & EPOCH_LABEL_ISTHMUS_ANCESTORS)
+        {
+            LabelIsthmusCellAncestors();
+        }
+        if (actions & EPOCH_LABEL_NECK_ANCESTORS)
+        {
+            LabelNeckCellAncestors();
+        }
+        if (actions & EPOCH_CHECKPOINT)
+        {
+            SaveCheckpoint();
+        }
+    }
+}
+
+void GastricGlandSimulation2d::AddEpoch(double time, unsigned actions)
+{
+    std::vector<double>::iterator it = std::lower_bound(mEpochTimes.begin() + mNextEpoch, mEpochTimes.end(), time);
+    unsigned index = it - mEpochTimes.begin();
+
+    if (it != mEpochTimes.end() && *it == time)
+    {
+        mEpochActions[index] |= actions;
+    }
+    else
+    {
+        mEpochTimes.insert(it, time);
+        mEpochActions.insert(mEpochActions.begin() + index, actions);
+    }
+}
+
+void GastricGlandSimulation2d::ClearEpochs()
+{
+    mEpochTimes.clear();
+    mEpochActions.clear();
+    mNextEpoch = 0;
+}
+
+unsigned GastricGlandSimulation2d::GetNumPendingEpochs() const
+{
+    return mEpochTimes.size() - mNextEpoch;
+}
+
 void GastricGlandSimulation2d::FixBottomCells()
 {
     // The CryptSimulationBoundaryCondition object is the first element of mBoundaryConditions
@@ -181,6 +365,66 @@ unsigned GastricGlandSimulation2d::GetCellAncestorIndex() const
 unsigned GastricGlandSimulation2d::GetMaxCells() const { return m_maxCells; }
 void GastricGlandSimulation2d::SetMaxCells(unsigned n) { m_maxCells = n; }
 
+void GastricGlandSimulation2d::SetAdaptiveDt(double minDt, double maxDt, double targetDisplacement)
+{
+    if (!(0.0 < minDt && minDt <= maxDt) || !(targetDisplacement > 0.0))
+    {
+        EXCEPTION("Adaptive time stepping needs 0 < minDt <= maxDt and a positive target displacement");
+    }
+    mUseAdaptiveDt = true;
+    mMinDt = minDt;
+    mMaxDt = maxDt;
+    mTargetDisplacement = targetDisplacement;
+    mpNumericalMethod->SetUseAdaptiveTimestep(true);
+}
+
+bool GastricGlandSimulation2d::GetUseAdaptiveDt() const
+{
+    return mUseAdaptiveDt;
+}
+
+GlandContext<2>& GastricGlandSimulation2d::rGetGlandContext()
+{
+    return *mpGlandContext;
+}
+
+GlandCheckpointFormat GastricGlandSimulation2d::GetCheckpointFormat() const
+{
+    return mCheckpointFormat;
+}
+
+void GastricGlandSimulation2d::SetCheckpointFormat(GlandCheckpointFormat format)
+{
+    mCheckpointFormat = format;
+}
+
+void GastricGlandSimulation2d::SaveCheckpoint()
+{
+    if (mCheckpointFormat == CHECKPOINT_FORMAT_GLAND)
+    {
+        GlandCheckpoint::Save(*this);
+    }
+    else
+    {
+        CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Save(this);
+    }
+}
+
+void GastricGlandSimulation2d::WriteProfileSummary()
+{
+    GlandProfiler& r_profiler = mpGlandContext->rGetProfiler();
+    if (!r_profiler.IsEnabled())
+    {
+        return;
+    }
+    r_profiler.EndStep();
+
+    OutputFileHandler output_file_handler(mSimulationOutputDirectory + "/", false);
+    out_stream p_file = output_file_handler.OpenOutputFile("profile.json");
+    r_profiler.WriteSummary(*p_file);
+    p_file->close();
+}
+
 void GastricGlandSimulation2d::OutputSimulationParameters(out_stream& rParamsFile)
 {
     double width = mrCellPopulation.GetWidth(0);
@@ -189,6 +433,16 @@ void GastricGlandSimulation2d::OutputSimulationParameters(out_stream& rParamsFil
     *rParamsFile << "\t\t<CryptCircumference>" << width << "</CryptCircumference>\n";
     *rParamsFile << "\t\t<UseFixedBottomCells>" << use_fixed_bottom_cells << "</UseFixedBottomCells>\n";
     *rParamsFile << "\t\t<MaxCells>" << m_maxCells << "</MaxCells>\n";
+    *rParamsFile << "\t\t<BaseHeight>" << mpGlandContext->GetBaseHeight() << "</BaseHeight>\n";
+    *rParamsFile << "\t\t<IsthmusBeginHeight>" << mpGlandContext->GetIsthmusBeginHeight() << "</IsthmusBeginHeight>\n";
+    *rParamsFile << "\t\t<IsthmusEndHeight>" << mpGlandContext->GetIsthmusEndHeight() << "</IsthmusEndHeight>\n";
+    *rParamsFile << "\t\t<UseAdaptiveDt>" << mUseAdaptiveDt << "</UseAdaptiveDt>\n";
+    if (mUseAdaptiveDt)
+    {
+        *rParamsFile << "\t\t<MinDt>" << mMinDt << "</MinDt>\n";
+        *rParamsFile << "\t\t<MaxDt>" << mMaxDt << "</MaxDt>\n";
+        *rParamsFile << "\t\t<TargetDisplacement>" << mTargetDisplacement << "</TargetDisplacement>\n";
+    }
 
     // Call method on direct parent class
     OffLatticeSimulation<2>::OutputSimulationParameters(rParamsFile);
@@ -37,7 +37,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GASTRICGLANDSIMULATION2D_HPP_
 
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "WntConcentration.hpp"
 #include "OffLatticeSimulation.hpp"
@@ -45,6 +48,20 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "GastricGlandSimulationBoundaryCondition.hpp"
 #include "CryptCentreBasedDivisionRule.hpp"
 #include "CryptVertexBasedDivisionRule.hpp"
+#include "GlandContext.hpp"
+#include "GlandCheckpoint.hpp"
+
+/**
+ * Actions which can be scheduled to run at an epoch of a GastricGlandSimulation2d.
+ * These are bit flags, so several actions may be combined for a single epoch.
+ */
+typedef enum GlandEpochAction_
+{
+    EPOCH_LABEL_BASE_ANCESTORS = 1u << 0,
+    EPOCH_LABEL_ISTHMUS_ANCESTORS = 1u << 1,
+    EPOCH_LABEL_NECK_ANCESTORS = 1u << 2,
+    EPOCH_CHECKPOINT = 1u << 3
+} GlandEpochAction;
 
 /**
  * A 2D crypt simulation object. For more details on the crypt geometry, see the
@@ -59,6 +76,45 @@ protected:
     unsigned m_cellAncestorIndex;
     unsigned m_maxCells;
 
+    /** Times at which scheduled epochs run, in increasing order. */
+    std::vector<double> mEpochTimes;
+
+    /** The GlandEpochAction flags to run at each of mEpochTimes. */
+    std::vector<unsigned> mEpochActions;
+
+    /** Index into mEpochTimes of the next epoch still to run. */
+    unsigned mNextEpoch;
+
+    /** The per-simulation gland state, shared with the cell population. */
+    boost::shared_ptr<GlandContext<2> > mpGlandContext;
+
+    /**
+     * The format in which SaveCheckpoint() writes. Not archived; defaults to
+     * CHECKPOINT_FORMAT_GLAND.
+     */
+    GlandCheckpointFormat mCheckpointFormat;
+
+    /** Whether the time step is chosen afresh for each sampling interval. Not archived. */
+    bool mUseAdaptiveDt;
+
+    /** The smallest time step the adaptive controller may choose. */
+    double mMinDt;
+
+    /** The largest time step the adaptive controller may choose. */
+    double mMaxDt;
+
+    /** The largest node displacement per step which the adaptive controller aims for. */
+    double mTargetDisplacement;
+
+    /** The largest node displacement in any step of the current sampling interval. */
+    double mIntervalMaxDisplacement;
+
+    /** Scratch: node locations at the start of a step, indexed by node index. */
+    std::vector<c_vector<double, 2> > mOldNodeLocations;
+
+    /** GlandCheckpoint saves and restores state which has no public setters. */
+    friend class GlandCheckpoint;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -72,6 +128,16 @@ protected:
     {
         archive & boost::serialization::base_object<OffLatticeSimulation<2> >(*this);
 
+        // Archives written before version 1 hold none of these; the constructor's values stand
+        if (version >= 1)
+        {
+            archive & m_maxCells;
+            archive & mEpochTimes;
+            archive & mEpochActions;
+            archive & mNextEpoch;
+            archive & *mpGlandContext;
+        }
+
         SerializableSingleton<WntConcentration<2> >* p_wnt_wrapper = WntConcentration<2>::Instance()->GetSerializationWrapper();
         archive & p_wnt_wrapper;
     }
@@ -79,12 +145,50 @@ protected:
     /**
      * Overridden SetupSolve() method.
      *
-     * Write initial beta catenin results to file if required.
+     * Write initial beta catenin results to file if required, and switch on adaptive
+     * substepping in the numerical method if the time step is adaptive.
      */
     void SetupSolve();
 
     bool StoppingEventHasOccurred() override;
 
+    /**
+     * Overridden UpdateCellPopulation() method.
+     *
+     * Carries out births, deaths and the population update as usual, then runs
+     * any scheduled epochs that have become due.
+     */
+    void UpdateCellPopulation() override;
+
+    /**
+     * Overridden DoCellBirth() method, timed when profiling.
+     *
+     * Asking each cell whether it is ready to divide runs its cell-cycle model, so this
+     * is where the cell-cycle updates are timed.
+     *
+     * @return the number of births that occurred
+     */
+    unsigned DoCellBirth() override;
+
+    /**
+     * Overridden UpdateCellLocationsAndTopology() method, timed when profiling.
+     *
+     * With an adaptive time step, also records the largest node displacement.
+     */
+    void UpdateCellLocationsAndTopology() override;
+
+    /**
+     * Choose the time step for the next sampling interval from the largest node displacement
+     * in the last one. The time step divides the sampling interval exactly, so output times
+     * do not change; it grows at most twofold per interval and shrinks as far as needed.
+     */
+    void AdaptDt();
+
+    /**
+     * Run the actions of every scheduled epoch whose time has been reached.
+     */
+    void RunDueEpochs();
+
 public:
 
     /**
@@ -120,9 +224,73 @@ public:
 
     unsigned GetCellAncestorIndex() const;
 
+    /**
+     * Schedule actions to run in process once the simulation reaches a given time,
+     * without stopping the solve. Epochs at the same time are merged.
+     *
+     * @param time the simulation time at which to run the actions
+     * @param actions bitwise-or of GlandEpochAction flags
+     */
+    void AddEpoch(double time, unsigned actions);
+
+    /**
+     * Remove all scheduled epochs.
+     */
+    void ClearEpochs();
+
+    /** @return the number of scheduled epochs which have not yet run. */
+    unsigned GetNumPendingEpochs() const;
+
     unsigned GetMaxCells() const;
     void SetMaxCells(unsigned n);
 
+    /**
+     * Choose the time step afresh for each sampling interval, aiming for a largest node
+     * displacement per step of targetDisplacement. Within a step, moves which exceed the
+     * population's absolute movement threshold, as just after divisions, are split into
+     * substeps. Call after SetDt() and SetSamplingTimestepMultiple(); the sampling interval,
+     * their product, stays fixed. Not archived.
+     *
+     * @param minDt the smallest time step to use
+     * @param maxDt the largest time step to use
+     * @param targetDisplacement the largest node displacement per step to aim for
+     */
+    void SetAdaptiveDt(double minDt, double maxDt, double targetDisplacement);
+
+    /**
+     * @return whether the time step is chosen afresh for each sampling interval
+     */
+    bool GetUseAdaptiveDt() const;
+
+    /**
+     * @return the gland context owned by this simulation
+     */
+    GlandContext<2>& rGetGlandContext();
+
+    /**
+     * @return the format in which SaveCheckpoint() writes
+     */
+    GlandCheckpointFormat GetCheckpointFormat() const;
+
+    /**
+     * Set the format in which SaveCheckpoint() writes.
+     *
+     * @param format the checkpoint format
+     */
+    void SetCheckpointFormat(GlandCheckpointFormat format);
+
+    /**
+     * Save the simulation to the archive folder of its output directory, using
+     * GlandCheckpoint or, as a fallback, CellBasedSimulationArchiver.
+     */
+    void SaveCheckpoint();
+
+    /**
+     * Write the profiler summary to profile.json in the results directory of the
+     * last solve. Does nothing unless the context's profiler is enabled.
+     */
+    void WriteProfileSummary();
+
     /**
      * Outputs simulation parameters to file
      *
@@ -142,6 +310,16 @@ namespace boost
 {
 namespace serialization
 {
+/**
+ * Version 1 adds the cell limit, the epoch schedule and the gland context.
+ */
+template<>
+struct version<GastricGlandSimulation2d>
+{
+    ///Macro to set the version number of templated archive in known versions of Boost
+    CHASTE_VERSION_CONTENT(1);
+};
+
 /**
  * Serialize information required to construct a GastricGlandSimulation2d.
  */
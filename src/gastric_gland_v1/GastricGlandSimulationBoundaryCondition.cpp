@@ -39,6 +39,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "MeshBasedCellPopulationWithGhostNodes.hpp"
 #include "RandomNumberGenerator.hpp"
 #include "StemCellProliferativeType.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 template<unsigned DIM>
 GastricGlandSimulationBoundaryCondition<DIM>::GastricGlandSimulationBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation)
@@ -50,6 +51,8 @@ GastricGlandSimulationBoundaryCondition<DIM>::GastricGlandSimulationBoundaryCond
 template<unsigned DIM>
 void GastricGlandSimulationBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
 {
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(*this->mpCellPopulation), PROFILE_BOUNDARY_CONDITION);
+
     // We only allow jiggling of bottom cells in 2D
     if (DIM == 1)
     {
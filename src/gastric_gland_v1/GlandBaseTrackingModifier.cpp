@@ -35,13 +35,15 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GlandBaseTrackingModifier.hpp"
 #include "MeshBasedCellPopulation.hpp"
-#include "GastricGlandBasePosition.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
 
 #include "UblasVectorInclude.hpp"
 
 template<unsigned DIM>
 GlandBaseTrackingModifier<DIM>::GlandBaseTrackingModifier()
-    : AbstractCellBasedSimulationModifier<DIM>()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mUpdatePopulationEachStep(true)
 {
 }
 
@@ -53,6 +55,8 @@ GlandBaseTrackingModifier<DIM>::~GlandBaseTrackingModifier()
 template<unsigned DIM>
 void GlandBaseTrackingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(rCellPopulation), PROFILE_BASE_TRACKING);
+
     UpdateCellData(rCellPopulation);
 }
 
@@ -69,9 +73,6 @@ void GlandBaseTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>&
 template<unsigned DIM>
 void GlandBaseTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
-    // Make sure the cell population is updated
-    rCellPopulation.Update();
-
     switch (DIM)
     {
         case 1:
@@ -79,6 +80,22 @@ void GlandBaseTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,D
             break;
         case 2:
         {
+            GastricGlandCellPopulation<2>* p_population = dynamic_cast<GastricGlandCellPopulation<2>*>(&rCellPopulation);
+            if (p_population == nullptr)
+            {
+                EXCEPTION("GlandBaseTrackingModifier is to be used with a GastricGlandCellPopulation only");
+            }
+
+            if (!mUpdatePopulationEachStep)
+            {
+                p_population->rGetGlandContext().SetBasePosition(FindLowestRealNode(*p_population));
+                UpdateZones(*p_population);
+                break;
+            }
+
+            // Make sure the cell population is updated
+            rCellPopulation.Update();
+
             c_vector<double, 2> lowest_position;
             lowest_position[1] = DBL_MAX;
             // Iterate over cell population 
@@ -93,7 +110,8 @@ void GlandBaseTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,D
                     lowest_position = cell_location; 
             }
 
-            GastricGlandBasePosition<2>::Instance()->SetBasePosition(lowest_position);
+            p_population->rGetGlandContext().SetBasePosition(lowest_position);
+            UpdateZones(*p_population);
             break;
         }
         case 3:
@@ -106,10 +124,81 @@ void GlandBaseTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,D
 
 }
 
+template<unsigned DIM>
+c_vector<double, 2> GlandBaseTrackingModifier<DIM>::FindLowestRealNode(GastricGlandCellPopulation<2>& rPopulation)
+{
+    MutableMesh<2,2>& r_mesh = rPopulation.rGetMesh();
+
+    // Births and node movement leave the node indices valid, so only remesh if nodes are awaiting removal
+    if (r_mesh.GetNumAllNodes() != r_mesh.GetNumNodes())
+    {
+        rPopulation.Update();
+    }
+
+    c_vector<double, 2> lowest_position = zero_vector<double>(2);
+    lowest_position[1] = DBL_MAX;
+
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+    for (unsigned index=0; index<num_nodes; index++)
+    {
+        Node<2>* p_node = r_mesh.GetNode(index);
+        if (!p_node->IsDeleted() && !rPopulation.IsGhostNode(index)
+            && p_node->rGetLocation()[1] < lowest_position[1])
+        {
+            lowest_position = p_node->rGetLocation();
+        }
+    }
+    return lowest_position;
+}
+
+template<unsigned DIM>
+void GlandBaseTrackingModifier<DIM>::UpdateZones(GastricGlandCellPopulation<2>& rPopulation)
+{
+    GlandContext<2>& r_context = rPopulation.rGetGlandContext();
+    MutableMesh<2,2>& r_mesh = rPopulation.rGetMesh();
+
+    // Gather node heights into a contiguous array and classify them together
+    std::vector<double>& r_heights = r_context.rGetNodeHeights();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+    r_heights.resize(num_nodes);
+    for (unsigned index=0; index<num_nodes; index++)
+    {
+        r_heights[index] = r_mesh.GetNode(index)->rGetLocation()[1];
+    }
+    r_context.ClassifyNodeZones();
+
+    const std::vector<unsigned char>& r_zones = r_context.rGetNodeZones();
+    for (typename AbstractCellPopulation<2>::Iterator cell_iter = rPopulation.Begin();
+         cell_iter != rPopulation.End();
+         ++cell_iter)
+    {
+        GastricGlandCellCycleModelV2* p_model = dynamic_cast<GastricGlandCellCycleModelV2*>(cell_iter->GetCellCycleModel());
+        if (p_model != nullptr)
+        {
+            p_model->SetGlandPopulation(&rPopulation);
+            p_model->SetZone(r_zones[rPopulation.GetLocationIndexUsingCell(*cell_iter)]);
+        }
+    }
+}
+
+template<unsigned DIM>
+bool GlandBaseTrackingModifier<DIM>::GetUpdatePopulationEachStep() const
+{
+    return mUpdatePopulationEachStep;
+}
+
+template<unsigned DIM>
+void GlandBaseTrackingModifier<DIM>::SetUpdatePopulationEachStep(bool updatePopulationEachStep)
+{
+    mUpdatePopulationEachStep = updatePopulationEachStep;
+}
+
 template<unsigned DIM>
 void GlandBaseTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
 {
-    // No parameters to output, so just call method on direct parent class
+    *rParamsFile << "\t\t\t<UpdatePopulationEachStep>" << mUpdatePopulationEachStep << "</UpdatePopulationEachStep>\n";
+
+    // Call method on direct parent class
     AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
 }
 
@@ -37,13 +37,25 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GLANDBASETRACKINGMODIFIER_HPP_
 
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include <boost/serialization/base_object.hpp>
 
 #include "AbstractCellBasedSimulationModifier.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 /**
  * A modifier class which at each simulation time step calculates the position of the lowest
- * cell in the gastric gland. This is stored in the GastricGlandBasePosition singleton.
+ * cell in the gastric gland. This is stored in the GlandContext attached to the population.
+ * It then classifies every cell into a GlandZone for the cell-cycle models to read.
+ *
+ * By default the population is updated before the base is found. As well as remeshing,
+ * this recomputes the Voronoi tessellation from the positions the step has just moved
+ * the nodes to. The simulation's next DoCellBirth() runs before its own population
+ * update, so IsRoomToDivide() reads cell areas from this tessellation. With
+ * SetUpdatePopulationEachStep(false) the modifier only scans the real nodes, and remeshes
+ * only when nodes are waiting to be removed. That skips a rebuild every step and finds
+ * the same base and zones. However, division decisions then use areas from before the
+ * last move, so a run can divide a step later than it would by default.
  */
 template<unsigned DIM>
 class GlandBaseTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
@@ -61,8 +73,38 @@ class GlandBaseTrackingModifier : public AbstractCellBasedSimulationModifier<DIM
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+
+        // Archives written before version 1 hold no choice; the constructor's value updates each step, as they did
+        if (version >= 1)
+        {
+            archive & mUpdatePopulationEachStep;
+        }
     }
 
+    /**
+     * Whether to update the population and scan all cells each step, rather than scan
+     * the real nodes and remesh only when nodes have been deleted. Defaults to true,
+     * which keeps the cell areas read at the next division current.
+     */
+    bool mUpdatePopulationEachStep;
+
+    /**
+     * Find the location of the lowest real node by a scan over the mesh. The population
+     * is only updated if its mesh has deleted nodes still to be removed.
+     *
+     * @param rPopulation the gastric gland population
+     * @return the location of the lowest real node
+     */
+    c_vector<double, 2> FindLowestRealNode(GastricGlandCellPopulation<2>& rPopulation);
+
+    /**
+     * Classify every node into a GlandZone in one sweep over the node heights, and pass
+     * each cell's zone and population to its GastricGlandCellCycleModelV2, if it has one.
+     *
+     * @param rPopulation the gastric gland population
+     */
+    void UpdateZones(GastricGlandCellPopulation<2>& rPopulation);
+
 public:
 
     /**
@@ -101,6 +143,20 @@ public:
      */
     void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
 
+    /**
+     * @return whether the population is updated every step before the base is found
+     */
+    bool GetUpdatePopulationEachStep() const;
+
+    /**
+     * Set whether to update the population every step before the base is found.
+     *
+     * @param updatePopulationEachStep whether to update the population and scan all cells,
+     *     rather than scan the real nodes and remesh only when nodes have been deleted,
+     *     leaving the cell areas a step old (see the class comment)
+     */
+    void SetUpdatePopulationEachStep(bool updatePopulationEachStep);
+
     /**
      * Overridden OutputSimulationModifierParameters() method.
      * Output any simulation modifier parameters to file.
@@ -110,6 +166,22 @@ public:
     void OutputSimulationModifierParameters(out_stream& rParamsFile);
 };
 
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Version 1 adds the choice of whether to update the population each step.
+ */
+template<unsigned DIM>
+struct version<GlandBaseTrackingModifier<DIM> >
+{
+    ///Macro to set the version number of templated archive in known versions of Boost
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
 #include "SerializationExportWrapper.hpp"
 EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandBaseTrackingModifier)
 
@@ -0,0 +1,124 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandForwardEulerNumericalMethod.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GlandForwardEulerNumericalMethod()
+    : ForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>(),
+      mNumThreads(1)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::~GlandForwardEulerNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    if (this->mUseUpdateNodeLocation || mNumThreads <= 1)
+    {
+        ForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateAllNodePositions(dt);
+        return;
+    }
+
+    std::vector<c_vector<double, SPACE_DIM> > forces = this->ComputeForcesIncludingDamping();
+
+    mNodes.clear();
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mNodes.push_back(&(*node_iter));
+    }
+    const unsigned num_nodes = mNodes.size();
+    mDisplacements.resize(num_nodes);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(mNumThreads)
+#endif
+    for (unsigned i=0; i<num_nodes; i++)
+    {
+        mDisplacements[i] = dt*forces[i];
+    }
+
+    // May warn or throw, so kept serial and in node order
+    for (unsigned i=0; i<num_nodes; i++)
+    {
+        this->DetectStepSizeExceptions(mNodes[i]->GetIndex(), mDisplacements[i], dt);
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(mNumThreads)
+#endif
+    for (unsigned i=0; i<num_nodes; i++)
+    {
+        c_vector<double, SPACE_DIM> new_location = mNodes[i]->rGetLocation() + mDisplacements[i];
+        this->SafeNodePositionUpdate(mNodes[i]->GetIndex(), new_location);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SetNumThreads(unsigned numThreads)
+{
+    mNumThreads = (numThreads == 0) ? 1 : numThreads;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    ForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class GlandForwardEulerNumericalMethod<1,1>;
+template class GlandForwardEulerNumericalMethod<1,2>;
+template class GlandForwardEulerNumericalMethod<2,2>;
+template class GlandForwardEulerNumericalMethod<1,3>;
+template class GlandForwardEulerNumericalMethod<2,3>;
+template class GlandForwardEulerNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(GlandForwardEulerNumericalMethod)
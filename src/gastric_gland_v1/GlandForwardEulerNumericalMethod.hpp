@@ -33,31 +33,30 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
-#ifndef GASTRICGLANDBASEPOSITION_HPP_
-#define GASTRICGLANDBASEPOSITION_HPP_
+#ifndef GLANDFORWARDEULERNUMERICALMETHOD_HPP_
+#define GLANDFORWARDEULERNUMERICALMETHOD_HPP_
 
 #include "ChasteSerialization.hpp"
-#include "SerializableSingleton.hpp"
 #include <boost/serialization/base_object.hpp>
 
-#include <iostream>
-
-#include "AbstractCellPopulation.hpp"
+#include "ForwardEulerNumericalMethod.hpp"
 
+#include <vector>
 
 /**
- *  Singleton Wnt concentration object.
+ * A forward Euler numerical method which can move nodes on several threads.
+ *
+ * Forces are computed as in ForwardEulerNumericalMethod. Displacements are then
+ * computed in parallel, checked for step size problems serially and in node order
+ * (so warnings and StepSizeExceptions behave as before), and applied in parallel.
+ * Each node is only written by one thread, so results do not depend on the number
+ * of threads. Without OpenMP, or with one thread, this behaves exactly like the base class.
  */
-template<unsigned DIM>
-class GastricGlandBasePosition : public SerializableSingleton<GastricGlandBasePosition<DIM> >
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class GlandForwardEulerNumericalMethod : public ForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM>
 {
 private:
 
-    /** Pointer to the singleton instance of WntConcentration */
-    static GastricGlandBasePosition* mpInstance;
-
-    c_vector<double, DIM> m_basePosition;
-
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -69,52 +68,58 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
+        archive & boost::serialization::base_object<ForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
     }
 
-protected:
+    /** Number of threads to use. Not archived, as it depends on the machine running the simulation. */
+    unsigned mNumThreads;
 
-    /**
-     * Protected constuctor. Not to be called, use Instance() instead.
-     */
-    GastricGlandBasePosition();
+    /** Scratch: the nodes of the mesh, in node iterator order. */
+    std::vector<Node<SPACE_DIM>*> mNodes;
+
+    /** Scratch: the displacement of each node in mNodes. */
+    std::vector<c_vector<double, SPACE_DIM> > mDisplacements;
 
 public:
 
     /**
-     * Return a pointer to the WntConcentration object.
-     * The first time this is called, the object is created.
-     *
-     * @return  A pointer to the singleton WntConcentration object.
+     * Constructor.
      */
-    static GastricGlandBasePosition* Instance();
+    GlandForwardEulerNumericalMethod();
 
     /**
-     * Destructor - frees up the singleton instance.
+     * Destructor.
      */
-    virtual ~GastricGlandBasePosition();
+    virtual ~GlandForwardEulerNumericalMethod();
 
     /**
-     * Destroy the current WntConcentration instance.
-     *  Should be called at the end of a simulation.
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt the time step
      */
-    static void Destroy();
+    virtual void UpdateAllNodePositions(double dt) override;
 
     /**
-     * Get the y-position of the lowest cell
-     *
-     * @return the y-location of the lowest cell
+     * @return the number of threads used to update node positions
      */
-    c_vector<double, DIM> GetBasePosition() const;
+    unsigned GetNumThreads() const;
 
     /**
-     * Set the base position recorded in the singleton
-     * 
-     * Used by GlandBaseTrackingModifier to store the location of the lowest cell at each timepoint
-     * 
-     * @param position y-location of the lowest cell
+     * Set the number of threads to use. Has no effect unless built with OpenMP.
+     *
+     * @param numThreads the number of threads (defaults to 1)
      */
-    void SetBasePosition(c_vector<double, DIM> position);
+    void SetNumThreads(unsigned numThreads);
 
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile) override;
 };
 
-#endif /*GASTRICGLANDBASEPOSITION_HPP_*/
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(GlandForwardEulerNumericalMethod)
+
+#endif /*GLANDFORWARDEULERNUMERICALMETHOD_HPP_*/
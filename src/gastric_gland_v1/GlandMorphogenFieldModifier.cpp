@@ -0,0 +1,217 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandMorphogenFieldModifier.hpp"
+#include "FoveolarCellProliferativeType.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+
+template<unsigned DIM>
+GlandMorphogenFieldModifier<DIM>::GlandMorphogenFieldModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mSignal(GLAND_SIGNAL_BMP),
+      mGridSpacing(1.0),
+      mGridTop(0.0)
+{
+}
+
+template<unsigned DIM>
+GlandMorphogenFieldModifier<DIM>::~GlandMorphogenFieldModifier()
+{
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(rCellPopulation), PROFILE_FIELDS);
+
+    GlandContext<DIM>* p_context = GastricGlandCellPopulation<DIM>::FindGlandContext(rCellPopulation);
+    if (p_context == nullptr)
+    {
+        EXCEPTION("GlandMorphogenFieldModifier is to be used with a GastricGlandCellPopulation only");
+    }
+    UpdateField(rCellPopulation, *p_context);
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    GlandContext<DIM>* p_context = GastricGlandCellPopulation<DIM>::FindGlandContext(rCellPopulation);
+    if (p_context == nullptr)
+    {
+        EXCEPTION("GlandMorphogenFieldModifier is to be used with a GastricGlandCellPopulation only");
+    }
+
+    // A resumed simulation keeps the grid and concentration it was archived with
+    GlandMorphogenField& r_field = p_context->rGetField(GetSignal());
+    bool is_resumed = r_field.IsSetUp();
+    if (!is_resumed)
+    {
+        ChasteCuboid<DIM> bounding_box = rCellPopulation.rGetMesh().CalculateBoundingBox();
+        double bottom = bounding_box.rGetLowerCorner()[DIM-1];
+        double top = std::max(bounding_box.rGetUpperCorner()[DIM-1], mGridTop);
+        r_field.SetUpGrid(rCellPopulation.rGetMesh().GetWidth(0), bottom, top, mGridSpacing);
+    }
+
+    // A resumed simulation carries on the profile it was writing
+    static const char* signal_names[NUM_GLAND_SIGNALS] = {"wnt", "bmp", "egf"};
+    OutputFileHandler output_file_handler(outputDirectory + "/", false);
+    std::string file_name = std::string(signal_names[mSignal]) + "_field.dat";
+    if (is_resumed)
+    {
+        mpProfileFile = output_file_handler.OpenOutputFile(file_name, std::ios::app);
+    }
+    else
+    {
+        mpProfileFile = output_file_handler.OpenOutputFile(file_name);
+        *mpProfileFile << "#";
+        for (unsigned row=0; row<r_field.GetNumY(); row++)
+        {
+            *mpProfileFile << "\t" << r_field.GetRowHeight(row);
+        }
+        *mpProfileFile << "\n";
+    }
+
+    SignalGradient<DIM>& r_signal = p_context->rGetSignal(GetSignal());
+    if (r_signal.GetType() != SG_FIELD)
+    {
+        r_signal.SetType(SG_FIELD);
+    }
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::UpdateField(AbstractCellPopulation<DIM,DIM>& rCellPopulation, GlandContext<DIM>& rContext)
+{
+    GlandMorphogenField& r_field = rContext.rGetField(GetSignal());
+
+    r_field.ClearSources();
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        if (cell_iter->GetCellProliferativeType()->template IsType<FoveolarCellProliferativeType>())
+        {
+            const c_vector<double, DIM> location = rCellPopulation.GetLocationOfCellCentre(*cell_iter);
+            r_field.AddSecretingCell(location[0], location[DIM-1]);
+        }
+    }
+
+    r_field.Advance(SimulationTime::Instance()->GetTimeStep());
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    GlandContext<DIM>* p_context = GastricGlandCellPopulation<DIM>::FindGlandContext(rCellPopulation);
+    assert(p_context != nullptr && mpProfileFile);
+    GlandMorphogenField& r_field = p_context->rGetField(GetSignal());
+
+    *mpProfileFile << SimulationTime::Instance()->GetTime();
+    for (unsigned row=0; row<r_field.GetNumY(); row++)
+    {
+        *mpProfileFile << "\t" << r_field.GetMeanAtHeight(r_field.GetRowHeight(row));
+    }
+    *mpProfileFile << "\n";
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpProfileFile)
+    {
+        mpProfileFile->close();
+        mpProfileFile.reset();
+    }
+}
+
+template<unsigned DIM>
+GlandSignal GlandMorphogenFieldModifier<DIM>::GetSignal() const
+{
+    return GlandSignal(mSignal);
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::SetSignal(GlandSignal signal)
+{
+    assert(signal < NUM_GLAND_SIGNALS);
+    mSignal = signal;
+}
+
+template<unsigned DIM>
+double GlandMorphogenFieldModifier<DIM>::GetGridSpacing() const
+{
+    return mGridSpacing;
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::SetGridSpacing(double gridSpacing)
+{
+    assert(gridSpacing > 0.0);
+    mGridSpacing = gridSpacing;
+}
+
+template<unsigned DIM>
+double GlandMorphogenFieldModifier<DIM>::GetGridTop() const
+{
+    return mGridTop;
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::SetGridTop(double gridTop)
+{
+    mGridTop = gridTop;
+}
+
+template<unsigned DIM>
+void GlandMorphogenFieldModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<Signal>" << mSignal << "</Signal>\n";
+    *rParamsFile << "\t\t\t<GridSpacing>" << mGridSpacing << "</GridSpacing>\n";
+    *rParamsFile << "\t\t\t<GridTop>" << mGridTop << "</GridTop>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class GlandMorphogenFieldModifier<1>;
+template class GlandMorphogenFieldModifier<2>;
+template class GlandMorphogenFieldModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandMorphogenFieldModifier)
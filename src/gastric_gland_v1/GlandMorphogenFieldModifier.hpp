@@ -0,0 +1,194 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDMORPHOGENFIELDMODIFIER_HPP_
+#define GLANDMORPHOGENFIELDMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "GastricGlandCellPopulation.hpp"
+
+/**
+ * A modifier class which drives one of the morphogen fields of the GlandContext. At the end
+ * of each time step every foveolar cell deposits a source at its centre and the field is
+ * advanced by the time step, on its own ADI steps. The matching signal is switched to
+ * SG_FIELD, so that the context samples the field at each node.
+ *
+ * No cell-cycle model or killer reads the signals yet, so the field is output only: at each
+ * output time the modifier appends a line to <signal>_field.dat in the output directory,
+ * holding the time and then the field's mean around the gland at each grid row, from the
+ * bottom. The first line, starting with '#', gives the height of each row.
+ *
+ * The field's diffusivity, decay rate, secretion rate and time step are set on the field
+ * itself, and are archived with the context.
+ */
+template<unsigned DIM>
+class GlandMorphogenFieldModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSignal;
+        archive & mGridSpacing;
+        archive & mGridTop;
+    }
+
+    /** The GlandSignal whose field is driven. Defaults to GLAND_SIGNAL_BMP. */
+    unsigned mSignal;
+
+    /** The largest grid spacing of the field. Defaults to 1. */
+    double mGridSpacing;
+
+    /** The lowest height the top row of the grid may have. Defaults to 0. */
+    double mGridTop;
+
+    /** The file to which the field's profile is written at each output time. Not archived. */
+    out_stream mpProfileFile;
+
+    /**
+     * Deposit a source at the centre of each foveolar cell and advance the field by one
+     * simulation time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rContext the context holding the field
+     */
+    void UpdateField(AbstractCellPopulation<DIM,DIM>& rCellPopulation, GlandContext<DIM>& rContext);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    GlandMorphogenFieldModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~GlandMorphogenFieldModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specify what to do in the simulation at the end of each time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Lay out the field's grid, if it has none yet, over the circumference of the mesh
+     * and from the lowest node to the higher of the highest node and the grid top. Then
+     * switch the signal to SG_FIELD, if it is not already.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Append the time and the field's mean at each grid row to the profile file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Close the profile file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the GlandSignal whose field is driven
+     */
+    GlandSignal GetSignal() const;
+
+    /**
+     * @param signal the GlandSignal whose field to drive
+     */
+    void SetSignal(GlandSignal signal);
+
+    /**
+     * @return the largest grid spacing of the field
+     */
+    double GetGridSpacing() const;
+
+    /**
+     * @param gridSpacing the largest grid spacing of the field
+     */
+    void SetGridSpacing(double gridSpacing);
+
+    /**
+     * @return the lowest height the top row of the grid may have
+     */
+    double GetGridTop() const;
+
+    /**
+     * @param gridTop the lowest height the top row of the grid may have, e.g. the sloughing height
+     */
+    void SetGridTop(double gridTop);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandMorphogenFieldModifier)
+
+#endif /*GLANDMORPHOGENFIELDMODIFIER_HPP_*/
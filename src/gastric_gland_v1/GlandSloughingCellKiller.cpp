@@ -32,58 +32,48 @@ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
-#include "GastricGlandBasePosition.hpp"
 
-/** Pointer to the single instance */
-template<unsigned DIM>
-GastricGlandBasePosition<DIM>* GastricGlandBasePosition<DIM>::mpInstance = nullptr;
+#include "GlandSloughingCellKiller.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
-template<unsigned DIM>
-GastricGlandBasePosition<DIM>* GastricGlandBasePosition<DIM>::Instance()
-{
-    if (mpInstance == nullptr)
-    {
-        mpInstance = new GastricGlandBasePosition;
-    }
-    return mpInstance;
-}
+template <unsigned DIM>
+GlandSloughingCellKiller<DIM>::GlandSloughingCellKiller(AbstractCellPopulation<DIM>* pCellPopulation, double sloughHeight) :
+    AbstractCellKiller<DIM>(pCellPopulation),
+    mSloughHeight(sloughHeight)
+{}
 
-template<unsigned DIM>
-GastricGlandBasePosition<DIM>::GastricGlandBasePosition()
-    : m_basePosition()
+template <unsigned DIM>
+double GlandSloughingCellKiller<DIM>::GetSloughHeight() const
 {
-    // Make sure there's only one instance - enforces correct serialization
-    assert(mpInstance == nullptr);
+    return mSloughHeight;
 }
 
-template<unsigned DIM>
-GastricGlandBasePosition<DIM>::~GastricGlandBasePosition()
+template <unsigned DIM>
+void GlandSloughingCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
-}
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(*this->mpCellPopulation), PROFILE_KILLERS);
 
-template<unsigned DIM>
-void GastricGlandBasePosition<DIM>::Destroy()
-{
-    if (mpInstance)
+    GlandCellIndex<DIM>& r_index = GastricGlandCellPopulation<DIM>::rFindCellIndex(*this->mpCellPopulation, mOwnCellIndex);
+    r_index.GetCellsAbove(mSloughHeight, mCandidates);
+
+    for (unsigned i=0; i<mCandidates.size(); i++)
     {
-        delete mpInstance;
-        mpInstance = nullptr;
+        if (!mCandidates[i]->IsDead())
+        {
+            mCandidates[i]->Kill();
+        }
     }
 }
 
-template<unsigned DIM>
-c_vector<double, DIM> GastricGlandBasePosition<DIM>::GetBasePosition() const
+template <unsigned DIM>
+void GlandSloughingCellKiller<DIM>::OutputCellKillerParameters(out_stream& rParamsFile)
 {
-    return m_basePosition;
-}
+    *rParamsFile << "\t\t\t<SloughHeight>" << mSloughHeight << "</SloughHeight>\n";
 
-template<unsigned DIM>
-void GastricGlandBasePosition<DIM>::SetBasePosition(c_vector<double, DIM> position)
-{
-    m_basePosition = position;
+    AbstractCellKiller<DIM>::OutputCellKillerParameters(rParamsFile);
 }
 
-// Explicit instantiation
-template class GastricGlandBasePosition<1>;
-template class GastricGlandBasePosition<2>;
-template class GastricGlandBasePosition<3>;
+template class GlandSloughingCellKiller<2u>;
+
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandSloughingCellKiller)
@@ -0,0 +1,152 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDSLOUGHINGCELLKILLER_HPP_
+#define GLANDSLOUGHINGCELLKILLER_HPP_
+
+#include "AbstractCellKiller.hpp"
+#include "GlandCellIndex.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+/**
+ * A cell killer that sloughs cells off the top of the gland: every cell higher than the
+ * slough height is killed. Equivalent to SloughingCellKiller without side sloughing, but
+ * visits only the highest height bands of the shared GlandCellIndex.
+ */
+template<unsigned DIM>
+class GlandSloughingCellKiller : public AbstractCellKiller<DIM>
+{
+private:
+
+    /** Height above which cells are sloughed. */
+    double mSloughHeight;
+
+    /** Index of cells used when the population has no gland context to share one. Not archived. */
+    GlandCellIndex<DIM> mOwnCellIndex;
+
+    /** Scratch: the cells above the slough height. */
+    std::vector<CellPtr> mCandidates;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellKiller<DIM> >(*this);
+    }
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param pCellPopulation pointer to the cell population
+     * @param sloughHeight height above which cells are sloughed
+     */
+    GlandSloughingCellKiller(AbstractCellPopulation<DIM>* pCellPopulation,
+                             double sloughHeight);
+
+    /**
+     * Destructor
+     */
+    virtual ~GlandSloughingCellKiller(){};
+
+    /**
+     * @return the height above which cells are sloughed
+     */
+    double GetSloughHeight() const;
+
+    /**
+     * Kills cells above the slough height.
+     */
+    virtual void CheckAndLabelCellsForApoptosisOrDeath();
+
+    /**
+     * Outputs cell killer parameters to file
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputCellKillerParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandSloughingCellKiller)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a GlandSloughingCellKiller.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const GlandSloughingCellKiller<DIM> * t, const unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* const p_gland = t->GetCellPopulation();
+    ar << p_gland;
+    double slough_height = t->GetSloughHeight();
+    ar << slough_height;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a GlandSloughingCellKiller.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, GlandSloughingCellKiller<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_gland;
+    ar >> p_gland;
+    double slough_height;
+    ar >> slough_height;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)GlandSloughingCellKiller<DIM>(p_gland, slough_height);
+}
+}
+} // namespace ...
+
+#endif /*GLANDSLOUGHINGCELLKILLER_HPP_*/
@@ -0,0 +1,287 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandSpringForce.hpp"
+#include "MeshBasedCellPopulation.hpp"
+#include "Cylindrical2dMesh.hpp"
+#include "GastricGlandCellPopulation.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+template<unsigned DIM>
+GlandSpringForce<DIM>::GlandSpringForce()
+    : GeneralisedLinearSpringForce<DIM>(),
+      mNumThreads(1)
+{
+}
+
+template<unsigned DIM>
+GlandSpringForce<DIM>::~GlandSpringForce()
+{
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    GlandProfileScope scope(GastricGlandCellPopulation<DIM>::FindProfiler(rCellPopulation), PROFILE_FORCES);
+
+    MeshBasedCellPopulation<DIM>* p_population = dynamic_cast<MeshBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (DIM != 2 || p_population == nullptr || this->GetUseCutOffLength())
+    {
+        GeneralisedLinearSpringForce<DIM>::AddForceContribution(rCellPopulation);
+        return;
+    }
+
+    // Springs across the periodic boundary of a cylindrical mesh are wrapped in the kernel
+    double width = 0.0;
+    if (Cylindrical2dMesh* p_mesh = dynamic_cast<Cylindrical2dMesh*>(&(p_population->rGetMesh())))
+    {
+        width = p_mesh->GetWidth(0);
+    }
+
+    GatherSprings(*p_population);
+    ComputeSpringForces(width);
+    RecomputeSpecialSprings(rCellPopulation);
+    ScatterSpringForces(*p_population);
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::GatherSprings(MeshBasedCellPopulation<DIM>& rCellPopulation)
+{
+    MutableMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+
+    mNodeX.resize(num_nodes);
+    mNodeY.resize(num_nodes);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(mNumThreads) if(mNumThreads > 1)
+#endif
+    for (unsigned index=0; index<num_nodes; index++)
+    {
+        const c_vector<double, DIM>& r_location = r_mesh.GetNode(index)->rGetLocation();
+        mNodeX[index] = r_location[0];
+        mNodeY[index] = r_location[1];
+    }
+
+    // Ghost nodes have no cell, and take no part in the springs
+    mNodeAge.assign(num_nodes, DBL_MAX);
+    mNodeApoptotic.assign(num_nodes, 0);
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        unsigned index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        mNodeAge[index] = cell_iter->GetAge();
+        mNodeApoptotic[index] = cell_iter->HasApoptosisBegun();
+    }
+
+    mSpringA.clear();
+    mSpringB.clear();
+    mSpringRestLength.clear();
+    for (typename MeshBasedCellPopulation<DIM>::SpringIterator spring_iterator = rCellPopulation.SpringsBegin();
+         spring_iterator != rCellPopulation.SpringsEnd();
+         ++spring_iterator)
+    {
+        unsigned node_a_index = spring_iterator.GetNodeA()->GetIndex();
+        unsigned node_b_index = spring_iterator.GetNodeB()->GetIndex();
+        mSpringA.push_back(node_a_index);
+        mSpringB.push_back(node_b_index);
+        mSpringRestLength.push_back(rCellPopulation.GetRestLength(node_a_index, node_b_index));
+    }
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::ComputeSpringForces(double width)
+{
+    const unsigned num_springs = mSpringA.size();
+    mSpringForceX.resize(num_springs);
+    mSpringForceY.resize(num_springs);
+
+    const double inverse_width = (width > 0.0) ? 1.0/width : 0.0;
+    const double stiffness = this->mMeinekeSpringStiffness;
+
+    const unsigned* p_a = mSpringA.data();
+    const unsigned* p_b = mSpringB.data();
+    const double* p_rest_length = mSpringRestLength.data();
+    const double* p_x = mNodeX.data();
+    const double* p_y = mNodeY.data();
+    double* p_force_x = mSpringForceX.data();
+    double* p_force_y = mSpringForceY.data();
+
+    /*
+     * Follows GeneralisedLinearSpringForce::CalculateForceBetweenNodes() operation for
+     * operation, so that results match it. The periodic wrap replaces the fmod and
+     * comparisons of Cylindrical2dMesh::GetVectorFromAtoB() by a rounding, which is
+     * equivalent for nodes less than one width apart. Springs are independent, so
+     * sharing them between threads does not change the results.
+     */
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(mNumThreads) if(mNumThreads > 1)
+#endif
+    for (unsigned k=0; k<num_springs; k++)
+    {
+        double dx = p_x[p_b[k]] - p_x[p_a[k]];
+        double dy = p_y[p_b[k]] - p_y[p_a[k]];
+        dx -= width*std::nearbyint(dx*inverse_width);
+
+        double distance = std::sqrt(dx*dx + dy*dy);
+        double overlap = distance - p_rest_length[k];
+
+        p_force_x[k] = (stiffness*(dx/distance))*overlap;
+        p_force_y[k] = (stiffness*(dy/distance))*overlap;
+    }
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::RecomputeSpecialSprings(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    const double growth_duration = this->mMeinekeSpringGrowthDuration;
+
+    for (unsigned k=0; k<mSpringA.size(); k++)
+    {
+        unsigned node_a_index = mSpringA[k];
+        unsigned node_b_index = mSpringB[k];
+
+        // The same tests that select the growing-spring and apoptosis branches of the base class
+        double age_a = mNodeAge[node_a_index];
+        bool is_young_pair = (age_a < growth_duration) && (age_a == mNodeAge[node_b_index]);
+        if (is_young_pair || mNodeApoptotic[node_a_index] || mNodeApoptotic[node_b_index])
+        {
+            c_vector<double, DIM> force = this->CalculateForceBetweenNodes(node_a_index, node_b_index, rCellPopulation);
+            mSpringForceX[k] = force[0];
+            mSpringForceY[k] = force[1];
+        }
+    }
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::ScatterSpringForces(MeshBasedCellPopulation<DIM>& rCellPopulation)
+{
+    MutableMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+
+    mNodeForceX.assign(num_nodes, 0.0);
+    mNodeForceY.assign(num_nodes, 0.0);
+
+    const unsigned num_springs = mSpringA.size();
+    if (mNumThreads <= 1)
+    {
+        // Accumulate in spring order, second node first, as AbstractTwoBodyInteractionForce does
+        for (unsigned k=0; k<num_springs; k++)
+        {
+            mNodeForceX[mSpringB[k]] += -1.0*mSpringForceX[k];
+            mNodeForceY[mSpringB[k]] += -1.0*mSpringForceY[k];
+            mNodeForceX[mSpringA[k]] += mSpringForceX[k];
+            mNodeForceY[mSpringA[k]] += mSpringForceY[k];
+        }
+    }
+    else
+    {
+        /*
+         * Each thread accumulates a fixed contiguous block of springs into its own buffer,
+         * so there are no races, and the buffers are summed in thread order. The result
+         * depends only on the number of threads, not on how they are scheduled.
+         */
+        const unsigned num_threads = mNumThreads;
+        mThreadNodeForces.assign(2*num_nodes*num_threads, 0.0);
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+#endif
+        for (unsigned thread=0; thread<num_threads; thread++)
+        {
+            double* p_forces = mThreadNodeForces.data() + 2*num_nodes*thread;
+            unsigned begin = (num_springs*thread)/num_threads;
+            unsigned end = (num_springs*(thread + 1))/num_threads;
+            for (unsigned k=begin; k<end; k++)
+            {
+                p_forces[2*mSpringB[k]] += -1.0*mSpringForceX[k];
+                p_forces[2*mSpringB[k] + 1] += -1.0*mSpringForceY[k];
+                p_forces[2*mSpringA[k]] += mSpringForceX[k];
+                p_forces[2*mSpringA[k] + 1] += mSpringForceY[k];
+            }
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(num_threads)
+#endif
+        for (unsigned index=0; index<num_nodes; index++)
+        {
+            for (unsigned thread=0; thread<num_threads; thread++)
+            {
+                const double* p_forces = mThreadNodeForces.data() + 2*num_nodes*thread;
+                mNodeForceX[index] += p_forces[2*index];
+                mNodeForceY[index] += p_forces[2*index + 1];
+            }
+        }
+    }
+
+    c_vector<double, DIM> force = zero_vector<double>(DIM);
+    for (unsigned index=0; index<num_nodes; index++)
+    {
+        force[0] = mNodeForceX[index];
+        force[1] = mNodeForceY[index];
+        r_mesh.GetNode(index)->AddAppliedForceContribution(force);
+    }
+}
+
+template<unsigned DIM>
+unsigned GlandSpringForce<DIM>::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::SetNumThreads(unsigned numThreads)
+{
+    mNumThreads = (numThreads == 0) ? 1 : numThreads;
+}
+
+template<unsigned DIM>
+void GlandSpringForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    GeneralisedLinearSpringForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class GlandSpringForce<1>;
+template class GlandSpringForce<2>;
+template class GlandSpringForce<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandSpringForce)
@@ -0,0 +1,198 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDSPRINGFORCE_HPP_
+#define GLANDSPRINGFORCE_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "GeneralisedLinearSpringForce.hpp"
+
+#include <vector>
+
+/**
+ * A linear spring force for 2D gastric gland populations, giving the same forces as
+ * GeneralisedLinearSpringForce with its default options.
+ *
+ * Rather than computing each spring through virtual calls and per-spring cell lookups,
+ * node locations, spring endpoints and rest lengths are gathered into flat arrays and
+ * all springs are computed in one loop which the compiler can vectorise. The periodic
+ * wrap of a Cylindrical2dMesh is applied without branching. Springs whose rest length
+ * depends on the cells themselves (newly divided pairs and apoptotic cells) are then
+ * recomputed by the scalar GeneralisedLinearSpringForce method. Forces are scattered to
+ * nodes in the same order as AbstractTwoBodyInteractionForce.
+ *
+ * Populations which are not mesh-based, other dimensions and cut-off lengths are
+ * handled by the base class.
+ *
+ * When built with OpenMP and given more than one thread, the spring loop is shared
+ * between threads, and each thread scatters a fixed block of springs into its own
+ * node force buffer. The buffers are then summed in thread order, so results are
+ * reproducible bit for bit for a given number of threads.
+ */
+template<unsigned DIM>
+class GlandSpringForce : public GeneralisedLinearSpringForce<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<GeneralisedLinearSpringForce<DIM> >(*this);
+    }
+
+    /** Scratch: x-coordinate of each node, indexed by node index. */
+    std::vector<double> mNodeX;
+
+    /** Scratch: y-coordinate of each node. */
+    std::vector<double> mNodeY;
+
+    /** Scratch: age of the cell at each node. */
+    std::vector<double> mNodeAge;
+
+    /** Scratch: whether the cell at each node has begun apoptosis. */
+    std::vector<unsigned char> mNodeApoptotic;
+
+    /** Scratch: first node of each spring, in spring iterator order. */
+    std::vector<unsigned> mSpringA;
+
+    /** Scratch: second node of each spring. */
+    std::vector<unsigned> mSpringB;
+
+    /** Scratch: rest length of each spring, as given by the population. */
+    std::vector<double> mSpringRestLength;
+
+    /** Scratch: x-component of the force on the first node of each spring. */
+    std::vector<double> mSpringForceX;
+
+    /** Scratch: y-component of the force on the first node of each spring. */
+    std::vector<double> mSpringForceY;
+
+    /** Scratch: accumulated x-component of the force on each node. */
+    std::vector<double> mNodeForceX;
+
+    /** Scratch: accumulated y-component of the force on each node. */
+    std::vector<double> mNodeForceY;
+
+    /** Scratch: per-thread node force buffers, x then y for each node, one block per thread. */
+    std::vector<double> mThreadNodeForces;
+
+    /** Number of threads to use. Not archived, as it depends on the machine running the simulation. */
+    unsigned mNumThreads;
+
+protected:
+
+    /**
+     * Gather node locations, cell state and springs from the population into flat arrays.
+     *
+     * @param rCellPopulation the mesh-based cell population
+     */
+    void GatherSprings(MeshBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Compute the force on the first node of every spring from the flat arrays,
+     * assuming the plain rest length from the population.
+     *
+     * @param width the periodic width of the mesh, or 0 if it is not periodic
+     */
+    void ComputeSpringForces(double width);
+
+    /**
+     * Recompute, with the scalar base class method, every spring which involves a pair of
+     * newly divided cells or an apoptotic cell.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void RecomputeSpecialSprings(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Add the spring forces to the nodes, in spring order.
+     *
+     * @param rCellPopulation the mesh-based cell population
+     */
+    void ScatterSpringForces(MeshBasedCellPopulation<DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    GlandSpringForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~GlandSpringForce();
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation) override;
+
+    /**
+     * @return the number of threads used to compute and scatter spring forces
+     */
+    unsigned GetNumThreads() const;
+
+    /**
+     * Set the number of threads to use. Has no effect unless built with OpenMP.
+     *
+     * @param numThreads the number of threads (defaults to 1)
+     */
+    void SetNumThreads(unsigned numThreads);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputForceParameters(out_stream& rParamsFile) override;
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GlandSpringForce)
+
+#endif /*GLANDSPRINGFORCE_HPP_*/
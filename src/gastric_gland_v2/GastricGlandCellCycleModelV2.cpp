@@ -47,25 +47,31 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ApcOneHitCellMutationState.hpp"
 #include "ApcTwoHitCellMutationState.hpp"
 #include "BetaCateninOneHitCellMutationState.hpp"
-#include "GastricGlandBasePosition.hpp"
+#include "GastricGlandCellPopulation.hpp"
 
 GastricGlandCellCycleModelV2::GastricGlandCellCycleModelV2() :
-  mIsthmusBeginHeight(28.0),
-  mIsthmusEndHeight(32.0),
-  mBaseHeight(3.0),
   mBaseG1Duration(200),
-  mIsthmusG1Duration(10)
+  mIsthmusG1Duration(10),
+  mZone(GLAND_ZONE_UNSET),
+  mEvaluatedZone(GLAND_ZONE_UNSET),
+  mEvaluatedBirthTime(DBL_MAX),
+  mEvaluatedG1Duration(DBL_MAX),
+  mNextPhaseAge(0.0),
+  mpGlandPopulation(nullptr)
 {
     SetTransitCellG1Duration(10.0);
 }
 
 GastricGlandCellCycleModelV2::GastricGlandCellCycleModelV2(const GastricGlandCellCycleModelV2& rModel)
    : AbstractSimplePhaseBasedCellCycleModel(rModel),
-   mIsthmusBeginHeight(rModel.mIsthmusBeginHeight),
-   mIsthmusEndHeight(rModel.mIsthmusEndHeight),
-   mBaseHeight(rModel.mBaseHeight),
    mBaseG1Duration(rModel.mBaseG1Duration),
-   mIsthmusG1Duration(rModel.mIsthmusG1Duration)
+   mIsthmusG1Duration(rModel.mIsthmusG1Duration),
+   mZone(GLAND_ZONE_UNSET),
+   mEvaluatedZone(GLAND_ZONE_UNSET),
+   mEvaluatedBirthTime(DBL_MAX),
+   mEvaluatedG1Duration(DBL_MAX),
+   mNextPhaseAge(0.0),
+   mpGlandPopulation(rModel.mpGlandPopulation)
 {
     /*
      * Initialize only those member variables defined in this class.
@@ -81,6 +87,10 @@ GastricGlandCellCycleModelV2::GastricGlandCellCycleModelV2(const GastricGlandCel
      * Note that mG1Duration and the cell's proliferative type are
      * (re)set as soon as InitialiseDaughterCell() is called on the
      * new cell-cycle model.
+     *
+     * The daughter's zone is left unset, so it is computed from the daughter's own
+     * location until the next zone classification pass, and its phase is evaluated afresh.
+     * It shares its parent's population.
      */
     SetTransitCellG1Duration(10.0);
 }
@@ -128,18 +138,26 @@ void GastricGlandCellCycleModelV2::SetG1Duration()
 void GastricGlandCellCycleModelV2::UpdateCellCyclePhase()
 {
     assert(mpCell != nullptr);
-    
+
+    // With the same zone, the last evaluation is a fixed point until the cell reaches the end
+    // of its phase, so most steps stop here; ReadyToDivide() still times divisions exactly
+    if (mZone != GLAND_ZONE_UNSET && mZone == mEvaluatedZone
+        && mBirthTime == mEvaluatedBirthTime && mG1Duration == mEvaluatedG1Duration
+        && GetAge() < mNextPhaseAge)
+    {
+        return;
+    }
+
     if (GetWntType() != LINEAR)
     {
         EXCEPTION("Gastric gland cell cycle model only allowed for LINEAR Wnt concentration.");
     }
-    double lowest_point = GastricGlandBasePosition<2>::Instance()->GetBasePosition()[1];
-    AbstractCellPopulation<2>& population = WntConcentration<2>::Instance()->rGetCellPopulation();
-    double y = population.GetNode(population.GetLocationIndexUsingCell(mpCell))->rGetLocation()[1];
+    CellCyclePhase previous_phase = mCurrentCellCyclePhase;
+    unsigned char zone = (mZone == GLAND_ZONE_UNSET) ? ComputeZone() : mZone;
+    boost::shared_ptr<AbstractCellProperty> p_previous_type = mpCell->GetCellProliferativeType();
 
     // Allow the cell to divide if in either Base or Isthmus region
-    // Use Wnt signal strength to determine position in gland
-    if (y < lowest_point + mBaseHeight)
+    if (zone == GLAND_ZONE_BASE)
     {
         // If in Base
         // Make transit cell
@@ -153,7 +171,7 @@ void GastricGlandCellCycleModelV2::UpdateCellCyclePhase()
             mG1Duration += GetAge(); // Put cell at start of G1 phase, otherwise aged cell will immediately divide
         }
     }
-    else if (y < mIsthmusBeginHeight)
+    else if (zone == GLAND_ZONE_NECK)
     {
         // If in Neck
         if (!mpCell->GetCellProliferativeType()->IsType<NeckCellProliferativeType>()
@@ -164,7 +182,7 @@ void GastricGlandCellCycleModelV2::UpdateCellCyclePhase()
             mpCell->SetCellProliferativeType(p_neck_type);
         }
     }
-    else if (y < mIsthmusEndHeight)
+    else if (zone == GLAND_ZONE_ISTHMUS)
     {
         // If in Isthmus
         // Make transit cell
@@ -187,33 +205,82 @@ void GastricGlandCellCycleModelV2::UpdateCellCyclePhase()
             boost::shared_ptr<AbstractCellProperty> p_neck_type =
                 mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<FoveolarCellProliferativeType>();
             mpCell->SetCellProliferativeType(p_neck_type);
+
+            // Let the foveolar cell killer schedule this cell's death
+            GlandContext<2>* p_context = GetGlandContext();
+            if (p_context)
+            {
+                p_context->RecordNewFoveolarCell(mpCell);
+            }
+        }
+    }
+
+    // The population rebuilds its rest lengths, which depend on cell types, only when told of a change
+    if (mpCell->GetCellProliferativeType() != p_previous_type)
+    {
+        GlandContext<2>* p_context = GetGlandContext();
+        if (p_context)
+        {
+            p_context->RecordCellTypeChange();
         }
     }
-    
 
     double time_since_birth = GetAge();
     assert(time_since_birth >= 0);
 
+    // Each phase ends at the age tested for it, so mNextPhaseAge repeats the same sums
     if (mpCell->GetCellProliferativeType()->IsSubType<DifferentiatedCellProliferativeType>())
     {
         mCurrentCellCyclePhase = G_ZERO_PHASE;
+        mNextPhaseAge = DBL_MAX;
     }
     else if (time_since_birth < GetMDuration())
     {
         mCurrentCellCyclePhase = M_PHASE;
+        mNextPhaseAge = GetMDuration();
     }
     else if (time_since_birth < GetMDuration() + mG1Duration)
     {
         mCurrentCellCyclePhase = G_ONE_PHASE;
+        mNextPhaseAge = GetMDuration() + mG1Duration;
     }
     else if (time_since_birth < GetMDuration() + mG1Duration + GetSDuration())
     {
         mCurrentCellCyclePhase = S_PHASE;
+        mNextPhaseAge = GetMDuration() + mG1Duration + GetSDuration();
     }
     else if (time_since_birth < GetMDuration() + mG1Duration + GetSDuration() + GetG2Duration())
     {
         mCurrentCellCyclePhase = G_TWO_PHASE;
+        mNextPhaseAge = GetMDuration() + mG1Duration + GetSDuration() + GetG2Duration();
     }
+    else
+    {
+        // Ready to divide; nothing changes until ResetForDivision() resets the birth time
+        mNextPhaseAge = DBL_MAX;
+    }
+
+    // The type changes above test the phase left by the previous call, so a call which
+    // changed the phase is not a fixed point and the next one must run in full too
+    mEvaluatedZone = (mCurrentCellCyclePhase == previous_phase) ? mZone : GLAND_ZONE_UNSET;
+    mEvaluatedBirthTime = mBirthTime;
+    mEvaluatedG1Duration = mG1Duration;
+}
+
+unsigned char GastricGlandCellCycleModelV2::ComputeZone() const
+{
+    if (mpGlandPopulation == nullptr)
+    {
+        EXCEPTION("Gastric gland cell cycle model has not been given its GastricGlandCellPopulation.");
+    }
+    double y = mpGlandPopulation->GetNode(mpGlandPopulation->GetLocationIndexUsingCell(mpCell))->rGetLocation()[1];
+
+    return mpGlandPopulation->rGetGlandContext().ClassifyZone(y);
+}
+
+GlandContext<2>* GastricGlandCellCycleModelV2::GetGlandContext() const
+{
+    return mpGlandPopulation ? GastricGlandCellPopulation<2>::FindGlandContext(*mpGlandPopulation) : nullptr;
 }
 
 void GastricGlandCellCycleModelV2::InitialiseDaughterCell()
@@ -226,21 +293,18 @@ bool GastricGlandCellCycleModelV2::CanCellTerminallyDifferentiate()
     return false;
 }
 
-double GastricGlandCellCycleModelV2::GetIsthmusBeginHeight() const { return mIsthmusBeginHeight; }
-void GastricGlandCellCycleModelV2::SetIsthmusBeginHeight(double height) { mIsthmusBeginHeight = height; }
-
-double GastricGlandCellCycleModelV2::GetIsthmusEndHeight() const { return mIsthmusEndHeight; }
-void GastricGlandCellCycleModelV2::SetIsthmusEndHeight(double height) { mIsthmusEndHeight = height; }
-
-double GastricGlandCellCycleModelV2::GetBaseHeight() const { return mBaseHeight; }
-void GastricGlandCellCycleModelV2::SetBaseHeight(double height) { mBaseHeight = height; }
-
 double GastricGlandCellCycleModelV2::GetBaseG1Duration() const { return mBaseG1Duration; }
 void GastricGlandCellCycleModelV2::SetBaseG1Duration(double duration) { mBaseG1Duration = duration; }
 
 double GastricGlandCellCycleModelV2::GetIsthmusG1Duration() const { return mIsthmusG1Duration; }
 void GastricGlandCellCycleModelV2::SetIsthmusG1Duration(double duration) { mIsthmusG1Duration = duration; }
 
+unsigned char GastricGlandCellCycleModelV2::GetZone() const { return mZone; }
+void GastricGlandCellCycleModelV2::SetZone(unsigned char zone) { mZone = zone; }
+
+GastricGlandCellPopulation<2>* GastricGlandCellCycleModelV2::GetGlandPopulation() const { return mpGlandPopulation; }
+void GastricGlandCellCycleModelV2::SetGlandPopulation(GastricGlandCellPopulation<2>* pPopulation) { mpGlandPopulation = pPopulation; }
+
 double GastricGlandCellCycleModelV2::GetWntLevel() const
 {
     assert(mpCell != nullptr);
@@ -308,9 +372,6 @@ WntConcentrationType GastricGlandCellCycleModelV2::GetWntType()
 
 void GastricGlandCellCycleModelV2::OutputCellCycleModelParameters(out_stream& rParamsFile)
 {
-    *rParamsFile << "\t\t\t<IsthmusBeginHeight>" << mIsthmusBeginHeight << "</IsthmusBeginHeight>\n";
-    *rParamsFile << "\t\t\t<IsthmusEndHeight>" << mIsthmusEndHeight << "</IsthmusEndHeight>\n";
-    *rParamsFile << "\t\t\t<BaseHeight>" << mBaseHeight << "</BaseHeight>\n";
     *rParamsFile << "\t\t\t<BaseG1Duration>" << mBaseG1Duration << "</BaseG1Duration>\n";
     *rParamsFile << "\t\t\t<IsthmusG1Duration>" << mIsthmusG1Duration << "</IsthmusG1Duration>\n";
 
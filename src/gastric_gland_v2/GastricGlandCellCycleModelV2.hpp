@@ -36,9 +36,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef GASTRICGLANDCELLCYCLEMODELV2_HPP
 #define GASTRICGLANDCELLCYCLEMODELV2_HPP
 
+#include "ChasteSerializationVersion.hpp"
 #include "AbstractSimplePhaseBasedCellCycleModel.hpp"
 #include "RandomNumberGenerator.hpp"
 #include "WntConcentration.hpp"
+#include "GlandContext.hpp"
+
+template<unsigned DIM> class GastricGlandCellPopulation;
 
 /**
  * Simple Wnt-dependent cell-cycle model.
@@ -60,6 +64,14 @@ private:
     {
         archive & boost::serialization::base_object<AbstractSimplePhaseBasedCellCycleModel>(*this);
 
+        // Archives written before version 1 hold none of these; the constructor's values stand
+        if (version >= 1)
+        {
+            archive & mBaseG1Duration;
+            archive & mIsthmusG1Duration;
+            archive & mZone;
+        }
+
         RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
         archive & *p_gen;
     }
@@ -71,12 +83,53 @@ protected:
      * For use in SetG1Duration().
      */
 
-    double mIsthmusBeginHeight;
-    double mIsthmusEndHeight;
-    double mBaseHeight;
     double mBaseG1Duration;
     double mIsthmusG1Duration;
 
+    /**
+     * The GlandZone this cell was last classified into by GlandBaseTrackingModifier.
+     * While it is GLAND_ZONE_UNSET the zone is computed from the cell's location.
+     */
+    unsigned char mZone;
+
+    /**
+     * The zone, birth time and G1 duration with which UpdateCellCyclePhase() last ran in
+     * full without changing the phase (GLAND_ZONE_UNSET if it did change it). While they
+     * are unchanged, UpdateCellCyclePhase() has nothing to do until the cell's age reaches
+     * mNextPhaseAge. Not archived, so a loaded model runs in full once.
+     */
+    unsigned char mEvaluatedZone;
+
+    /** The birth time with which UpdateCellCyclePhase() last ran in full. */
+    double mEvaluatedBirthTime;
+
+    /** The G1 duration with which UpdateCellCyclePhase() last ran in full. */
+    double mEvaluatedG1Duration;
+
+    /** The age at which the current cell-cycle phase ends. */
+    double mNextPhaseAge;
+
+    /**
+     * The population containing the cell, through which the model reaches the gland
+     * context. Set by GlandBaseTrackingModifier and copied to daughters. Not archived;
+     * the modifier sets it again in SetupSolve().
+     */
+    GastricGlandCellPopulation<2>* mpGlandPopulation;
+
+    /**
+     * Classify the cell's zone directly from its location, via the gland context.
+     * Only used until the cell has been assigned a zone by SetZone().
+     *
+     * @return the GlandZone containing the cell
+     */
+    unsigned char ComputeZone() const;
+
+    /**
+     * @return the context of the cell's population, or null if the model has not been
+     *     given a population or the population has no context
+     */
+    GlandContext<2>* GetGlandContext() const;
+
     /**
      * @return the Wnt level experienced by the cell.
      */
@@ -114,6 +167,9 @@ protected:
      */
     GastricGlandCellCycleModelV2(const GastricGlandCellCycleModelV2& rModel);
 
+    /** GlandCheckpoint saves and restores phase state which has no public setters. */
+    friend class GlandCheckpoint;
+
 public:
 
     /**
@@ -124,6 +180,10 @@ public:
 
     /**
      * Overridden UpdateCellCyclePhase() method.
+     *
+     * Runs in full only when the cell's zone has changed, it has reached the end of its
+     * current phase or the last call changed its phase, since otherwise the result would be
+     * the same as last time.
      */
     virtual void UpdateCellCyclePhase();
 
@@ -146,21 +206,37 @@ public:
      */
     virtual bool CanCellTerminallyDifferentiate();
 
-    double GetIsthmusBeginHeight() const;
-    void SetIsthmusBeginHeight(double height);
-
-    double GetIsthmusEndHeight() const;
-    void SetIsthmusEndHeight(double height);
-
-    double GetBaseHeight() const;
-    void SetBaseHeight(double height);
-
     double GetBaseG1Duration() const;
     void SetBaseG1Duration(double duration);
 
     double GetIsthmusG1Duration() const;
     void SetIsthmusG1Duration(double duration);
 
+    /**
+     * @return the GlandZone last assigned to this cell
+     */
+    unsigned char GetZone() const;
+
+    /**
+     * Set the GlandZone of this cell. Called once per step by GlandBaseTrackingModifier.
+     *
+     * @param zone the GlandZone containing the cell
+     */
+    void SetZone(unsigned char zone);
+
+    /**
+     * @return the population containing the cell, or null if it has not been set
+     */
+    GastricGlandCellPopulation<2>* GetGlandPopulation() const;
+
+    /**
+     * Set the population containing the cell. Called once per step by
+     * GlandBaseTrackingModifier; a model used without one must be given it directly.
+     *
+     * @param pPopulation the population
+     */
+    void SetGlandPopulation(GastricGlandCellPopulation<2>* pPopulation);
+
     /**
      * Overridden OutputCellCycleModelParameters() method.
      *
@@ -169,6 +245,22 @@ public:
     virtual void OutputCellCycleModelParameters(out_stream& rParamsFile);
 };
 
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Version 1 adds the base and isthmus G1 durations and the zone.
+ */
+template<>
+struct version<GastricGlandCellCycleModelV2>
+{
+    ///Macro to set the version number of templated archive in known versions of Boost
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
 #include "SerializationExportWrapper.hpp"
 // Declare identifier for the serializer
 CHASTE_CLASS_EXPORT(GastricGlandCellCycleModelV2)
@@ -0,0 +1,221 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AsyncGlandBinaryOutputWriter.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <utility>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::msTotalStallTime = 0.0;
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::AsyncGlandBinaryOutputWriter()
+    : GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>(),
+      mStopRequested(false),
+      mIsSampleOpen(false),
+      mStallTime(0.0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::~AsyncGlandBinaryOutputWriter()
+{
+    // Exceptions must not escape a destructor, so a failed write is only lost here
+    StopThread();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteQueuedSamples()
+{
+    std::ofstream file(mThreadPath.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!file.is_open())
+    {
+        mErrorMessage = "Could not open " + mThreadPath + " for appending";
+    }
+
+    while (true)
+    {
+        mCondition.wait(lock, [this]{ return mStopRequested || !mPendingSamples.empty(); });
+        if (mPendingSamples.empty())
+        {
+            break;
+        }
+
+        // The main thread only appends to the queue, so the front sample stays put while unlocked
+        const GlandOutputSample& r_sample = mPendingSamples.front();
+        if (mErrorMessage.empty())
+        {
+            lock.unlock();
+            r_sample.Write(file);
+            file.flush();
+            lock.lock();
+
+            if (!file)
+            {
+                mErrorMessage = "Error writing to " + mThreadPath;
+            }
+        }
+
+        mFreeSamples.push_back(std::move(mPendingSamples.front()));
+        mPendingSamples.pop_front();
+        mCondition.notify_all();
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::StopThread()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopRequested = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+        mStopRequested = false;
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteSample()
+{
+    this->mSample.time = SimulationTime::Instance()->GetTime();
+
+    // A new output directory needs a new thread, writing to the new file
+    if (mThread.joinable() && mThreadPath != mPath)
+    {
+        StopThread();
+    }
+    if (!mThread.joinable())
+    {
+        mThreadPath = mPath;
+        mThread = std::thread(&AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteQueuedSamples, this);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mPendingSamples.size() >= MAX_PENDING_SAMPLES)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        mCondition.wait(lock, [this]{ return mPendingSamples.size() < MAX_PENDING_SAMPLES; });
+        double stall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mStallTime += stall;
+        msTotalStallTime += stall;
+    }
+    if (!mErrorMessage.empty())
+    {
+        EXCEPTION(mErrorMessage);
+    }
+
+    // Hand over the filled sample, and reuse the storage of one already written
+    mPendingSamples.push_back(GlandOutputSample());
+    std::swap(mPendingSamples.back(), this->mSample);
+    if (!mFreeSamples.empty())
+    {
+        std::swap(this->mSample, mFreeSamples.back());
+        mFreeSamples.pop_back();
+    }
+    lock.unlock();
+    mCondition.notify_all();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::OpenOutputFileForAppend(OutputFileHandler& rOutputFileHandler)
+{
+    mPath = rOutputFileHandler.GetOutputDirectoryFullPath() + this->mFileName;
+    mIsSampleOpen = true;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::CloseFile()
+{
+    if (mIsSampleOpen)
+    {
+        mIsSampleOpen = false;
+        return;
+    }
+
+    Flush();
+
+    // The header is still written through the base class stream
+    if (this->mpOutStream && this->mpOutStream->is_open())
+    {
+        GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::CloseFile();
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Flush()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]{ return mPendingSamples.empty(); });
+    if (!mErrorMessage.empty())
+    {
+        std::string message = mErrorMessage;
+        mErrorMessage.clear();
+        EXCEPTION(message);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::GetStallTime() const
+{
+    return mStallTime;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AsyncGlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::GetTotalStallTime()
+{
+    return msTotalStallTime;
+}
+
+// Explicit instantiation
+template class AsyncGlandBinaryOutputWriter<1,1>;
+template class AsyncGlandBinaryOutputWriter<1,2>;
+template class AsyncGlandBinaryOutputWriter<2,2>;
+template class AsyncGlandBinaryOutputWriter<1,3>;
+template class AsyncGlandBinaryOutputWriter<2,3>;
+template class AsyncGlandBinaryOutputWriter<3,3>;
+
+#include "SerializationExportWrapperForCpp.hpp"
+// Declare identifier for the serializer
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(AsyncGlandBinaryOutputWriter)
@@ -0,0 +1,182 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ASYNCGLANDBINARYOUTPUTWRITER_HPP_
+#define ASYNCGLANDBINARYOUTPUTWRITER_HPP_
+
+#include "GlandBinaryOutputWriter.hpp"
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A GlandBinaryOutputWriter which hands each sample to a background thread for writing,
+ * so that the solve loop only pays for copying the per-cell data.
+ *
+ * At most two samples may be queued; if the simulation produces samples faster than
+ * they can be written, WriteSample() blocks until a slot frees up and the time spent
+ * waiting is added to the stall time. The queue is drained when the writers' files
+ * are closed at the end of a solve and when the writer is destroyed.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class AsyncGlandBinaryOutputWriter : public GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * The background thread and its queue are not archived.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM> >(*this);
+    }
+
+    /** The maximum number of samples waiting for, or being written by, the background thread. */
+    static const unsigned MAX_PENDING_SAMPLES = 2;
+
+    /** The background writer thread, started on the first sample. */
+    std::thread mThread;
+
+    /** Protects everything below that is shared with the background thread. */
+    std::mutex mMutex;
+
+    /** Signalled whenever a sample is queued or written, or the thread is asked to stop. */
+    std::condition_variable mCondition;
+
+    /** Samples waiting to be written; the front one is being written. */
+    std::deque<GlandOutputSample> mPendingSamples;
+
+    /** Written samples, kept so that their storage can be reused. */
+    std::vector<GlandOutputSample> mFreeSamples;
+
+    /** Whether the background thread has been asked to stop once the queue is empty. */
+    bool mStopRequested;
+
+    /** Message from a failed write in the background thread, rethrown on the main thread. */
+    std::string mErrorMessage;
+
+    /** Full path of the output file, recorded when Chaste opens it for a sample. */
+    std::string mPath;
+
+    /** The path the running background thread writes to. */
+    std::string mThreadPath;
+
+    /** Whether Chaste has opened the file for the current sample and not yet closed it. */
+    bool mIsSampleOpen;
+
+    /** Wall-clock seconds this writer has spent blocked waiting for the background thread. */
+    double mStallTime;
+
+    /** Wall-clock seconds all writers of this type in the process have spent blocked. */
+    static double msTotalStallTime;
+
+    /**
+     * The body of the background thread: write queued samples to mThreadPath until stopped.
+     */
+    void WriteQueuedSamples();
+
+    /**
+     * Wait for the queue to empty, then stop and join the background thread if it is running.
+     */
+    void StopThread();
+
+protected:
+
+    /**
+     * Overridden WriteSample() method. Queues mSample for the background thread, and
+     * takes a previously written sample's storage in exchange.
+     */
+    virtual void WriteSample() override;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    AsyncGlandBinaryOutputWriter();
+
+    /**
+     * Destructor. Writes any queued samples before returning.
+     */
+    virtual ~AsyncGlandBinaryOutputWriter();
+
+    /**
+     * Overridden OpenOutputFileForAppend() method. Samples are appended by the background
+     * thread, so this only records the file's path.
+     *
+     * @param rOutputFileHandler handler for the directory in which to open this file
+     */
+    virtual void OpenOutputFileForAppend(OutputFileHandler& rOutputFileHandler) override;
+
+    /**
+     * Overridden CloseFile() method. Closing the file after a sample does nothing; any
+     * other close, such as at the end of a solve, first waits for queued samples to be written.
+     */
+    virtual void CloseFile() override;
+
+    /**
+     * Block until every queued sample has been written.
+     */
+    void Flush();
+
+    /**
+     * @return the wall-clock time, in seconds, this writer has spent waiting on output
+     */
+    double GetStallTime() const;
+
+    /**
+     * @return the wall-clock time, in seconds, all writers of this type have spent waiting on output
+     */
+    static double GetTotalStallTime();
+};
+
+#include "SerializationExportWrapper.hpp"
+// Declare identifier for the serializer
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(AsyncGlandBinaryOutputWriter)
+
+#endif /*ASYNCGLANDBINARYOUTPUTWRITER_HPP_*/
@@ -0,0 +1,118 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandBinaryOutputReader.hpp"
+#include "Exception.hpp"
+
+#include <cstring>
+
+GlandBinaryOutputReader::GlandBinaryOutputReader(const std::string& rPath)
+    : mFile(rPath.c_str(), std::ios::in | std::ios::binary),
+      mPath(rPath),
+      mVersion(0),
+      mDimension(0)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Could not open gland output file " + rPath);
+    }
+
+    char magic[8];
+    uint32_t version;
+    uint32_t dimension;
+    mFile.read(magic, sizeof(magic));
+    mFile.read(reinterpret_cast<char*>(&version), sizeof(version));
+    mFile.read(reinterpret_cast<char*>(&dimension), sizeof(dimension));
+    if (!mFile || std::memcmp(magic, GLAND_OUTPUT_FILE_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION(rPath + " is not a gland output file");
+    }
+    if (version > GLAND_OUTPUT_FORMAT_VERSION)
+    {
+        EXCEPTION(rPath + " was written by a newer version of GlandBinaryOutputWriter");
+    }
+    mVersion = version;
+    mDimension = dimension;
+}
+
+unsigned GlandBinaryOutputReader::GetVersion() const
+{
+    return mVersion;
+}
+
+unsigned GlandBinaryOutputReader::GetDimension() const
+{
+    return mDimension;
+}
+
+template<typename T>
+void GlandBinaryOutputReader::ReadColumn(std::vector<T>& rColumn, unsigned numEntries)
+{
+    rColumn.resize(numEntries);
+    mFile.read(reinterpret_cast<char*>(rColumn.data()), numEntries*sizeof(T));
+}
+
+bool GlandBinaryOutputReader::ReadNextSample(GlandOutputSample& rSample)
+{
+    char magic[4];
+    mFile.read(magic, sizeof(magic));
+    if (mFile.gcount() == 0 && mFile.eof())
+    {
+        return false;
+    }
+
+    uint32_t num_cells;
+    mFile.read(reinterpret_cast<char*>(&rSample.time), sizeof(rSample.time));
+    mFile.read(reinterpret_cast<char*>(&num_cells), sizeof(num_cells));
+    if (!mFile || std::memcmp(magic, GLAND_OUTPUT_SAMPLE_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION("Corrupt sample header in gland output file " + mPath);
+    }
+
+    ReadColumn(rSample.cellIds, num_cells);
+    ReadColumn(rSample.locationIndices, num_cells);
+    ReadColumn(rSample.x, num_cells);
+    ReadColumn(rSample.y, num_cells);
+    ReadColumn(rSample.volumes, num_cells);
+    ReadColumn(rSample.ancestors, num_cells);
+    ReadColumn(rSample.ages, num_cells);
+    ReadColumn(rSample.types, num_cells);
+    ReadColumn(rSample.zones, num_cells);
+    if (!mFile)
+    {
+        EXCEPTION("Truncated sample in gland output file " + mPath);
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDBINARYOUTPUTREADER_HPP_
+#define GLANDBINARYOUTPUTREADER_HPP_
+
+#include <fstream>
+#include <string>
+
+#include "GlandOutputSample.hpp"
+
+/**
+ * Reads the samples of a gland binary output file written by GlandBinaryOutputWriter,
+ * one chunk at a time.
+ */
+class GlandBinaryOutputReader
+{
+private:
+
+    /** The file being read. */
+    std::ifstream mFile;
+
+    /** The path of the file being read, for error messages. */
+    std::string mPath;
+
+    /** The format version recorded in the file header. */
+    unsigned mVersion;
+
+    /** The spatial dimension recorded in the file header. */
+    unsigned mDimension;
+
+    /**
+     * Read a column of n entries from the file.
+     *
+     * @param rColumn the column to fill
+     * @param numEntries the number of entries to read
+     */
+    template<typename T>
+    void ReadColumn(std::vector<T>& rColumn, unsigned numEntries);
+
+public:
+
+    /**
+     * Constructor. Opens the file and checks its header; throws if it is not a gland output file.
+     *
+     * @param rPath path to a results.glandbin file
+     */
+    GlandBinaryOutputReader(const std::string& rPath);
+
+    /**
+     * @return the format version of the file
+     */
+    unsigned GetVersion() const;
+
+    /**
+     * @return the spatial dimension of the simulation that wrote the file
+     */
+    unsigned GetDimension() const;
+
+    /**
+     * Read the next sample.
+     *
+     * @param rSample filled with the next sample
+     * @return false if the end of the file has been reached
+     */
+    bool ReadNextSample(GlandOutputSample& rSample);
+};
+
+#endif /*GLANDBINARYOUTPUTREADER_HPP_*/
@@ -0,0 +1,174 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GlandBinaryOutputWriter.hpp"
+#include "AbstractCellPopulation.hpp"
+#include "MeshBasedCellPopulation.hpp"
+#include "CaBasedCellPopulation.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "PottsBasedCellPopulation.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimulationTime.hpp"
+#include "GlandContext.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
+
+#include <cstring>
+#include <limits>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::GlandBinaryOutputWriter()
+    : AbstractCellPopulationWriter<ELEMENT_DIM, SPACE_DIM>("results.glandbin")
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteHeader(AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    uint32_t version = GLAND_OUTPUT_FORMAT_VERSION;
+    uint32_t dimension = SPACE_DIM;
+    this->mpOutStream->write(GLAND_OUTPUT_FILE_MAGIC, std::strlen(GLAND_OUTPUT_FILE_MAGIC));
+    this->mpOutStream->write(reinterpret_cast<const char*>(&version), sizeof(version));
+    this->mpOutStream->write(reinterpret_cast<const char*>(&dimension), sizeof(dimension));
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteTimeStamp()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteNewline()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+template<class POPULATION>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::AddCell(CellPtr pCell, POPULATION* pCellPopulation, bool hasVolumes)
+{
+    c_vector<double, SPACE_DIM> centre = pCellPopulation->GetLocationOfCellCentre(pCell);
+
+    mSample.cellIds.push_back(pCell->GetCellId());
+    mSample.locationIndices.push_back(pCellPopulation->GetLocationIndexUsingCell(pCell));
+    mSample.x.push_back(centre[0]);
+    mSample.y.push_back(SPACE_DIM > 1 ? centre[1] : 0.0);
+    mSample.volumes.push_back(hasVolumes ? pCellPopulation->GetVolumeOfCell(pCell) : std::numeric_limits<double>::quiet_NaN());
+    mSample.ancestors.push_back(pCell->GetAncestor());
+    mSample.ages.push_back(pCell->GetAge());
+    mSample.types.push_back(pCell->GetCellProliferativeType()->GetColour());
+
+    GastricGlandCellCycleModelV2* p_model = dynamic_cast<GastricGlandCellCycleModelV2*>(pCell->GetCellCycleModel());
+    mSample.zones.push_back(p_model ? p_model->GetZone() : static_cast<unsigned char>(GLAND_ZONE_UNSET));
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+template<class POPULATION>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::GatherCells(POPULATION* pCellPopulation)
+{
+    mSample.Clear();
+    for (typename POPULATION::Iterator cell_iter = pCellPopulation->Begin();
+         cell_iter != pCellPopulation->End();
+         ++cell_iter)
+    {
+        AddCell(*cell_iter, pCellPopulation, true);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::WriteSample()
+{
+    mSample.time = SimulationTime::Instance()->GetTime();
+    mSample.Write(*(this->mpOutStream));
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Visit(MeshBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    // Cell volumes come from the Voronoi tessellation, which is only built when something needs it
+    bool has_volumes = (pCellPopulation->GetVoronoiTessellation() != nullptr);
+
+    // Iterate over nodes, skipping ghost nodes, in the same order as the text cell writers
+    mSample.Clear();
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = pCellPopulation->rGetMesh().GetNodeIteratorBegin();
+         node_iter != pCellPopulation->rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        unsigned index = node_iter->GetIndex();
+        if (pCellPopulation->IsCellAttachedToLocationIndex(index))
+        {
+            AddCell(pCellPopulation->GetCellUsingLocationIndex(index), pCellPopulation, has_volumes);
+        }
+    }
+    WriteSample();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Visit(CaBasedCellPopulation<SPACE_DIM>* pCellPopulation)
+{
+    GatherCells(pCellPopulation);
+    WriteSample();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Visit(NodeBasedCellPopulation<SPACE_DIM>* pCellPopulation)
+{
+    GatherCells(pCellPopulation);
+    WriteSample();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Visit(PottsBasedCellPopulation<SPACE_DIM>* pCellPopulation)
+{
+    GatherCells(pCellPopulation);
+    WriteSample();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void GlandBinaryOutputWriter<ELEMENT_DIM, SPACE_DIM>::Visit(VertexBasedCellPopulation<SPACE_DIM>* pCellPopulation)
+{
+    GatherCells(pCellPopulation);
+    WriteSample();
+}
+
+// Explicit instantiation
+template class GlandBinaryOutputWriter<1,1>;
+template class GlandBinaryOutputWriter<1,2>;
+template class GlandBinaryOutputWriter<2,2>;
+template class GlandBinaryOutputWriter<1,3>;
+template class GlandBinaryOutputWriter<2,3>;
+template class GlandBinaryOutputWriter<3,3>;
+
+#include "SerializationExportWrapperForCpp.hpp"
+// Declare identifier for the serializer
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(GlandBinaryOutputWriter)
@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDBINARYOUTPUTWRITER_HPP_
+#define GLANDBINARYOUTPUTWRITER_HPP_
+
+#include "AbstractCellPopulationWriter.hpp"
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "GlandOutputSample.hpp"
+
+/**
+ * A population writer which records, at each sampling time, the id, location index,
+ * centre, volume, ancestor, age, proliferative type and gland zone of every cell in
+ * one binary, columnar file (results.glandbin). See GlandOutputSample.hpp for the
+ * layout, GlandBinaryOutputReader to read it, and the gastric_gland_convert_output
+ * app to convert it to the text files of CellVolumesWriter, CellAgesWriter and
+ * CellAncestorWriter.
+ *
+ * Cells are written in the same order as the text cell writers use.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class GlandBinaryOutputWriter : public AbstractCellPopulationWriter<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellPopulationWriter<ELEMENT_DIM, SPACE_DIM> >(*this);
+    }
+
+protected:
+
+    /** Staging area for the sample being written. */
+    GlandOutputSample mSample;
+
+    /**
+     * Append one cell to mSample.
+     *
+     * @param pCell the cell
+     * @param pCellPopulation the population, used for locations and volumes
+     * @param hasVolumes whether cell volumes can be computed
+     */
+    template<class POPULATION>
+    void AddCell(CellPtr pCell, POPULATION* pCellPopulation, bool hasVolumes);
+
+    /**
+     * Fill mSample from every cell in the population, in population order.
+     *
+     * @param pCellPopulation the population
+     */
+    template<class POPULATION>
+    void GatherCells(POPULATION* pCellPopulation);
+
+    /**
+     * Write mSample to the output file as one chunk.
+     */
+    virtual void WriteSample();
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    GlandBinaryOutputWriter();
+
+    /**
+     * Overridden WriteHeader() method, which writes the file header.
+     *
+     * @param pCellPopulation the population being written
+     */
+    virtual void WriteHeader(AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation) override;
+
+    /**
+     * Overridden WriteTimeStamp() method. The time is part of each chunk, so nothing is written here.
+     */
+    virtual void WriteTimeStamp() override;
+
+    /**
+     * Overridden WriteNewline() method. Chunks are not newline terminated, so nothing is written here.
+     */
+    virtual void WriteNewline() override;
+
+    /**
+     * Visit a MeshBasedCellPopulation, writing its real cells in node order.
+     *
+     * @param pCellPopulation a pointer to the MeshBasedCellPopulation to visit
+     */
+    virtual void Visit(MeshBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation) override;
+
+    /**
+     * Visit a CaBasedCellPopulation.
+     *
+     * @param pCellPopulation a pointer to the CaBasedCellPopulation to visit
+     */
+    virtual void Visit(CaBasedCellPopulation<SPACE_DIM>* pCellPopulation) override;
+
+    /**
+     * Visit a NodeBasedCellPopulation.
+     *
+     * @param pCellPopulation a pointer to the NodeBasedCellPopulation to visit
+     */
+    virtual void Visit(NodeBasedCellPopulation<SPACE_DIM>* pCellPopulation) override;
+
+    /**
+     * Visit a PottsBasedCellPopulation.
+     *
+     * @param pCellPopulation a pointer to the PottsBasedCellPopulation to visit
+     */
+    virtual void Visit(PottsBasedCellPopulation<SPACE_DIM>* pCellPopulation) override;
+
+    /**
+     * Visit a VertexBasedCellPopulation.
+     *
+     * @param pCellPopulation a pointer to the VertexBasedCellPopulation to visit
+     */
+    virtual void Visit(VertexBasedCellPopulation<SPACE_DIM>* pCellPopulation) override;
+};
+
+#include "SerializationExportWrapper.hpp"
+// Declare identifier for the serializer
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(GlandBinaryOutputWriter)
+
+#endif /*GLANDBINARYOUTPUTWRITER_HPP_*/
@@ -0,0 +1,147 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GLANDOUTPUTSAMPLE_HPP_
+#define GLANDOUTPUTSAMPLE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+/*
+ * Layout of a gland binary output file (results.glandbin), in native byte order:
+ *
+ *   header: "GLANDOUT" (8 bytes), uint32 format version, uint32 spatial dimension
+ *   then one chunk per sampling time:
+ *     "SMPL" (4 bytes), double time, uint32 number of cells n,
+ *     then the columns of GlandOutputSample in declaration order, n entries each.
+ *
+ * Columns are stored contiguously so that readers can load only the ones they need.
+ */
+
+/** Magic bytes at the start of a gland binary output file. */
+#define GLAND_OUTPUT_FILE_MAGIC "GLANDOUT"
+
+/** Magic bytes at the start of each sample chunk. */
+#define GLAND_OUTPUT_SAMPLE_MAGIC "SMPL"
+
+/** Current version of the gland binary output format. */
+#define GLAND_OUTPUT_FORMAT_VERSION 1u
+
+/**
+ * The per-cell data written at one sampling time, one entry per cell in each column.
+ */
+struct GlandOutputSample
+{
+    /** Simulation time of the sample. */
+    double time;
+
+    /** Cell id. */
+    std::vector<uint32_t> cellIds;
+
+    /** Location index of each cell. */
+    std::vector<uint32_t> locationIndices;
+
+    /** x-coordinate of each cell centre. */
+    std::vector<double> x;
+
+    /** y-coordinate of each cell centre. */
+    std::vector<double> y;
+
+    /** Volume (area in 2D) of each cell; NaN if no tessellation was available. */
+    std::vector<double> volumes;
+
+    /** Ancestor of each cell, or UINT32_MAX if unset. */
+    std::vector<uint32_t> ancestors;
+
+    /** Age of each cell. */
+    std::vector<double> ages;
+
+    /** Colour code of each cell's proliferative type. */
+    std::vector<uint8_t> types;
+
+    /** GlandZone of each cell, or GLAND_ZONE_UNSET. */
+    std::vector<uint8_t> zones;
+
+    /**
+     * Empty every column.
+     */
+    void Clear()
+    {
+        cellIds.clear();
+        locationIndices.clear();
+        x.clear();
+        y.clear();
+        volumes.clear();
+        ancestors.clear();
+        ages.clear();
+        types.clear();
+        zones.clear();
+    }
+
+    /**
+     * @return the number of cells in the sample
+     */
+    unsigned GetNumCells() const
+    {
+        return cellIds.size();
+    }
+
+    /**
+     * Write the sample to a stream as one chunk.
+     *
+     * @param rStream the stream, positioned after the file header or the previous chunk
+     */
+    void Write(std::ostream& rStream) const
+    {
+        uint32_t num_cells = GetNumCells();
+        rStream.write(GLAND_OUTPUT_SAMPLE_MAGIC, std::strlen(GLAND_OUTPUT_SAMPLE_MAGIC));
+        rStream.write(reinterpret_cast<const char*>(&time), sizeof(time));
+        rStream.write(reinterpret_cast<const char*>(&num_cells), sizeof(num_cells));
+
+        rStream.write(reinterpret_cast<const char*>(cellIds.data()), num_cells*sizeof(uint32_t));
+        rStream.write(reinterpret_cast<const char*>(locationIndices.data()), num_cells*sizeof(uint32_t));
+        rStream.write(reinterpret_cast<const char*>(x.data()), num_cells*sizeof(double));
+        rStream.write(reinterpret_cast<const char*>(y.data()), num_cells*sizeof(double));
+        rStream.write(reinterpret_cast<const char*>(volumes.data()), num_cells*sizeof(double));
+        rStream.write(reinterpret_cast<const char*>(ancestors.data()), num_cells*sizeof(uint32_t));
+        rStream.write(reinterpret_cast<const char*>(ages.data()), num_cells*sizeof(double));
+        rStream.write(reinterpret_cast<const char*>(types.data()), num_cells*sizeof(uint8_t));
+        rStream.write(reinterpret_cast<const char*>(zones.data()), num_cells*sizeof(uint8_t));
+    }
+};
+
+#endif /*GLANDOUTPUTSAMPLE_HPP_*/
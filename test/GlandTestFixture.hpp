@@ -0,0 +1,141 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef GLANDTESTFIXTURE_HPP_
+#define GLANDTESTFIXTURE_HPP_
+
+#include "SmartPointers.hpp"
+
+#include <vector>
+
+#include "CylindricalHoneycombMeshGenerator.hpp"
+#include "GastricGlandCellsGenerator.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "GastricGlandSimulation.hpp"
+#include "GlandContext.hpp"
+#include "WntConcentration.hpp"
+
+/**
+ * A small gland shared by the test suites: a cylindrical honeycomb mesh six cells across
+ * with two layers of ghost nodes, GastricGlandCellCycleModelV2 cells with random birth
+ * times, a GastricGlandCellPopulation with its own GlandContext, and a LINEAR Wnt
+ * concentration over the height of the gland.
+ *
+ * The constructor seeds the simulation singletons, as GastricGlandSimulation::setUp()
+ * does, and the destructor destroys them once the population has gone.
+ */
+class GlandTestFixture
+{
+private:
+
+    /** Sets up and tears down the singletons. */
+    GastricGlandSimulation mDriver;
+
+    /** Generates the mesh, and owns it. */
+    CylindricalHoneycombMeshGenerator mGenerator;
+
+    /** The population. */
+    boost::shared_ptr<GastricGlandCellPopulation<2> > mpPopulation;
+
+    /** The context attached to the population. */
+    boost::shared_ptr<GlandContext<2> > mpContext;
+
+public:
+
+    /**
+     * Build the gland.
+     *
+     * @param numCellsHigh the number of rows of cells, which is also the Wnt crypt length
+     * @param seed the seed for the random number generator, which sets the birth times
+     */
+    GlandTestFixture(unsigned numCellsHigh, unsigned seed)
+        : mGenerator(6, numCellsHigh, 2),
+          mpContext(new GlandContext<2>)
+    {
+        mDriver.setUp(seed);
+
+        Cylindrical2dMesh* p_mesh = mGenerator.GetCylindricalMesh();
+        std::vector<unsigned> location_indices = mGenerator.GetCellLocationIndices();
+
+        std::vector<CellPtr> cells;
+        GastricGlandCellsGenerator<GastricGlandCellCycleModelV2> cells_generator;
+        cells_generator.Generate(cells, p_mesh, location_indices, true);
+
+        mpPopulation.reset(new GastricGlandCellPopulation<2>(*p_mesh, cells, location_indices, 0.0, 0.8));
+        mpPopulation->SetGlandContext(mpContext);
+
+        WntConcentration<2>::Instance()->SetType(LINEAR);
+        WntConcentration<2>::Instance()->SetCellPopulation(*mpPopulation);
+        WntConcentration<2>::Instance()->SetCryptLength(numCellsHigh);
+    }
+
+    /**
+     * Destroy the population, and then the singletons.
+     */
+    ~GlandTestFixture()
+    {
+        mpPopulation.reset();
+        mpContext.reset();
+        mDriver.tearDown();
+    }
+
+    /**
+     * @return the mesh
+     */
+    Cylindrical2dMesh* GetMesh()
+    {
+        return mGenerator.GetCylindricalMesh();
+    }
+
+    /**
+     * @return the population
+     */
+    GastricGlandCellPopulation<2>& rGetPopulation()
+    {
+        return *mpPopulation;
+    }
+
+    /**
+     * @return the context attached to the population
+     */
+    GlandContext<2>& rGetContext()
+    {
+        return *mpContext;
+    }
+};
+
+#endif /*GLANDTESTFIXTURE_HPP_*/
@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTFOVEOLARCELLKILLER_HPP_
+#define TESTFOVEOLARCELLKILLER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <boost/weak_ptr.hpp>
+#include <list>
+#include <set>
+
+#include "FoveolarCellKiller.hpp"
+#include "FoveolarCellProliferativeType.hpp"
+#include "GlandTestFixture.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that the queue kept by FoveolarCellKiller kills exactly the cells the age scan
+ * it replaced would have killed, at the same steps, while cells become foveolar, leave
+ * the foveolar zone and are sloughed; and that it does not keep removed cells alive.
+ */
+class TestFoveolarCellKiller : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed for the birth times and type changes. */
+    static const unsigned SEED = 5;
+
+    /** Age beyond which foveolar cells are killed. */
+    static constexpr double CUTOFF_AGE = 2.0;
+
+    /** Time at which the run ends. */
+    static constexpr double END_TIME = 4.0;
+
+    /** Number of steps to the end time. */
+    static const unsigned NUM_STEPS = 80;
+
+    /**
+     * @param rPopulation the population
+     * @return the ids of the cells in the population marked dead
+     */
+    static std::set<unsigned> GetDeadCellIds(GastricGlandCellPopulation<2>& rPopulation)
+    {
+        // The population's iterator skips dead cells, so go through the list itself
+        std::set<unsigned> ids;
+        std::list<CellPtr>& r_cells = rPopulation.rGetCells();
+        for (std::list<CellPtr>::iterator it = r_cells.begin(); it != r_cells.end(); ++it)
+        {
+            if ((*it)->IsDead())
+            {
+                ids.insert((*it)->GetCellId());
+            }
+        }
+        return ids;
+    }
+
+public:
+
+    void TestQueueKillsAsAgeScan()
+    {
+        GlandTestFixture gland(20, SEED);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(END_TIME, NUM_STEPS);
+        GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+        GlandContext<2>& r_context = gland.rGetContext();
+
+        boost::shared_ptr<AbstractCellProperty> p_foveolar =
+            CellPropertyRegistry::Instance()->Get<FoveolarCellProliferativeType>();
+        boost::shared_ptr<AbstractCellProperty> p_transit =
+            CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>();
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+
+        // The upper cells start foveolar; every cell is up to the cutoff age old
+        for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+        {
+            bool is_upper = population.GetLocationOfCellCentre(*cell_iter)[1] > 10.0;
+            cell_iter->SetCellProliferativeType(is_upper ? p_foveolar : p_transit);
+            cell_iter->SetBirthTime(-CUTOFF_AGE*p_gen->ranf());
+        }
+
+        FoveolarCellKiller<2> killer(&population, CUTOFF_AGE);
+
+        unsigned num_killed = 0;
+        unsigned num_sloughed = 0;
+        for (unsigned step=0; step<NUM_STEPS; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+
+            // Some cells become foveolar, recorded as GastricGlandCellCycleModelV2 does, and some leave
+            for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+            {
+                double u = p_gen->ranf();
+                if (cell_iter->GetCellProliferativeType()->IsType<TransitCellProliferativeType>() && u < 0.02)
+                {
+                    cell_iter->SetCellProliferativeType(p_foveolar);
+                    r_context.RecordNewFoveolarCell(*cell_iter);
+                }
+                else if (cell_iter->GetCellProliferativeType()->IsType<FoveolarCellProliferativeType>() && u < 0.01)
+                {
+                    cell_iter->SetCellProliferativeType(p_transit);
+                }
+            }
+
+            // The age scan which the queue replaced
+            std::set<unsigned> expected_ids;
+            for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+            {
+                if (cell_iter->GetCellProliferativeType()->IsType<FoveolarCellProliferativeType>()
+                    && cell_iter->GetAge() > CUTOFF_AGE)
+                {
+                    expected_ids.insert(cell_iter->GetCellId());
+                }
+            }
+
+            killer.CheckAndLabelCellsForApoptosisOrDeath();
+            std::set<unsigned> killed_ids = GetDeadCellIds(population);
+            TS_ASSERT(killed_ids == expected_ids);
+            num_killed += killed_ids.size();
+
+            // Slough the youngest foveolar cell every few steps, long before it is due to die
+            boost::weak_ptr<Cell> p_sloughed;
+            if (step % 5 == 0)
+            {
+                CellPtr p_youngest;
+                for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+                {
+                    if (cell_iter->GetCellProliferativeType()->IsType<FoveolarCellProliferativeType>()
+                        && (!p_youngest || cell_iter->GetBirthTime() > p_youngest->GetBirthTime()))
+                    {
+                        p_youngest = *cell_iter;
+                    }
+                }
+                if (p_youngest)
+                {
+                    p_youngest->Kill();
+                    p_sloughed = p_youngest;
+                    num_sloughed++;
+                }
+            }
+
+            population.RemoveDeadCells();
+
+            // The simulation rebuilds the shared cell index each step, so only the queue could still hold the cell
+            r_context.rGetCellIndex().Refresh(population);
+            TS_ASSERT(p_sloughed.expired());
+        }
+
+        TS_ASSERT_LESS_THAN(10u, num_killed);
+        TS_ASSERT_LESS_THAN(10u, num_sloughed);
+    }
+};
+
+#endif /*TESTFOVEOLARCELLKILLER_HPP_*/
@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGASTRICGLANDADAPTIVEDT_HPP_
+#define TESTGASTRICGLANDADAPTIVEDT_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <string>
+
+#include "GastricGlandSimulation2d.hpp"
+#include "GlandBinaryOutputReader.hpp"
+#include "GlandBinaryOutputWriter.hpp"
+#include "GlandSpringForce.hpp"
+#include "GlandTestFixture.hpp"
+#include "OutputFileHandler.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that an adaptive time step, whether it grows or shrinks, still writes output at
+ * exactly the sampling times of a fixed step and ends exactly at the end time.
+ */
+class TestGastricGlandAdaptiveDt : public CxxTest::TestSuite
+{
+private:
+
+    /** Initial time step. */
+    static constexpr double DT = 1.0/120.0;
+
+    /** Initial number of time steps per sampling interval. */
+    static const unsigned SAMPLING_TIMESTEP_MULTIPLE = 12;
+
+    /** Smallest time step allowed. */
+    static constexpr double MIN_DT = 1.0/1200.0;
+
+    /** Largest time step allowed. */
+    static constexpr double MAX_DT = 1.0/30.0;
+
+    /** Time at which the run ends, a whole number of sampling intervals. */
+    static constexpr double END_TIME = 2.0;
+
+    /**
+     * Run a small gland with an adaptive time step, and check its output times.
+     *
+     * @param rOutputDirectory the output directory
+     * @param targetDisplacement the node displacement per step to aim for
+     * @return the time step in use at the end of the run
+     */
+    static double RunAndCheckSampleTimes(const std::string& rOutputDirectory, double targetDisplacement)
+    {
+        double final_dt;
+        {
+            GlandTestFixture gland(20, 4);
+            GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+            Cylindrical2dMesh* p_mesh = gland.GetMesh();
+
+            // Perturb the lattice, so that the nodes never stop moving
+            for (unsigned index=0; index<p_mesh->GetNumAllNodes(); index++)
+            {
+                p_mesh->GetNode(index)->rGetModifiableLocation()[1] += 0.1*(RandomNumberGenerator::Instance()->ranf() - 0.5);
+            }
+            population.Update();
+            population.AddPopulationWriter<GlandBinaryOutputWriter>();
+
+            GastricGlandSimulation2d simulator(population);
+            simulator.SetOutputDirectory(rOutputDirectory);
+            simulator.SetDt(DT);
+            simulator.SetSamplingTimestepMultiple(SAMPLING_TIMESTEP_MULTIPLE);
+            simulator.SetAdaptiveDt(MIN_DT, MAX_DT, targetDisplacement);
+            MAKE_PTR(GlandSpringForce<2>, p_force);
+            simulator.AddForce(p_force);
+            simulator.FixBottomCells();
+
+            simulator.SetEndTime(END_TIME);
+            simulator.Solve();
+
+            TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), END_TIME, 1e-12);
+            final_dt = simulator.GetDt();
+            TS_ASSERT_DELTA(final_dt*simulator.GetSamplingTimestepMultiple(), DT*SAMPLING_TIMESTEP_MULTIPLE, 1e-12);
+        }
+
+        // Every sampling time of the fixed step is written, and no other
+        OutputFileHandler handler(rOutputDirectory + "/results_from_time_0", false);
+        GlandBinaryOutputReader reader(handler.GetOutputDirectoryFullPath() + "results.glandbin");
+        GlandOutputSample sample;
+        unsigned num_samples = 0;
+        while (reader.ReadNextSample(sample))
+        {
+            TS_ASSERT_DELTA(sample.time, num_samples*DT*SAMPLING_TIMESTEP_MULTIPLE, 1e-10);
+            num_samples++;
+        }
+        TS_ASSERT_EQUALS(num_samples, 21u);
+        TS_ASSERT_DELTA(sample.time, END_TIME, 1e-10);
+
+        return final_dt;
+    }
+
+public:
+
+    void TestGrowingStepKeepsSampleTimes()
+    {
+        // Any displacement is well below the target, so the step doubles each interval up to the largest
+        double final_dt = RunAndCheckSampleTimes("TestGastricGlandAdaptiveDt/grow", 10.0);
+        TS_ASSERT_DELTA(final_dt, MAX_DT, 1e-12);
+    }
+
+    void TestShrinkingStepKeepsSampleTimes()
+    {
+        // Any displacement is well above the target, so the step falls to the smallest
+        double final_dt = RunAndCheckSampleTimes("TestGastricGlandAdaptiveDt/shrink", 1e-9);
+        TS_ASSERT_DELTA(final_dt, MIN_DT, 1e-12);
+    }
+};
+
+#endif /*TESTGASTRICGLANDADAPTIVEDT_HPP_*/
@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGASTRICGLANDCELLCYCLEMODELV2_HPP_
+#define TESTGASTRICGLANDCELLCYCLEMODELV2_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include "GlandTestFixture.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that the steps on which GastricGlandCellCycleModelV2 skips UpdateCellCyclePhase()
+ * change nothing: with zones assigned, as GlandBaseTrackingModifier does, cells divide and
+ * change type at exactly the same times as when every call is evaluated in full.
+ */
+class TestGastricGlandCellCycleModelV2 : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed for the birth times and G1 durations. */
+    static const unsigned SEED = 9;
+
+    /** Height of the gland, in rows of cells. */
+    static const unsigned GLAND_HEIGHT = 20;
+
+    /** Time at which the run ends. */
+    static constexpr double END_TIME = 100.0;
+
+    /** Number of steps to the end time. */
+    static const unsigned NUM_STEPS = 2000;
+
+    /** Distance every node moves up each step, wrapping from the top back to the base. */
+    static constexpr double SPEED = 0.02;
+
+    /**
+     * Move a small gland up through every zone, twice, dividing cells as they become ready.
+     *
+     * @param assignZones whether to assign each cell its zone every step, which lets the
+     *     model skip evaluations; otherwise the model finds the zone itself and never skips
+     * @param rNumDivisions set to the number of divisions
+     * @return a description of every division and the final state of every cell
+     */
+    static std::string Run(bool assignZones, unsigned& rNumDivisions)
+    {
+        std::stringstream description;
+        description.precision(17);
+        rNumDivisions = 0;
+
+        GlandTestFixture gland(GLAND_HEIGHT, SEED);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(END_TIME, NUM_STEPS);
+        GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+        Cylindrical2dMesh* p_mesh = gland.GetMesh();
+        GlandContext<2>& r_context = gland.rGetContext();
+        r_context.SetIsthmusBeginHeight(12.0);
+        r_context.SetIsthmusEndHeight(15.0);
+
+        // Without a GlandBaseTrackingModifier, the models must be given their population
+        for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+        {
+            static_cast<GastricGlandCellCycleModelV2*>(cell_iter->GetCellCycleModel())->SetGlandPopulation(&population);
+        }
+
+        for (unsigned step=0; step<NUM_STEPS; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+
+            for (unsigned index=0; index<p_mesh->GetNumAllNodes(); index++)
+            {
+                c_vector<double, 2>& r_location = p_mesh->GetNode(index)->rGetModifiableLocation();
+                r_location[1] = std::fmod(r_location[1] + SPEED, GLAND_HEIGHT);
+            }
+
+            for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+            {
+                GastricGlandCellCycleModelV2* p_model = static_cast<GastricGlandCellCycleModelV2*>(cell_iter->GetCellCycleModel());
+                if (assignZones)
+                {
+                    p_model->SetZone(r_context.ClassifyZone(population.GetLocationOfCellCentre(*cell_iter)[1]));
+                }
+
+                if (cell_iter->ReadyToDivide())
+                {
+                    description << "step " << step << ": cell " << cell_iter->GetCellId() << " divides\n";
+                    p_model->ResetForDivision();
+                    rNumDivisions++;
+                }
+            }
+        }
+
+        for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+        {
+            AbstractPhaseBasedCellCycleModel* p_model = static_cast<AbstractPhaseBasedCellCycleModel*>(cell_iter->GetCellCycleModel());
+            description << "cell " << cell_iter->GetCellId()
+                        << " type " << cell_iter->GetCellProliferativeType()->GetColour()
+                        << " phase " << p_model->GetCurrentCellCyclePhase()
+                        << " birth " << p_model->GetBirthTime()
+                        << " g1 " << p_model->GetG1Duration() << "\n";
+        }
+        return description.str();
+    }
+
+public:
+
+    void TestSkippedUpdatesMatchFullEvaluation()
+    {
+        unsigned num_divisions_skipping;
+        std::string skipping = Run(true, num_divisions_skipping);
+
+        unsigned num_divisions_full;
+        std::string full = Run(false, num_divisions_full);
+
+        TS_ASSERT_LESS_THAN(20u, num_divisions_full);
+        TS_ASSERT_EQUALS(num_divisions_skipping, num_divisions_full);
+        TS_ASSERT_EQUALS(skipping, full);
+    }
+};
+
+#endif /*TESTGASTRICGLANDCELLCYCLEMODELV2_HPP_*/
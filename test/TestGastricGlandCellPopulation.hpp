@@ -0,0 +1,95 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGASTRICGLANDCELLPOPULATION_HPP_
+#define TESTGASTRICGLANDCELLPOPULATION_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include "FoveolarCellProliferativeType.hpp"
+#include "GlandTestFixture.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that the rest length table of GastricGlandCellPopulation is rebuilt after
+ * births, deaths and recorded type changes, and only then.
+ */
+class TestGastricGlandCellPopulation : public CxxTest::TestSuite
+{
+public:
+
+    void TestRestLengthsFollowTypeChanges()
+    {
+        GlandTestFixture gland(12, 1);
+        GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+        GlandContext<2>& r_context = gland.rGetContext();
+
+        CellPtr p_cell = population.rGetCells().front();
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+        population.Update();
+
+        unsigned index = population.GetLocationIndexUsingCell(p_cell);
+        TS_ASSERT_DELTA(population.GetRestLength(index, index), 1.0, 1e-12);
+
+        // A type change the context has not been told of leaves the table as it was
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<FoveolarCellProliferativeType>());
+        population.Update(false);
+        TS_ASSERT_DELTA(population.GetRestLength(index, index), 1.0, 1e-12);
+
+        // Once recorded, as the cell-cycle models do, the next update rebuilds it
+        r_context.RecordCellTypeChange();
+        TS_ASSERT_EQUALS(r_context.GetNumCellTypeChanges(), 1u);
+        population.Update(false);
+        TS_ASSERT_DELTA(population.GetRestLength(index, index), 0.8, 1e-12);
+
+        // So does a step with births or deaths
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+        population.Update(true);
+        TS_ASSERT_DELTA(population.GetRestLength(index, index), 1.0, 1e-12);
+
+        // Without a context, type changes cannot be tracked, so every update rebuilds the table
+        population.SetGlandContext(boost::shared_ptr<GlandContext<2> >());
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<FoveolarCellProliferativeType>());
+        population.Update(false);
+        TS_ASSERT_DELTA(population.GetRestLength(index, index), 0.8, 1e-12);
+    }
+};
+
+#endif /*TESTGASTRICGLANDCELLPOPULATION_HPP_*/
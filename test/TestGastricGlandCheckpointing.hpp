@@ -0,0 +1,285 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTGASTRICGLANDCHECKPOINTING_HPP_
+#define TESTGASTRICGLANDCHECKPOINTING_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CellBasedSimulationArchiver.hpp"
+#include "CylindricalHoneycombMeshGenerator.hpp"
+#include "GastricGlandCellsGenerator.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "GastricGlandSimulation.hpp"
+#include "GastricGlandSimulation2d.hpp"
+#include "GlandBaseTrackingModifier.hpp"
+#include "GlandCheckpoint.hpp"
+#include "GlandSpringForce.hpp"
+#include "GlandSloughingCellKiller.hpp"
+#include "CellLabel.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that checkpointing is restart-exact: a run saved part way through and continued
+ * from its checkpoint must end in exactly the state of the same run continued in memory.
+ *
+ * Both runs stop and restart Solve() at the split time, so that they differ only in
+ * whether the simulation went through a checkpoint in between.
+ */
+class TestGastricGlandCheckpointing : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed shared by both runs. */
+    static const unsigned SEED = 3;
+
+    /** Time at which the split run is saved and loaded. */
+    static constexpr double SPLIT_TIME = 2.0;
+
+    /** Time at which both runs end. */
+    static constexpr double END_TIME = 4.0;
+
+    /**
+     * Add the mechanics, killers and modifiers used by GastricGlandSimulation::simplifiedModel,
+     * which a gland checkpoint does not save.
+     *
+     * @param rSimulator the simulation
+     */
+    static void ConfigureGland(GastricGlandSimulation2d& rSimulator)
+    {
+        GastricGlandCellPopulation<2>& r_population = static_cast<GastricGlandCellPopulation<2>&>(rSimulator.rGetCellPopulation());
+
+        rSimulator.SetDt(1.0/120.0);
+        rSimulator.SetSamplingTimestepMultiple(120);
+        r_population.SetAreaBasedDampingConstant(true);
+
+        MAKE_PTR(GlandSpringForce<2>, p_force);
+        rSimulator.AddForce(p_force);
+
+        MAKE_PTR_ARGS(GlandSloughingCellKiller<2>, p_killer, (&r_population, 20.0));
+        rSimulator.AddCellKiller(p_killer);
+
+        MAKE_PTR(GlandBaseTrackingModifier<2>, p_modifier);
+        rSimulator.AddSimulationModifier(p_modifier);
+
+        rSimulator.FixBottomCells();
+    }
+
+    /**
+     * Build a small gland, configure it and solve it to the split time.
+     *
+     * @param rOutputDirectory the output directory
+     * @param splitRun whether to save a checkpoint at the split time and stop, rather than continue to the end time
+     * @param format the format of the checkpoint saved by a split run
+     * @return the description of the final state of an unsplit run, or the empty string for a split run
+     */
+    static std::string RunFromLattice(const std::string& rOutputDirectory, bool splitRun, GlandCheckpointFormat format)
+    {
+        GastricGlandSimulation driver;
+        driver.setUp(SEED);
+
+        std::string state;
+        {
+            CylindricalHoneycombMeshGenerator generator(6, 20, 2);
+            Cylindrical2dMesh* p_mesh = generator.GetCylindricalMesh();
+            std::vector<unsigned> location_indices = generator.GetCellLocationIndices();
+
+            std::vector<CellPtr> cells;
+            GastricGlandCellsGenerator<GastricGlandCellCycleModelV2> cells_generator;
+            cells_generator.Generate(cells, p_mesh, location_indices, true);
+
+            GastricGlandCellPopulation<2> population(*p_mesh, cells, location_indices, 0.0, 0.8);
+
+            WntConcentration<2>::Instance()->SetType(LINEAR);
+            WntConcentration<2>::Instance()->SetCellPopulation(population);
+            WntConcentration<2>::Instance()->SetCryptLength(20.0);
+
+            GastricGlandSimulation2d simulator(population);
+            ConfigureGland(simulator);
+            simulator.SetCheckpointFormat(format);
+            simulator.SetOutputDirectory(rOutputDirectory);
+
+            // Label some cells, so that labels and ancestors have to survive the checkpoint
+            simulator.LabelBaseCellAncestors();
+            for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+            {
+                if (population.GetLocationOfCellCentre(*cell_iter)[1] > 15.0)
+                {
+                    cell_iter->AddCellProperty(CellPropertyRegistry::Instance()->Get<CellLabel>());
+                }
+            }
+
+            simulator.SetEndTime(SPLIT_TIME);
+            simulator.Solve();
+
+            if (splitRun)
+            {
+                simulator.SaveCheckpoint();
+            }
+            else
+            {
+                simulator.SetEndTime(END_TIME);
+                simulator.Solve();
+                state = DescribeState(simulator);
+            }
+        }
+
+        driver.tearDown();
+        return state;
+    }
+
+    /**
+     * Load the checkpoint saved by a split run and continue it to the end time.
+     *
+     * @param rOutputDirectory the output directory of the split run
+     * @param format the format of the checkpoint
+     * @return the description of the final state
+     */
+    static std::string RunFromCheckpoint(const std::string& rOutputDirectory, GlandCheckpointFormat format)
+    {
+        // A different seed: the checkpoint must restore the generator itself
+        GastricGlandSimulation driver;
+        driver.setUp(SEED + 1);
+
+        GastricGlandSimulation2d* p_simulator;
+        if (format == CHECKPOINT_FORMAT_GLAND)
+        {
+            p_simulator = GlandCheckpoint::Load(rOutputDirectory, SPLIT_TIME);
+            ConfigureGland(*p_simulator);
+        }
+        else
+        {
+            // A Boost archive holds the forces, killers and modifiers too, as GastricGlandSimulation::runFromCheckpoint relies on
+            p_simulator = CellBasedSimulationArchiver<2, GastricGlandSimulation2d>::Load(rOutputDirectory, SPLIT_TIME);
+            WntConcentration<2>::Instance()->SetCellPopulation(p_simulator->rGetCellPopulation());
+        }
+        p_simulator->SetOutputDirectory(rOutputDirectory);
+
+        p_simulator->SetEndTime(END_TIME);
+        p_simulator->Solve();
+        std::string state = DescribeState(*p_simulator);
+
+        delete p_simulator;
+        driver.tearDown();
+        return state;
+    }
+
+    /**
+     * Describe everything about the state of a simulation which later steps depend on,
+     * to full precision, so that two states can be compared for exact equality.
+     *
+     * @param rSimulator the simulation
+     * @return the description
+     */
+    static std::string DescribeState(GastricGlandSimulation2d& rSimulator)
+    {
+        AbstractCellPopulation<2>& r_population = rSimulator.rGetCellPopulation();
+
+        std::vector<CellPtr> cells(r_population.Begin(), r_population.End());
+        std::sort(cells.begin(), cells.end(),
+                  [](CellPtr pA, CellPtr pB) { return pA->GetCellId() < pB->GetCellId(); });
+
+        std::stringstream state;
+        state.precision(17);
+        state << "time " << SimulationTime::Instance()->GetTime()
+              << " cells " << cells.size()
+              << " births " << rSimulator.GetNumBirths()
+              << " deaths " << rSimulator.GetNumDeaths()
+              << " ancestor index " << rSimulator.GetCellAncestorIndex() << "\n";
+
+        for (CellPtr p_cell : cells)
+        {
+            GastricGlandCellCycleModelV2* p_model = static_cast<GastricGlandCellCycleModelV2*>(p_cell->GetCellCycleModel());
+            c_vector<double, 2> location = r_population.GetLocationOfCellCentre(p_cell);
+            state << p_cell->GetCellId()
+                  << " " << r_population.GetLocationIndexUsingCell(p_cell)
+                  << " " << location[0] << " " << location[1]
+                  << " " << p_cell->GetCellProliferativeType()->GetColour()
+                  << " " << p_cell->GetBirthTime()
+                  << " " << p_model->GetG1Duration()
+                  << " " << p_model->GetCurrentCellCyclePhase()
+                  << " " << unsigned(p_model->GetZone())
+                  << " " << p_cell->GetAncestor()
+                  << " " << p_cell->HasCellProperty<CellLabel>() << "\n";
+        }
+
+        c_vector<double, 2> base = rSimulator.rGetGlandContext().rGetBasePosition();
+        state << "base " << base[0] << " " << base[1] << "\n";
+
+        // The generator must continue from the same state too
+        state << "next random " << RandomNumberGenerator::Instance()->ranf() << "\n";
+        return state.str();
+    }
+
+    /**
+     * Check that a run split by a checkpoint in the given format ends exactly as the unsplit run.
+     *
+     * @param format the checkpoint format
+     * @param rName a name for the output directories
+     */
+    static void CheckSplitRunMatchesUnsplitRun(GlandCheckpointFormat format, const std::string& rName)
+    {
+        std::string unsplit_state = RunFromLattice("TestGastricGlandCheckpointing/unsplit_" + rName, false, format);
+
+        RunFromLattice("TestGastricGlandCheckpointing/split_" + rName, true, format);
+        std::string split_state = RunFromCheckpoint("TestGastricGlandCheckpointing/split_" + rName, format);
+
+        TS_ASSERT(!unsplit_state.empty());
+        TS_ASSERT_EQUALS(split_state, unsplit_state);
+    }
+
+public:
+
+    void TestSplitRunMatchesUnsplitRun()
+    {
+        CheckSplitRunMatchesUnsplitRun(CHECKPOINT_FORMAT_GLAND, "gland");
+    }
+
+    void TestSplitRunMatchesUnsplitRunWithBoostArchive()
+    {
+        CheckSplitRunMatchesUnsplitRun(CHECKPOINT_FORMAT_BOOST, "boost");
+    }
+};
+
+#endif /*TESTGASTRICGLANDCHECKPOINTING_HPP_*/
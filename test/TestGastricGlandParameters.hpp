@@ -0,0 +1,246 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGASTRICGLANDPARAMETERS_HPP_
+#define TESTGASTRICGLANDPARAMETERS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ExecutableSupport.hpp"
+#include "GastricGlandSimulation.hpp"
+#include "Parameters.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks the parsing of KEY=VALUE input, the parameter registry, the consistency checks
+ * on the parameters, and that --quiet silences a run.
+ */
+class TestGastricGlandParameters : public CxxTest::TestSuite
+{
+public:
+
+    void TestMakeMap()
+    {
+        std::map<std::string, std::string> map = makeMap(
+            "# a comment\n"
+            "\n"
+            "  seed = 3  \n"
+            "dt=0.01\n"
+            "output-directory=a=b\n"
+            "seed=4");
+        TS_ASSERT_EQUALS(map.size(), 3u);
+        TS_ASSERT_EQUALS(map["seed"], "4");
+        TS_ASSERT_EQUALS(map["dt"], "0.01");
+        TS_ASSERT_EQUALS(map["output-directory"], "a=b");
+
+        TS_ASSERT(makeMap("").empty());
+        TS_ASSERT(makeMap("\n  \n# only comments\n").empty());
+
+        TS_ASSERT_THROWS_THIS(makeMap("seed"), "\"seed\" is not a KEY=VALUE pair");
+        TS_ASSERT_THROWS_THIS(makeMap("seed= "), "\"seed=\" is missing key or value");
+        TS_ASSERT_THROWS_THIS(makeMap("=3"), "\"=3\" is missing key or value");
+    }
+
+    void TestParseUnsigned()
+    {
+        TS_ASSERT_EQUALS(parseUnsigned("0", "--jobs"), 0u);
+        TS_ASSERT_EQUALS(parseUnsigned("4294967295", "--jobs"), 4294967295u);
+
+        TS_ASSERT_THROWS_THIS(parseUnsigned("", "--jobs"), "--jobs must be a non-negative integer, not \"\"");
+        TS_ASSERT_THROWS_THIS(parseUnsigned("-1", "--jobs"), "--jobs must be a non-negative integer, not \"-1\"");
+        TS_ASSERT_THROWS_THIS(parseUnsigned("+1", "--jobs"), "--jobs must be a non-negative integer, not \"+1\"");
+        TS_ASSERT_THROWS_THIS(parseUnsigned("7x", "--jobs"), "--jobs must be a non-negative integer, not \"7x\"");
+        TS_ASSERT_THROWS_THIS(parseUnsigned("4294967296", "--jobs"), "--jobs must be a non-negative integer, not \"4294967296\"");
+    }
+
+    void TestRegistrySetsEachType()
+    {
+        std::map<std::string, std::string> map;
+        map["output-directory"] = "somewhere";
+        map["num-cells-across"] = "12";
+        map["dt"] = "0.005";
+        map["adaptive-dt"] = "true";
+        map["use-sloughing"] = "0";
+        map["label-ancestors"] = "false";
+        map["async-output"] = "1";
+
+        GastricGlandParameters params;
+        params.update(map);
+        TS_ASSERT_EQUALS(params.output_directory, "somewhere");
+        TS_ASSERT_EQUALS(params.num_cells_across, 12u);
+        TS_ASSERT_DELTA(params.dt, 0.005, 1e-15);
+        TS_ASSERT(params.adaptive_dt);
+        TS_ASSERT(!params.use_sloughing);
+        TS_ASSERT(!params.label_ancestors);
+        TS_ASSERT(params.async_output);
+
+        // Keys not in the map keep their defaults
+        GastricGlandParameters defaults;
+        TS_ASSERT_EQUALS(params.seed, defaults.seed);
+        TS_ASSERT_EQUALS(params.gland_height, defaults.gland_height);
+
+        // Every key listed by help() is valid, and they are sorted for validate()
+        for (unsigned i=0; i<GastricGlandParameters::valid_keys.size(); i++)
+        {
+            TS_ASSERT_DIFFERS(GastricGlandParameters::help().find(GastricGlandParameters::valid_keys[i]), std::string::npos);
+            if (i > 0)
+            {
+                TS_ASSERT_LESS_THAN(GastricGlandParameters::valid_keys[i-1], GastricGlandParameters::valid_keys[i]);
+            }
+        }
+    }
+
+    void TestRegistryRejectsBadInput()
+    {
+        GastricGlandParameters params;
+
+        std::map<std::string, std::string> unknown;
+        unknown["seed"] = "1";
+        unknown["no-such-key"] = "1";
+        TS_ASSERT_THROWS_CONTAINS(params.update(unknown), "\"no-such-key\"");
+
+        // Every bad value is reported at once, and none is applied
+        std::map<std::string, std::string> bad;
+        bad["seed"] = "-1";
+        bad["dt"] = "inf";
+        bad["gland-height"] = "40x";
+        bad["use-sloughing"] = "yes";
+        try
+        {
+            params.update(bad);
+            TS_FAIL("update() should have thrown");
+        }
+        catch (const Exception& e)
+        {
+            std::string message = e.GetShortMessage();
+            TS_ASSERT_DIFFERS(message.find("seed=-1: expected a non-negative integer"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("dt=inf: expected a finite number"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("gland-height=40x: expected a finite number"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("use-sloughing=yes: expected true or false"), std::string::npos);
+        }
+        GastricGlandParameters defaults;
+        TS_ASSERT_EQUALS(params.seed, defaults.seed);
+        TS_ASSERT_EQUALS(params.dt, defaults.dt);
+        TS_ASSERT_EQUALS(params.use_sloughing, defaults.use_sloughing);
+    }
+
+    void TestCheck()
+    {
+        GastricGlandParameters params;
+        TS_ASSERT_THROWS_NOTHING(params.check());
+
+        params.dt = 0.0;
+        TS_ASSERT_THROWS_CONTAINS(params.check(), "dt must be positive");
+        params.dt = 1.0/120.0;
+
+        params.sampling_timestep_multiple = 0;
+        TS_ASSERT_THROWS_CONTAINS(params.check(), "sampling-timestep-multiple must be at least 1");
+        params.sampling_timestep_multiple = 12;
+
+        params.adaptive_dt = true;
+        params.min_dt = 2.0*params.max_dt;
+        TS_ASSERT_THROWS_CONTAINS(params.check(), "adaptive-dt needs 0 < min-dt <= max-dt");
+        params.min_dt = 0.5*params.max_dt;
+        TS_ASSERT_THROWS_NOTHING(params.check());
+
+        params.use_bmp_field = true;
+        params.field_grid_spacing = 0.0;
+        TS_ASSERT_THROWS_CONTAINS(params.check(), "use-bmp-field needs");
+        params.field_grid_spacing = 1.0;
+        TS_ASSERT_THROWS_NOTHING(params.check());
+
+        params.warm_start_cache = "cache/../elsewhere";
+        params.resume_from = "runs/sim_0";
+        TS_ASSERT_THROWS_NOTHING(params.check());
+
+        // Every problem is listed, not just the first
+        params.simulation_time = -1.0;
+        params.gland_height = 0.0;
+        params.isthmus_begin_height = params.isthmus_end_height + 1.0;
+        params.warm_start_cache = "/tmp/cache";
+        params.resume_from = "/tmp/run";
+        try
+        {
+            params.check();
+            TS_FAIL("check() should have thrown");
+        }
+        catch (const Exception& e)
+        {
+            std::string message = e.GetShortMessage();
+            TS_ASSERT_DIFFERS(message.find("simulation-time must not be negative"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("gland-height must be positive"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("isthmus-begin-height must not be above isthmus-end-height"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("warm-start-cache must be relative to CHASTE_TEST_OUTPUT"), std::string::npos);
+            TS_ASSERT_DIFFERS(message.find("resume-from must be relative to CHASTE_TEST_OUTPUT"), std::string::npos);
+        }
+    }
+
+    void TestQuietRunWritesNothing()
+    {
+        std::vector<std::string> args = {
+            "gastric_gland", "--quiet",
+            "output-directory=TestGastricGlandParameters",
+            "num-cells-across=6", "num-cells-high=12", "gland-height=12",
+            "isthmus-begin-height=7", "isthmus-end-height=9",
+            "simulation-time=0.5", "num-epochs=0"};
+        std::vector<char*> argv;
+        for (std::string& r_arg : args)
+        {
+            argv.push_back(&r_arg[0]);
+        }
+
+        std::stringstream captured;
+        std::streambuf* p_cout = std::cout.rdbuf(captured.rdbuf());
+        std::streambuf* p_cerr = std::cerr.rdbuf(captured.rdbuf());
+        GastricGlandSimulation simulation;
+        int exit_code = simulation.run(static_cast<int>(argv.size()), argv.data());
+        std::cout.rdbuf(p_cout);
+        std::cerr.rdbuf(p_cerr);
+
+        TS_ASSERT_EQUALS(exit_code, ExecutableSupport::EXIT_OK);
+        TS_ASSERT_EQUALS(captured.str(), "");
+    }
+};
+
+#endif /*TESTGASTRICGLANDPARAMETERS_HPP_*/
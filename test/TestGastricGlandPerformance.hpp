@@ -0,0 +1,366 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTGASTRICGLANDPERFORMANCE_HPP_
+#define TESTGASTRICGLANDPERFORMANCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CylindricalHoneycombMeshGenerator.hpp"
+#include "GastricGlandCellsGenerator.hpp"
+#include "GastricGlandCellCycleModelV2.hpp"
+#include "GastricGlandCellPopulation.hpp"
+#include "GastricGlandSimulation.hpp"
+#include "GlandBaseTrackingModifier.hpp"
+#include "GlandContext.hpp"
+#include "FoveolarCellKiller.hpp"
+#include "GastricGlandBaseCellKiller.hpp"
+#include "GlandSloughingCellKiller.hpp"
+#include "OutputFileHandler.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Timings of the gastric gland model, written to TestGastricGlandPerformance/performance.json.
+ *
+ * If the environment variable GASTRIC_GLAND_PERF_BASELINE names a performance.json from an
+ * earlier run, every benchmark is compared against it and the suite fails if any is slower
+ * than the baseline by more than GASTRIC_GLAND_PERF_TOLERANCE (a fraction, default 0.25).
+ *
+ * The tests run in order: the last one writes and compares the results of the others.
+ */
+class TestGastricGlandPerformance : public CxxTest::TestSuite
+{
+private:
+
+    /** Seconds taken by each benchmark, keyed by name. */
+    static std::map<std::string, double> msResults;
+
+    /**
+     * A gland built as in GastricGlandSimulation::simplifiedModel, without a simulation.
+     * Members are destroyed in reverse order, so the population goes before its mesh.
+     */
+    struct BenchmarkGland
+    {
+        CylindricalHoneycombMeshGenerator mGenerator;
+        boost::shared_ptr<GastricGlandCellPopulation<2> > mpPopulation;
+        boost::shared_ptr<GlandContext<2> > mpContext;
+
+        BenchmarkGland(unsigned cellsAcross, unsigned cellsHigh)
+            : mGenerator(cellsAcross, cellsHigh, 2),
+              mpContext(new GlandContext<2>)
+        {
+            Cylindrical2dMesh* p_mesh = mGenerator.GetCylindricalMesh();
+            std::vector<unsigned> location_indices = mGenerator.GetCellLocationIndices();
+
+            std::vector<CellPtr> cells;
+            GastricGlandCellsGenerator<GastricGlandCellCycleModelV2> cells_generator;
+            cells_generator.Generate(cells, p_mesh, location_indices, true);
+
+            mpPopulation.reset(new GastricGlandCellPopulation<2>(*p_mesh, cells, location_indices, 0.0));
+            mpPopulation->SetGlandContext(mpContext);
+            mpPopulation->InitialiseCells();
+
+            WntConcentration<2>::Instance()->SetType(LINEAR);
+            WntConcentration<2>::Instance()->SetCellPopulation(*mpPopulation);
+            WntConcentration<2>::Instance()->SetCryptLength(40.0);
+
+            mpPopulation->Update();
+        }
+    };
+
+    /**
+     * Time a function, taking the best of three trials to damp out noise.
+     *
+     * @param function the function to time
+     * @param repetitions the number of calls in each trial
+     * @return the best time per call, in seconds
+     */
+    template<typename FUNCTION>
+    static double TimeBestOfThree(FUNCTION function, unsigned repetitions)
+    {
+        double best = DBL_MAX;
+        for (unsigned trial = 0; trial < 3; trial++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < repetitions; i++)
+            {
+                function();
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, elapsed/repetitions);
+        }
+        return best;
+    }
+
+    /**
+     * Set up the singletons used by the microbenchmarks.
+     *
+     * @param rSimulation provides the same setUp() as simplifiedModel
+     */
+    static void SetUpSingletons(GastricGlandSimulation& rSimulation)
+    {
+        rSimulation.setUp(1);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(100.0, 12000);
+    }
+
+    /**
+     * Read the benchmark times from a performance.json written by this suite.
+     *
+     * @param rPath the file
+     * @return seconds taken by each benchmark, keyed by name
+     */
+    static std::map<std::string, double> ReadResults(const std::string& rPath)
+    {
+        std::map<std::string, double> results;
+        std::ifstream file(rPath.c_str());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // Benchmarks are written one per line as "name": seconds
+            std::string::size_type open = line.find('"');
+            std::string::size_type close = line.find('"', open + 1);
+            std::string::size_type colon = line.find(':', close);
+            if (open == std::string::npos || close == std::string::npos || colon == std::string::npos)
+            {
+                continue;
+            }
+            std::stringstream value_stream(line.substr(colon + 1));
+            double value;
+            if (value_stream >> value)
+            {
+                results[line.substr(open + 1, close - open - 1)] = value;
+            }
+        }
+        return results;
+    }
+
+public:
+
+    void TestSimplifiedModelRuns()
+    {
+        const unsigned sizes[3][2] = {{6, 20}, {10, 40}, {16, 60}};
+
+        for (unsigned i = 0; i < 3; i++)
+        {
+            std::stringstream id;
+            id << sizes[i][0] << "x" << sizes[i][1];
+
+            GastricGlandParameters params;
+            params.output_directory = "TestGastricGlandPerformance";
+            params.simulation_id = id.str();
+            params.seed = 1;
+            params.simulation_time = 10.0;
+            params.num_epochs = 0;
+            params.num_cells_across = sizes[i][0];
+            params.num_cells_high = sizes[i][1];
+            params.gland_height = sizes[i][1];
+            params.max_cells = UINT_MAX;
+
+            GastricGlandSimulation simulation;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            simulation.simplifiedModel(params);
+            msResults["simplified_model_" + id.str()] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    void TestGetRestLength()
+    {
+        GastricGlandSimulation simulation;
+        SetUpSingletons(simulation);
+        {
+            BenchmarkGland gland(16, 60);
+            GastricGlandCellPopulation<2>& r_population = *gland.mpPopulation;
+
+            std::vector<std::pair<unsigned, unsigned> > springs;
+            for (MeshBasedCellPopulation<2>::SpringIterator spring_iter = r_population.SpringsBegin();
+                 spring_iter != r_population.SpringsEnd();
+                 ++spring_iter)
+            {
+                springs.push_back(std::make_pair(spring_iter.GetNodeA()->GetIndex(), spring_iter.GetNodeB()->GetIndex()));
+            }
+            TS_ASSERT(!springs.empty());
+
+            double total = 0.0;
+            msResults["get_rest_length"] = TimeBestOfThree([&]()
+            {
+                for (unsigned i = 0; i < springs.size(); i++)
+                {
+                    total += r_population.GetRestLength(springs[i].first, springs[i].second);
+                }
+            }, 200);
+            TS_ASSERT_LESS_THAN(0.0, total);
+        }
+        simulation.tearDown();
+    }
+
+    void TestUpdateCellCyclePhase()
+    {
+        GastricGlandSimulation simulation;
+        SetUpSingletons(simulation);
+        {
+            BenchmarkGland gland(16, 60);
+            GlandBaseTrackingModifier<2> modifier;
+            modifier.UpdateCellData(*gland.mpPopulation);
+
+            std::vector<GastricGlandCellCycleModelV2*> models;
+            for (AbstractCellPopulation<2>::Iterator cell_iter = gland.mpPopulation->Begin();
+                 cell_iter != gland.mpPopulation->End();
+                 ++cell_iter)
+            {
+                models.push_back(static_cast<GastricGlandCellCycleModelV2*>(cell_iter->GetCellCycleModel()));
+            }
+
+            msResults["update_cell_cycle_phase"] = TimeBestOfThree([&]()
+            {
+                for (unsigned i = 0; i < models.size(); i++)
+                {
+                    models[i]->UpdateCellCyclePhase();
+                }
+            }, 200);
+        }
+        simulation.tearDown();
+    }
+
+    void TestBaseTrackingModifier()
+    {
+        GastricGlandSimulation simulation;
+        SetUpSingletons(simulation);
+        {
+            BenchmarkGland gland(16, 60);
+            GlandBaseTrackingModifier<2> modifier;
+
+            msResults["base_tracking_update_cell_data"] = TimeBestOfThree([&]()
+            {
+                modifier.UpdateCellData(*gland.mpPopulation);
+            }, 200);
+        }
+        simulation.tearDown();
+    }
+
+    void TestKillers()
+    {
+        GastricGlandSimulation simulation;
+        SetUpSingletons(simulation);
+        {
+            BenchmarkGland gland(16, 60);
+            unsigned num_cells = gland.mpPopulation->GetNumRealCells();
+
+            // Thresholds are chosen so that no cell is killed and every call does the same work
+            FoveolarCellKiller<2> foveolar_killer(gland.mpPopulation.get(), DBL_MAX);
+            msResults["foveolar_cell_killer"] = TimeBestOfThree([&]()
+            {
+                foveolar_killer.CheckAndLabelCellsForApoptosisOrDeath();
+            }, 200);
+
+            GastricGlandBaseCellKiller<2> base_killer(gland.mpPopulation.get(), -1.0);
+            msResults["base_cell_killer"] = TimeBestOfThree([&]()
+            {
+                base_killer.CheckAndLabelCellsForApoptosisOrDeath();
+            }, 200);
+
+            GlandSloughingCellKiller<2> sloughing_killer(gland.mpPopulation.get(), 1e6);
+            msResults["sloughing_cell_killer"] = TimeBestOfThree([&]()
+            {
+                sloughing_killer.CheckAndLabelCellsForApoptosisOrDeath();
+            }, 200);
+
+            TS_ASSERT_EQUALS(gland.mpPopulation->GetNumRealCells(), num_cells);
+        }
+        simulation.tearDown();
+    }
+
+    void TestWriteResultsAndCompareWithBaseline()
+    {
+        OutputFileHandler handler("TestGastricGlandPerformance", false);
+        out_stream p_file = handler.OpenOutputFile("performance.json");
+        *p_file << "{\n  \"benchmarks\": {\n";
+        for (std::map<std::string, double>::const_iterator it = msResults.begin(); it != msResults.end(); ++it)
+        {
+            *p_file << "    \"" << it->first << "\": " << it->second
+                    << (std::next(it) != msResults.end() ? "," : "") << "\n";
+        }
+        *p_file << "  }\n}\n";
+        p_file->close();
+
+        const char* baseline_path = std::getenv("GASTRIC_GLAND_PERF_BASELINE");
+        if (baseline_path == nullptr)
+        {
+            return;
+        }
+
+        double tolerance = 0.25;
+        if (const char* tolerance_string = std::getenv("GASTRIC_GLAND_PERF_TOLERANCE"))
+        {
+            tolerance = std::atof(tolerance_string);
+        }
+
+        std::map<std::string, double> baseline = ReadResults(baseline_path);
+        TS_ASSERT(!baseline.empty());
+        for (std::map<std::string, double>::const_iterator it = baseline.begin(); it != baseline.end(); ++it)
+        {
+            std::map<std::string, double>::const_iterator current = msResults.find(it->first);
+            if (current == msResults.end())
+            {
+                continue;
+            }
+            if (current->second > it->second*(1.0 + tolerance))
+            {
+                std::stringstream message;
+                message << it->first << " regressed: " << current->second << " s against a baseline of "
+                        << it->second << " s (tolerance " << 100.0*tolerance << "%)";
+                TS_FAIL(message.str());
+            }
+        }
+    }
+};
+
+std::map<std::string, double> TestGastricGlandPerformance::msResults;
+
+#endif /*TESTGASTRICGLANDPERFORMANCE_HPP_*/
@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGASTRICGLANDWARMSTART_HPP_
+#define TESTGASTRICGLANDWARMSTART_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+
+#include "FileFinder.hpp"
+#include "GastricGlandSimulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "Parameters.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that warm starting is transparent: a run which has to burn in and fill the cache
+ * must write exactly the output of the same run served from the cache.
+ */
+class TestGastricGlandWarmStart : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @return the directory holding the cache and both runs, relative to CHASTE_TEST_OUTPUT
+     */
+    static std::string GetTestDirectory()
+    {
+        return "TestGastricGlandWarmStart";
+    }
+
+    /**
+     * @param rOutputDirectory the output directory of the run
+     * @return parameters for a small gland, warm started from the test's cache
+     */
+    static GastricGlandParameters MakeParameters(const std::string& rOutputDirectory)
+    {
+        std::map<std::string, std::string> map;
+        map["output-directory"] = rOutputDirectory;
+        map["simulation-id"] = "0";
+        map["seed"] = "7";
+        map["num-cells-across"] = "6";
+        map["num-cells-high"] = "12";
+        map["gland-height"] = "12";
+        map["isthmus-begin-height"] = "7";
+        map["isthmus-end-height"] = "9";
+        map["simulation-time"] = "1";
+        map["num-epochs"] = "1";
+        map["warm-start-cache"] = GetTestDirectory() + "/cache";
+        map["burn-in-time"] = "1";
+
+        GastricGlandParameters params;
+        params.update(map);
+        return params;
+    }
+
+    /**
+     * @param rOutputDirectory the output directory of a run made with MakeParameters()
+     * @return the contents of its binary output file
+     */
+    static std::string ReadOutput(const std::string& rOutputDirectory)
+    {
+        // Output starts where the burn-in stopped
+        FileFinder results(rOutputDirectory + "/sim_0/results_from_time_1/results.glandbin", RelativeTo::ChasteTestOutput);
+        TS_ASSERT(results.IsFile());
+
+        std::ifstream file(results.GetAbsolutePath().c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+public:
+
+    void TestCacheHitMatchesCacheMiss()
+    {
+        // Start from an empty cache
+        OutputFileHandler handler(GetTestDirectory(), true);
+
+        GastricGlandParameters miss_params = MakeParameters(GetTestDirectory() + "/miss");
+        FileFinder marker(miss_params.warm_start_cache + "/" + miss_params.warmStartKey() + "/warm_start.txt",
+                          RelativeTo::ChasteTestOutput);
+        TS_ASSERT(!marker.Exists());
+
+        GastricGlandSimulation driver;
+        driver.simplifiedModel(miss_params);
+        TS_ASSERT(marker.Exists());
+
+        GastricGlandParameters hit_params = MakeParameters(GetTestDirectory() + "/hit");
+        TS_ASSERT_EQUALS(hit_params.warmStartKey(), miss_params.warmStartKey());
+        driver.simplifiedModel(hit_params);
+
+        std::string miss_output = ReadOutput(miss_params.output_directory);
+        TS_ASSERT(!miss_output.empty());
+        TS_ASSERT(miss_output == ReadOutput(hit_params.output_directory));
+    }
+
+    void TestAbsoluteCachePathIsRejected()
+    {
+        std::map<std::string, std::string> map;
+        map["warm-start-cache"] = "/tmp/gland-cache";
+        GastricGlandParameters params;
+        TS_ASSERT_THROWS_CONTAINS(params.update(map), "warm-start-cache must be relative to CHASTE_TEST_OUTPUT");
+    }
+};
+
+#endif /*TESTGASTRICGLANDWARMSTART_HPP_*/
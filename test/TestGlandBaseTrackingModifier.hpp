@@ -0,0 +1,131 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDBASETRACKINGMODIFIER_HPP_
+#define TESTGLANDBASETRACKINGMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "GlandBaseTrackingModifier.hpp"
+#include "GlandTestFixture.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that the two modes of GlandBaseTrackingModifier find the same base and zones,
+ * and that only the default mode, which updates the population, leaves the cell areas
+ * read at the next division current.
+ */
+class TestGlandBaseTrackingModifier : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed for the birth times and node perturbations. */
+    static const unsigned SEED = 3;
+
+    /**
+     * @param rPopulation the population
+     * @return the zone assigned to each cell's model, in the population's cell order
+     */
+    static std::vector<unsigned char> GetZones(GastricGlandCellPopulation<2>& rPopulation)
+    {
+        std::vector<unsigned char> zones;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = rPopulation.Begin(); cell_iter != rPopulation.End(); ++cell_iter)
+        {
+            GastricGlandCellCycleModelV2* p_model = static_cast<GastricGlandCellCycleModelV2*>(cell_iter->GetCellCycleModel());
+            TS_ASSERT_EQUALS(p_model->GetGlandPopulation(), &rPopulation);
+            zones.push_back(p_model->GetZone());
+        }
+        return zones;
+    }
+
+public:
+
+    void TestUpdatesPopulationEachStepByDefault()
+    {
+        GlandBaseTrackingModifier<2> modifier;
+        TS_ASSERT(modifier.GetUpdatePopulationEachStep());
+    }
+
+    void TestModesFindSameBaseAndZones()
+    {
+        GlandTestFixture gland(20, SEED);
+        GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+        Cylindrical2dMesh* p_mesh = gland.GetMesh();
+        GlandContext<2>& r_context = gland.rGetContext();
+        r_context.SetIsthmusBeginHeight(10.0);
+        r_context.SetIsthmusEndHeight(13.0);
+        population.Update();
+
+        // Move every node, as a step does, so that the tessellation is out of date
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned index=0; index<p_mesh->GetNumAllNodes(); index++)
+        {
+            p_mesh->GetNode(index)->rGetModifiableLocation()[1] += 0.2*(p_gen->ranf() - 0.5);
+        }
+        CellPtr p_cell = population.rGetCells().front();
+        double old_area = population.GetVolumeOfCell(p_cell);
+
+        GlandBaseTrackingModifier<2> fast_modifier;
+        fast_modifier.SetUpdatePopulationEachStep(false);
+        fast_modifier.UpdateCellData(population);
+        c_vector<double, 2> fast_base = r_context.rGetBasePosition();
+        std::vector<unsigned char> fast_zones = GetZones(population);
+
+        // Without the update, the next division would still read the area from before the move
+        TS_ASSERT_EQUALS(population.GetVolumeOfCell(p_cell), old_area);
+
+        GlandBaseTrackingModifier<2> full_modifier;
+        full_modifier.UpdateCellData(population);
+        TS_ASSERT_EQUALS(r_context.rGetBasePosition()[0], fast_base[0]);
+        TS_ASSERT_EQUALS(r_context.rGetBasePosition()[1], fast_base[1]);
+        TS_ASSERT(GetZones(population) == fast_zones);
+        TS_ASSERT_DIFFERS(population.GetVolumeOfCell(p_cell), old_area);
+
+        // Every zone is represented, so the comparison covers each boundary
+        for (unsigned char zone=GLAND_ZONE_BASE; zone<=GLAND_ZONE_FOVEOLAR; zone++)
+        {
+            TS_ASSERT(std::find(fast_zones.begin(), fast_zones.end(), zone) != fast_zones.end());
+        }
+    }
+};
+
+#endif /*TESTGLANDBASETRACKINGMODIFIER_HPP_*/
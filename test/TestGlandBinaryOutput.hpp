@@ -0,0 +1,208 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDBINARYOUTPUT_HPP_
+#define TESTGLANDBINARYOUTPUT_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "AsyncGlandBinaryOutputWriter.hpp"
+#include "CellAncestor.hpp"
+#include "GlandBinaryOutputReader.hpp"
+#include "GlandBinaryOutputWriter.hpp"
+#include "GlandTestFixture.hpp"
+#include "OutputFileHandler.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that what GlandBinaryOutputWriter and AsyncGlandBinaryOutputWriter write is read
+ * back unchanged by GlandBinaryOutputReader, over several samples as cells move and die.
+ */
+class TestGlandBinaryOutput : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed for the node perturbations. */
+    static const unsigned SEED = 2;
+
+    /** Number of samples written; more than the async writer queues at once. */
+    static const unsigned NUM_SAMPLES = 6;
+
+    /**
+     * @param rPopulation the population
+     * @return the sample the writers should record now, gathered as they document
+     */
+    static GlandOutputSample GetExpectedSample(GastricGlandCellPopulation<2>& rPopulation)
+    {
+        GlandOutputSample sample;
+        sample.time = SimulationTime::Instance()->GetTime();
+        for (unsigned index=0; index<rPopulation.rGetMesh().GetNumAllNodes(); index++)
+        {
+            if (rPopulation.rGetMesh().GetNode(index)->IsDeleted() || !rPopulation.IsCellAttachedToLocationIndex(index))
+            {
+                continue;
+            }
+            CellPtr p_cell = rPopulation.GetCellUsingLocationIndex(index);
+            c_vector<double, 2> centre = rPopulation.GetLocationOfCellCentre(p_cell);
+            GastricGlandCellCycleModelV2* p_model = static_cast<GastricGlandCellCycleModelV2*>(p_cell->GetCellCycleModel());
+
+            sample.cellIds.push_back(p_cell->GetCellId());
+            sample.locationIndices.push_back(index);
+            sample.x.push_back(centre[0]);
+            sample.y.push_back(centre[1]);
+            sample.volumes.push_back(rPopulation.GetVolumeOfCell(p_cell));
+            sample.ancestors.push_back(p_cell->GetAncestor());
+            sample.ages.push_back(p_cell->GetAge());
+            sample.types.push_back(p_cell->GetCellProliferativeType()->GetColour());
+            sample.zones.push_back(p_model->GetZone());
+        }
+        return sample;
+    }
+
+    /**
+     * Write samples of a small gland with one writer, as a simulation does, and read them back.
+     *
+     * @param rDirectory the output directory
+     */
+    template<template<unsigned, unsigned> class WRITER>
+    static void CheckRoundTrip(const std::string& rDirectory)
+    {
+        std::vector<GlandOutputSample> expected;
+        std::string path;
+        {
+            GlandTestFixture gland(12, SEED);
+            SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, NUM_SAMPLES);
+            GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+            Cylindrical2dMesh* p_mesh = gland.GetMesh();
+
+            // Half the cells have an ancestor, so that both set and unset ancestors are written
+            unsigned i = 0;
+            for (std::list<CellPtr>::iterator it = population.rGetCells().begin(); it != population.rGetCells().end(); ++it, ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    MAKE_PTR_ARGS(CellAncestor, p_ancestor, (i));
+                    (*it)->SetAncestor(p_ancestor);
+                }
+            }
+
+            population.AddPopulationWriter<WRITER>();
+            population.Update();
+
+            OutputFileHandler handler(rDirectory, true);
+            path = handler.GetOutputDirectoryFullPath() + "results.glandbin";
+            population.OpenWritersFiles(handler);
+
+            RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+            for (unsigned sample=0; sample<NUM_SAMPLES; sample++)
+            {
+                if (sample > 0)
+                {
+                    SimulationTime::Instance()->IncrementTimeOneStep();
+
+                    // Move the cells up a little, and kill one, so that every sample differs
+                    for (unsigned index=0; index<p_mesh->GetNumAllNodes(); index++)
+                    {
+                        p_mesh->GetNode(index)->rGetModifiableLocation()[1] += 0.1*p_gen->ranf();
+                    }
+                    population.rGetCells().front()->Kill();
+                    population.RemoveDeadCells();
+                    population.Update(true);
+                }
+
+                expected.push_back(GetExpectedSample(population));
+                population.WriteResultsToFiles(rDirectory);
+            }
+            population.CloseWritersFiles();
+        }
+
+        GlandBinaryOutputReader reader(path);
+        TS_ASSERT_EQUALS(reader.GetVersion(), GLAND_OUTPUT_FORMAT_VERSION);
+        TS_ASSERT_EQUALS(reader.GetDimension(), 2u);
+
+        GlandOutputSample sample;
+        for (unsigned i=0; i<expected.size(); i++)
+        {
+            TS_ASSERT(reader.ReadNextSample(sample));
+            TS_ASSERT_EQUALS(sample.time, expected[i].time);
+            TS_ASSERT_EQUALS(sample.GetNumCells(), expected[i].GetNumCells());
+            TS_ASSERT(sample.cellIds == expected[i].cellIds);
+            TS_ASSERT(sample.locationIndices == expected[i].locationIndices);
+            TS_ASSERT(sample.x == expected[i].x);
+            TS_ASSERT(sample.y == expected[i].y);
+            TS_ASSERT(sample.volumes == expected[i].volumes);
+            TS_ASSERT(sample.ancestors == expected[i].ancestors);
+            TS_ASSERT(sample.ages == expected[i].ages);
+            TS_ASSERT(sample.types == expected[i].types);
+            TS_ASSERT(sample.zones == expected[i].zones);
+        }
+        TS_ASSERT(!reader.ReadNextSample(sample));
+        TS_ASSERT_EQUALS(expected.back().GetNumCells() + NUM_SAMPLES - 1, expected.front().GetNumCells());
+    }
+
+public:
+
+    void TestSyncWriterRoundTrip()
+    {
+        CheckRoundTrip<GlandBinaryOutputWriter>("TestGlandBinaryOutput/sync");
+    }
+
+    void TestAsyncWriterRoundTrip()
+    {
+        CheckRoundTrip<AsyncGlandBinaryOutputWriter>("TestGlandBinaryOutput/async");
+    }
+
+    void TestReaderRejectsOtherFiles()
+    {
+        OutputFileHandler handler("TestGlandBinaryOutput/bad", true);
+        out_stream p_file = handler.OpenOutputFile("results.glandbin");
+        *p_file << "not a gland output file";
+        p_file->close();
+
+        std::string path = handler.GetOutputDirectoryFullPath() + "results.glandbin";
+        TS_ASSERT_THROWS_CONTAINS(GlandBinaryOutputReader reader(path), "is not a gland output file");
+        TS_ASSERT_THROWS_CONTAINS(GlandBinaryOutputReader reader(path + ".missing"), "Could not open gland output file");
+    }
+};
+
+#endif /*TESTGLANDBINARYOUTPUT_HPP_*/
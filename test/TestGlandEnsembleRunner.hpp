@@ -0,0 +1,149 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDENSEMBLERUNNER_HPP_
+#define TESTGLANDENSEMBLERUNNER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "FileFinder.hpp"
+#include "GlandEnsembleRunner.hpp"
+#include "OutputFileHandler.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that GlandEnsembleRunner runs each simulation in its own worker, with its own
+ * output directory and log, and counts the runs which fail.
+ */
+class TestGlandEnsembleRunner : public CxxTest::TestSuite
+{
+private:
+
+    /** Output directory shared by the runs. */
+    static const std::string OUTPUT_DIRECTORY;
+
+    /**
+     * @param rId the simulation id
+     * @return the parameters of a run of a tiny gland, for a fraction of an hour
+     */
+    static GastricGlandParameters MakeTinyRun(const std::string& rId)
+    {
+        std::map<std::string, std::string> map;
+        map["output-directory"] = OUTPUT_DIRECTORY;
+        map["simulation-id"] = rId;
+        map["num-cells-across"] = "6";
+        map["num-cells-high"] = "10";
+        map["gland-height"] = "10";
+        map["base-height"] = "1";
+        map["isthmus-begin-height"] = "6";
+        map["isthmus-end-height"] = "8";
+        map["simulation-time"] = "0.5";
+        map["num-epochs"] = "0";
+
+        GastricGlandParameters params;
+        params.update(map);
+        return params;
+    }
+
+    /**
+     * @param rFileName a file relative to the runs' output directory
+     * @return the contents of the file
+     */
+    static std::string ReadOutputFile(const std::string& rFileName)
+    {
+        OutputFileHandler handler(OUTPUT_DIRECTORY, false);
+        std::ifstream file((handler.GetOutputDirectoryFullPath() + rFileName).c_str());
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+public:
+
+    void TestNumWorkers()
+    {
+        TS_ASSERT_EQUALS(GlandEnsembleRunner(3).GetNumWorkers(), 3u);
+
+        // Zero uses every online core
+        TS_ASSERT_LESS_THAN(0u, GlandEnsembleRunner(0).GetNumWorkers());
+    }
+
+    void TestRunsInWorkers()
+    {
+        OutputFileHandler handler(OUTPUT_DIRECTORY, true);
+
+        // Two runs complete; a third fails, as there is no checkpoint to resume from
+        GastricGlandParameters failing_run = MakeTinyRun("broken");
+        failing_run.resume_from = "TestGlandEnsembleRunner/no_such_run";
+
+        GlandEnsembleRunner runner(2);
+        runner.AddRun(MakeTinyRun("a"));
+        runner.AddRun(MakeTinyRun("b"));
+        runner.AddRun(failing_run);
+        TS_ASSERT_EQUALS(runner.GetNumRuns(), 3u);
+
+        TS_ASSERT_EQUALS(runner.Run(), 1u);
+
+        // Each run writes to its own directory, and logs to its own file
+        TS_ASSERT(FileFinder(OUTPUT_DIRECTORY + "/sim_a/results_from_time_0/results.glandbin", RelativeTo::ChasteTestOutput).Exists());
+        TS_ASSERT(FileFinder(OUTPUT_DIRECTORY + "/sim_b/results_from_time_0/results.glandbin", RelativeTo::ChasteTestOutput).Exists());
+        TS_ASSERT(!FileFinder(OUTPUT_DIRECTORY + "/sim_broken", RelativeTo::ChasteTestOutput).Exists());
+
+        std::string log_a = ReadOutputFile("sim_a.log");
+        TS_ASSERT_DIFFERS(log_a.find("sim_a"), std::string::npos);
+        TS_ASSERT_EQUALS(log_a.find("sim_b"), std::string::npos);
+        TS_ASSERT_DIFFERS(log_a.find("Completed Toy Gastric Gland Model"), std::string::npos);
+        TS_ASSERT_DIFFERS(ReadOutputFile("sim_b.log").find("Completed Toy Gastric Gland Model"), std::string::npos);
+        TS_ASSERT_EQUALS(ReadOutputFile("sim_broken.log").find("Completed Toy Gastric Gland Model"), std::string::npos);
+
+        // The workers leave the parent's singletons alone, so it can run again
+        GlandEnsembleRunner serial_runner(1);
+        serial_runner.AddRun(MakeTinyRun("c"));
+        TS_ASSERT_EQUALS(serial_runner.Run(), 0u);
+        TS_ASSERT(FileFinder(OUTPUT_DIRECTORY + "/sim_c/results_from_time_0/results.glandbin", RelativeTo::ChasteTestOutput).Exists());
+    }
+};
+
+const std::string TestGlandEnsembleRunner::OUTPUT_DIRECTORY = "TestGlandEnsembleRunner";
+
+#endif /*TESTGLANDENSEMBLERUNNER_HPP_*/
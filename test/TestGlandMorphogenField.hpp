@@ -0,0 +1,160 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDMORPHOGENFIELD_HPP_
+#define TESTGLANDMORPHOGENFIELD_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+
+#include "GlandMorphogenField.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks the ADI solver of GlandMorphogenField against results known exactly: diffusion
+ * alone conserves mass, decay alone scales it by exp(-kt), and a uniform source s
+ * balanced by decay k settles at s/k.
+ */
+class TestGlandMorphogenField : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * The total amount of morphogen on the grid, by the trapezoidal rule in y, which is
+     * the sum the zero-flux rows conserve.
+     *
+     * @param rField the field
+     * @param width the circumference its grid was laid out over
+     * @param height the distance from its bottom row to its top row
+     * @return the total amount
+     */
+    static double GetTotal(const GlandMorphogenField& rField, double width, double height)
+    {
+        const unsigned num_x = rField.GetNumX();
+        const unsigned num_y = rField.GetNumY();
+        const double cell_area = (width/num_x)*(height/(num_y - 1));
+        const std::vector<double>& r_concentration = rField.rGetConcentration();
+
+        double total = 0.0;
+        for (unsigned j=0; j<num_y; j++)
+        {
+            double weight = (j == 0 || j == num_y - 1) ? 0.5 : 1.0;
+            for (unsigned i=0; i<num_x; i++)
+            {
+                total += weight*r_concentration[j*num_x + i]*cell_area;
+            }
+        }
+        return total;
+    }
+
+public:
+
+    void TestMassIsConservedWithoutDecay()
+    {
+        GlandMorphogenField field;
+        field.SetUpGrid(10.0, 0.0, 20.0, 0.5);
+        field.SetDiffusivity(1.0);
+        field.SetDecayRate(0.0);
+        field.SetTimeStep(0.01);
+        TS_ASSERT_EQUALS(field.GetNumX(), 20u);
+        TS_ASSERT_EQUALS(field.GetNumY(), 41u);
+        TS_ASSERT_DELTA(field.GetRowHeight(40), 20.0, 1e-12);
+
+        // A point source releasing one unit per unit time, for one unit of time
+        field.AddSource(2.3, 7.7, 1.0);
+        field.Advance(1.0);
+        TS_ASSERT_DELTA(GetTotal(field, 10.0, 20.0), 1.0, 1e-10);
+
+        // Spreading over the grid, across the periodic seam and against the end rows, loses nothing
+        field.ClearSources();
+        field.Advance(500.0);
+        TS_ASSERT_DELTA(GetTotal(field, 10.0, 20.0), 1.0, 1e-10);
+
+        // Long after the slowest decay time, L^2/(pi^2 D), the field is flat at the mean density
+        TS_ASSERT_DELTA(field.Sample(9.9, 19.0), 1.0/200.0, 1e-6);
+        TS_ASSERT_DELTA(field.GetMeanAtHeight(3.0), 1.0/200.0, 1e-6);
+    }
+
+    void TestDecayMatchesAnalyticSolution()
+    {
+        GlandMorphogenField field;
+        field.SetUpGrid(10.0, 0.0, 20.0, 0.5);
+        field.SetDiffusivity(1.0);
+        field.SetDecayRate(0.0);
+        field.SetTimeStep(0.01);
+
+        field.AddSource(2.3, 7.7, 1.0);
+        field.Advance(1.0);
+        double initial_total = GetTotal(field, 10.0, 20.0);
+
+        // Diffusion conserves the total, so it decays as exp(-kt) however the field is spread
+        const double decay_rate = 0.5;
+        field.ClearSources();
+        field.SetDecayRate(decay_rate);
+        for (unsigned step=1; step<=4; step++)
+        {
+            field.Advance(0.5);
+            double expected = initial_total*exp(-decay_rate*0.5*step);
+            TS_ASSERT_DELTA(GetTotal(field, 10.0, 20.0)/expected, 1.0, 1e-5);
+        }
+    }
+
+    void TestUniformSourceSettlesAtSourceOverDecayRate()
+    {
+        GlandMorphogenField field;
+        field.SetUpGrid(10.0, 0.0, 40.0, 1.0);
+        field.SetDiffusivity(1.0);
+        field.SetDecayRate(0.5);
+        field.SetTimeStep(0.1);
+
+        // One unit per unit time at every grid point, a density of one on a unit grid
+        for (unsigned j=0; j<field.GetNumY(); j++)
+        {
+            for (unsigned i=0; i<field.GetNumX(); i++)
+            {
+                field.AddSource(i*1.0, field.GetRowHeight(j), 1.0);
+            }
+        }
+        field.Advance(100.0);
+
+        TS_ASSERT_DELTA(field.Sample(3.3, 17.2), 2.0, 1e-6);
+        TS_ASSERT_DELTA(field.GetMeanAtHeight(0.0), 2.0, 1e-6);
+        TS_ASSERT_DELTA(field.GetMeanGradientAtHeight(20.0), 0.0, 1e-6);
+    }
+};
+
+#endif /*TESTGLANDMORPHOGENFIELD_HPP_*/
@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDSPRINGFORCE_HPP_
+#define TESTGLANDSPRINGFORCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+#include "SmartPointers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "FoveolarCellProliferativeType.hpp"
+#include "GlandSpringForce.hpp"
+#include "GlandTestFixture.hpp"
+#include "LinearSpringWithVariableSpringConstantsForce.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks that GlandSpringForce gives the same node forces as the
+ * LinearSpringWithVariableSpringConstantsForce it replaces, on a small perturbed gland
+ * with foveolar cells, apoptotic cells, a newly divided pair and springs across the
+ * periodic boundary.
+ */
+class TestGlandSpringForce : public CxxTest::TestSuite
+{
+private:
+
+    /** Seed for the node perturbations and cell choices. */
+    static const unsigned SEED = 11;
+
+    /** Largest difference allowed between the forces on any node. */
+    static constexpr double TOLERANCE = 1e-12;
+
+    /**
+     * Apply a force to the population, starting from zero applied forces.
+     *
+     * @param rForce the force
+     * @param rPopulation the population
+     * @return the applied force on each node, indexed by node index
+     */
+    static std::vector<c_vector<double, 2> > ApplyForce(AbstractForce<2>& rForce, GastricGlandCellPopulation<2>& rPopulation)
+    {
+        MutableMesh<2,2>& r_mesh = rPopulation.rGetMesh();
+        for (unsigned index=0; index<r_mesh.GetNumAllNodes(); index++)
+        {
+            r_mesh.GetNode(index)->ClearAppliedForce();
+        }
+
+        rForce.AddForceContribution(rPopulation);
+
+        std::vector<c_vector<double, 2> > forces;
+        for (unsigned index=0; index<r_mesh.GetNumAllNodes(); index++)
+        {
+            forces.push_back(r_mesh.GetNode(index)->rGetAppliedForce());
+        }
+        return forces;
+    }
+
+public:
+
+    void TestForcesMatchLinearSpringForce()
+    {
+        GlandTestFixture gland(12, SEED);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 120);
+        GastricGlandCellPopulation<2>& population = gland.rGetPopulation();
+        Cylindrical2dMesh* p_mesh = gland.GetMesh();
+        double width = p_mesh->GetWidth(0);
+
+        // Foveolar cells have their own rest length; all cells are older than the spring growth duration
+        boost::shared_ptr<AbstractCellProperty> p_foveolar =
+            CellPropertyRegistry::Instance()->Get<FoveolarCellProliferativeType>();
+        for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+        {
+            if (population.GetLocationOfCellCentre(*cell_iter)[1] > 8.0)
+            {
+                cell_iter->SetCellProliferativeType(p_foveolar);
+            }
+            cell_iter->SetBirthTime(-2.0);
+        }
+        population.Update();
+
+        // Perturb every node, so that no spring is at its rest length
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned index=0; index<p_mesh->GetNumAllNodes(); index++)
+        {
+            c_vector<double, 2>& r_location = p_mesh->GetNode(index)->rGetModifiableLocation();
+            r_location[0] = std::fmod(r_location[0] + 0.2*(p_gen->ranf() - 0.5) + width, width);
+            r_location[1] += 0.2*(p_gen->ranf() - 0.5);
+        }
+
+        // A newly divided pair on a marked spring, and apoptotic cells on other springs
+        unsigned num_periodic_springs = 0;
+        unsigned num_young_pairs = 0;
+        unsigned num_apoptotic = 0;
+        for (MeshBasedCellPopulation<2>::SpringIterator spring_iterator = population.SpringsBegin();
+             spring_iterator != population.SpringsEnd();
+             ++spring_iterator)
+        {
+            CellPtr p_cell_a = spring_iterator.GetCellA();
+            CellPtr p_cell_b = spring_iterator.GetCellB();
+            if (std::fabs(spring_iterator.GetNodeA()->rGetLocation()[0] - spring_iterator.GetNodeB()->rGetLocation()[0]) > 0.5*width)
+            {
+                num_periodic_springs++;
+            }
+
+            if (p_cell_a->GetAge() < 1.0 || p_cell_b->GetAge() < 1.0
+                || p_cell_a->HasApoptosisBegun() || p_cell_b->HasApoptosisBegun())
+            {
+                continue;
+            }
+            double u = p_gen->ranf();
+            if (num_young_pairs < 2 && u < 0.05)
+            {
+                p_cell_a->SetBirthTime(-0.25);
+                p_cell_b->SetBirthTime(-0.25);
+                std::pair<CellPtr,CellPtr> cell_pair = population.CreateCellPair(p_cell_a, p_cell_b);
+                population.MarkSpring(cell_pair);
+                num_young_pairs++;
+            }
+            else if (num_apoptotic < 3 && u > 0.95)
+            {
+                p_cell_a->StartApoptosis();
+                num_apoptotic++;
+            }
+        }
+        TS_ASSERT_LESS_THAN(0u, num_periodic_springs);
+        TS_ASSERT_EQUALS(num_young_pairs, 2u);
+        TS_ASSERT_EQUALS(num_apoptotic, 3u);
+
+        LinearSpringWithVariableSpringConstantsForce<2> linear_force;
+        std::vector<c_vector<double, 2> > expected = ApplyForce(linear_force, population);
+
+        // The threaded scatter sums in a different order, so is only equal to rounding
+        for (unsigned num_threads=1; num_threads<=3; num_threads++)
+        {
+            GlandSpringForce<2> gland_force;
+            gland_force.SetNumThreads(num_threads);
+            std::vector<c_vector<double, 2> > forces = ApplyForce(gland_force, population);
+
+            TS_ASSERT_EQUALS(forces.size(), expected.size());
+            double max_force = 0.0;
+            for (unsigned index=0; index<forces.size(); index++)
+            {
+                TS_ASSERT_DELTA(forces[index][0], expected[index][0], TOLERANCE);
+                TS_ASSERT_DELTA(forces[index][1], expected[index][1], TOLERANCE);
+                max_force = std::max(max_force, norm_2(expected[index]));
+            }
+            TS_ASSERT_LESS_THAN(0.1, max_force);
+        }
+    }
+};
+
+#endif /*TESTGLANDSPRINGFORCE_HPP_*/
@@ -0,0 +1,322 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTGLANDSWEEPSPEC_HPP_
+#define TESTGLANDSWEEPSPEC_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GlandSweepSpec.hpp"
+#include "OutputFileHandler.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks the statements of the sweep language and their error messages, the expansion of
+ * a sweep into runs and its manifest, and the Latin hypercube and Sobol samples.
+ */
+class TestGlandSweepSpec : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * @param rInput sweep statements
+     * @return the sweep they describe
+     */
+    static GlandSweepSpec ParseSpec(const std::string& rInput)
+    {
+        GlandSweepSpec spec;
+        spec.Parse(rInput);
+        return spec;
+    }
+
+    /**
+     * Check that in every dimension of a sample each of numPoints equal strata holds exactly one point.
+     *
+     * @param rPoints the points, point by point
+     * @param numPoints the number of points
+     * @param numDimensions the number of dimensions
+     */
+    static void CheckStrata(const std::vector<double>& rPoints, unsigned numPoints, unsigned numDimensions)
+    {
+        TS_ASSERT_EQUALS(rPoints.size(), numPoints*numDimensions);
+        for (unsigned dimension=0; dimension<numDimensions; dimension++)
+        {
+            std::vector<unsigned> hits(numPoints, 0);
+            for (unsigned i=0; i<numPoints; i++)
+            {
+                double x = rPoints[i*numDimensions + dimension];
+                TS_ASSERT(x >= 0.0 && x < 1.0);
+                hits[static_cast<unsigned>(std::floor(x*numPoints))]++;
+            }
+            for (unsigned stratum=0; stratum<numPoints; stratum++)
+            {
+                TS_ASSERT_EQUALS(hits[stratum], 1u);
+            }
+        }
+    }
+
+public:
+
+    void TestStatements()
+    {
+        GlandSweepSpec spec = ParseSpec(
+            "# a comment\n"
+            "\n"
+            "dt=0.005\n"
+            "  values base-g1-duration 100 200  \n"
+            "grid isthmus-g1-duration 5 15 3\n"
+            "replicates 2\n");
+
+        std::vector<std::string> keys = spec.GetSweptKeys();
+        TS_ASSERT_EQUALS(keys.size(), 2u);
+        TS_ASSERT_EQUALS(keys[0], "base-g1-duration");
+        TS_ASSERT_EQUALS(keys[1], "isthmus-g1-duration");
+        TS_ASSERT_EQUALS(spec.GetNumReplicates(), 2u);
+        TS_ASSERT_EQUALS(spec.GetNumRuns(), 12u);
+
+        // The last key varies fastest, and each point's replicates are consecutive
+        std::vector<GlandSweepRun> runs = spec.Expand(std::map<std::string, std::string>());
+        TS_ASSERT_EQUALS(runs.size(), 12u);
+        const char* expected_isthmus[3] = {"5", "10", "15"};
+        for (unsigned i=0; i<runs.size(); i++)
+        {
+            unsigned point = i/2;
+            TS_ASSERT_EQUALS(runs[i].values.size(), 2u);
+            TS_ASSERT_EQUALS(runs[i].values[0], point < 3 ? "100" : "200");
+            TS_ASSERT_EQUALS(runs[i].values[1], expected_isthmus[point % 3]);
+            TS_ASSERT_DELTA(runs[i].params.base_g1_duration, point < 3 ? 100.0 : 200.0, 1e-12);
+            TS_ASSERT_DELTA(runs[i].params.isthmus_g1_duration, 5.0 + 5.0*(point % 3), 1e-12);
+            TS_ASSERT_DELTA(runs[i].params.dt, 0.005, 1e-15);
+        }
+
+        // Parameters passed to Expand() override those in the file, but not the swept values
+        std::map<std::string, std::string> base_map;
+        base_map["dt"] = "0.01";
+        base_map["base-g1-duration"] = "50";
+        runs = spec.Expand(base_map);
+        TS_ASSERT_DELTA(runs[0].params.dt, 0.01, 1e-15);
+        TS_ASSERT_DELTA(runs[0].params.base_g1_duration, 100.0, 1e-12);
+
+        // SetNumReplicates() overrides the replicates statement
+        spec.SetNumReplicates(1);
+        TS_ASSERT_EQUALS(spec.GetNumRuns(), 6u);
+        TS_ASSERT_EQUALS(spec.Expand(std::map<std::string, std::string>()).size(), 6u);
+
+        // A grid of one value takes its minimum
+        GlandSweepSpec single = ParseSpec("grid base-g1-duration 7 9 1");
+        TS_ASSERT_EQUALS(single.Expand(std::map<std::string, std::string>())[0].values[0], "7");
+
+        // Ranges are crossed with the levels, and every sample lies in its range
+        GlandSweepSpec sampled = ParseSpec(
+            "values base-g1-duration 100 200\n"
+            "range isthmus-g1-duration 5 15\n"
+            "range foveolar-cell-size-multiplier 0.5 1\n"
+            "sample lhs 4\n"
+            "sample-seed 3\n");
+        TS_ASSERT_EQUALS(sampled.GetSweptKeys().size(), 3u);
+        TS_ASSERT_EQUALS(sampled.GetSweptKeys()[2], "foveolar-cell-size-multiplier");
+        TS_ASSERT_EQUALS(sampled.GetNumRuns(), 8u);
+        runs = sampled.Expand(std::map<std::string, std::string>());
+        TS_ASSERT_EQUALS(runs.size(), 8u);
+        for (unsigned i=0; i<runs.size(); i++)
+        {
+            TS_ASSERT_EQUALS(runs[i].params.simulation_id, std::to_string(i));
+            TS_ASSERT_EQUALS(runs[i].values[0], i < 4 ? "100" : "200");
+            TS_ASSERT(runs[i].params.isthmus_g1_duration > 5.0 && runs[i].params.isthmus_g1_duration < 15.0);
+            TS_ASSERT(runs[i].params.foveolar_cell_size_multiplier > 0.5 && runs[i].params.foveolar_cell_size_multiplier < 1.0);
+
+            // Both levels share the same sampled points
+            TS_ASSERT_EQUALS(runs[i].values[1], runs[i % 4].values[1]);
+            TS_ASSERT_EQUALS(runs[i].values[2], runs[i % 4].values[2]);
+        }
+    }
+
+    void TestStatementErrors()
+    {
+        TS_ASSERT_THROWS_THIS(ParseSpec("seed= "), "\"seed=\" is missing key or value");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sweep base-g1-duration 1"), "Unknown sweep statement \"sweep base-g1-duration 1\"");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("values base-g1-duration"), "values needs a key and at least one value");
+        TS_ASSERT_THROWS_THIS(ParseSpec("values no-such-key 1"), "\"no-such-key\" is not a GastricGlandParameters key");
+        TS_ASSERT_THROWS_THIS(ParseSpec("values seed 1 2"), "\"seed\" is set per run and cannot be swept; use replicates");
+        TS_ASSERT_THROWS_THIS(ParseSpec("values simulation-id a b"), "\"simulation-id\" is set per run and cannot be swept; use replicates");
+        TS_ASSERT_THROWS_THIS(ParseSpec("values base-g1-duration 1\nrange base-g1-duration 1 2"),
+                              "\"base-g1-duration\" is swept more than once");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("grid base-g1-duration 1 2"), "grid needs a key, a minimum, a maximum and a number of values");
+        TS_ASSERT_THROWS_THIS(ParseSpec("grid base-g1-duration 1 x 3"), "\"x\" is not a number");
+        TS_ASSERT_THROWS_THIS(ParseSpec("grid base-g1-duration 1 2 0"), "\"0\" is not a positive count");
+        TS_ASSERT_THROWS_THIS(ParseSpec("grid base-g1-duration 1 2 2.5"), "\"2.5\" is not a positive count");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("range base-g1-duration 1"), "range needs a key, a minimum and a maximum");
+        TS_ASSERT_THROWS_THIS(ParseSpec("range base-g1-duration 2 1"), "range of base-g1-duration is empty");
+        TS_ASSERT_THROWS_THIS(ParseSpec("range base-g1-duration 1 inf"), "\"inf\" is not a number");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample grid 4"), "sample needs a method, lhs or sobol, and a number of points");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample lhs"), "sample needs a method, lhs or sobol, and a number of points");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample sobol -4"), "\"-4\" is not a positive count");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample-seed"), "sample-seed needs a seed");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample-seed -1"), "\"-1\" is not a seed");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample-seed 4294967296"), "\"4294967296\" is not a seed");
+
+        TS_ASSERT_THROWS_THIS(ParseSpec("replicates"), "replicates needs a count");
+        TS_ASSERT_THROWS_THIS(ParseSpec("replicates 0"), "\"0\" is not a positive count");
+        GlandSweepSpec spec;
+        TS_ASSERT_THROWS_THIS(spec.SetNumReplicates(0), "A sweep needs at least one replicate");
+
+        // Problems with the sweep as a whole are found when it is expanded
+        std::map<std::string, std::string> no_overrides;
+        TS_ASSERT_THROWS_THIS(ParseSpec("range base-g1-duration 1 2").Expand(no_overrides),
+                              "Sweep has ranges but no sample statement");
+        TS_ASSERT_THROWS_THIS(ParseSpec("sample lhs 4").Expand(no_overrides),
+                              "Sweep has a sample statement but no ranges");
+        TS_ASSERT_THROWS_CONTAINS(ParseSpec("values num-cells-across 6 x").Expand(no_overrides), "Sweep point 1: ");
+        TS_ASSERT_THROWS_THIS(ParseSpec("grid base-g1-duration 1 2 5000\ngrid isthmus-g1-duration 1 2 5000").GetNumRuns(),
+                              "Sweep expands to more than 10000000 runs");
+
+        std::stringstream sobol_ranges;
+        for (unsigned i=0; i<=GlandSweepSpec::GetMaxSobolDimensions(); i++)
+        {
+            sobol_ranges << "range " << GastricGlandParameters::valid_keys[i] << " 1 2\n";
+        }
+        sobol_ranges << "sample sobol 4\n";
+        TS_ASSERT_THROWS_THIS(ParseSpec(sobol_ranges.str()).Expand(no_overrides),
+                              "Sobol sampling supports at most " + std::to_string(GlandSweepSpec::GetMaxSobolDimensions()) + " ranges");
+    }
+
+    void TestReadFile()
+    {
+        OutputFileHandler handler("TestGlandSweepSpec", true);
+        std::string good_file = handler.GetOutputDirectoryFullPath() + "good.sweep";
+        std::string bad_file = handler.GetOutputDirectoryFullPath() + "bad.sweep";
+        {
+            std::ofstream good(good_file.c_str());
+            good << "values base-g1-duration 100 200\n";
+            std::ofstream bad(bad_file.c_str());
+            bad << "# the error is on line 3\n\nreplicates two\n";
+        }
+
+        GlandSweepSpec spec;
+        spec.ReadFile(good_file);
+        TS_ASSERT_EQUALS(spec.GetNumRuns(), 2u);
+
+        TS_ASSERT_THROWS_THIS(spec.ReadFile(bad_file), bad_file + ":3: \"two\" is not a number");
+        TS_ASSERT_THROWS_THIS(spec.ReadFile(bad_file + ".missing"), "Could not open sweep file " + bad_file + ".missing");
+    }
+
+    void TestLatinHypercubeHitsEveryStratum()
+    {
+        CheckStrata(GlandSweepSpec::LatinHypercube(1, 2, 0), 1, 2);
+        CheckStrata(GlandSweepSpec::LatinHypercube(7, 3, 0), 7, 3);
+        CheckStrata(GlandSweepSpec::LatinHypercube(64, 4, 12345), 64, 4);
+
+        // The sample is fixed by its seed
+        TS_ASSERT(GlandSweepSpec::LatinHypercube(16, 3, 1) == GlandSweepSpec::LatinHypercube(16, 3, 1));
+        TS_ASSERT(GlandSweepSpec::LatinHypercube(16, 3, 1) != GlandSweepSpec::LatinHypercube(16, 3, 2));
+    }
+
+    void TestSobolFirstPoints()
+    {
+        // The first points of the unscrambled sequence in three dimensions, in Gray code order
+        const double expected[8][3] = {
+            {0.0, 0.0, 0.0},
+            {0.5, 0.5, 0.5},
+            {0.75, 0.25, 0.25},
+            {0.25, 0.75, 0.75},
+            {0.375, 0.375, 0.625},
+            {0.875, 0.875, 0.125},
+            {0.625, 0.125, 0.875},
+            {0.125, 0.625, 0.375}};
+
+        std::vector<double> points = GlandSweepSpec::Sobol(8, 3);
+        TS_ASSERT_EQUALS(points.size(), 24u);
+        for (unsigned i=0; i<8; i++)
+        {
+            for (unsigned dimension=0; dimension<3; dimension++)
+            {
+                TS_ASSERT_EQUALS(points[i*3 + dimension], expected[i][dimension]);
+            }
+        }
+
+        // The first 2^k points of every dimension fill all 2^k strata
+        unsigned num_dimensions = GlandSweepSpec::GetMaxSobolDimensions();
+        CheckStrata(GlandSweepSpec::Sobol(64, num_dimensions), 64, num_dimensions);
+    }
+
+    void TestManifest()
+    {
+        GlandSweepSpec spec = ParseSpec(
+            "values base-g1-duration 100 200\n"
+            "grid isthmus-g1-duration 5 10 2\n"
+            "replicates 2\n");
+
+        std::map<std::string, std::string> base_map;
+        base_map["simulation-id"] = "sweep";
+        base_map["seed"] = "7";
+        std::vector<GlandSweepRun> runs = spec.Expand(base_map);
+
+        std::stringstream manifest;
+        spec.WriteManifest(runs, manifest);
+        TS_ASSERT_EQUALS(manifest.str(),
+            "simulation-id\tseed\tbase-g1-duration\tisthmus-g1-duration\n"
+            "sweep_0_0\t7\t100\t5\n"
+            "sweep_0_1\t8\t100\t5\n"
+            "sweep_1_0\t7\t100\t10\n"
+            "sweep_1_1\t8\t100\t10\n"
+            "sweep_2_0\t7\t200\t5\n"
+            "sweep_2_1\t8\t200\t5\n"
+            "sweep_3_0\t7\t200\t10\n"
+            "sweep_3_1\t8\t200\t10\n");
+
+        // Each manifest row describes the parameters of its run
+        for (unsigned i=0; i<runs.size(); i++)
+        {
+            TS_ASSERT_EQUALS(runs[i].params.seed, 7u + i % 2);
+        }
+    }
+};
+
+#endif /*TESTGLANDSWEEPSPEC_HPP_*/
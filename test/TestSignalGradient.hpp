@@ -0,0 +1,187 @@
+/*
+
+Copyright (c) 2005-2021, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTSIGNALGRADIENT_HPP_
+#define TESTSIGNALGRADIENT_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "CheckpointArchiveTypes.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "Exception.hpp"
+#include "SignalGradient.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Checks the levels and derivatives which SignalGradient interpolates in its tables
+ * against the analytic profiles, for every type of gradient with a table.
+ */
+class TestSignalGradient : public CxxTest::TestSuite
+{
+private:
+
+    /** Crypt length of every gradient tested. */
+    static constexpr double CRYPT_LENGTH = 20.0;
+
+    /** Number of heights checked inside the support. */
+    static const unsigned NUM_HEIGHTS = 997;
+
+    /**
+     * @param type the type of gradient
+     * @param parameter the concentration parameter
+     * @param height a height inside the support
+     * @return the analytic level at this height
+     */
+    static double GetAnalyticLevel(SignalGradientType type, double parameter, double height)
+    {
+        double scale = parameter*CRYPT_LENGTH;
+        switch (type)
+        {
+            case SG_LINEAR:
+            case SG_RADIAL:
+                return 1.0 - height/scale;
+            case SG_NEGLINEAR:
+                return height/scale;
+            case SG_EXPONENTIAL:
+                return exp(-height/scale);
+            case SG_NEGEXPONENTIAL:
+                return exp(-(CRYPT_LENGTH - height)/scale);
+            default:
+                NEVER_REACHED;
+        }
+    }
+
+    /**
+     * @param type the type of gradient
+     * @param parameter the concentration parameter
+     * @param height a height inside the support
+     * @return the analytic derivative of the level with respect to height at this height
+     */
+    static double GetAnalyticDerivative(SignalGradientType type, double parameter, double height)
+    {
+        double scale = parameter*CRYPT_LENGTH;
+        switch (type)
+        {
+            case SG_LINEAR:
+            case SG_RADIAL:
+                return -1.0/scale;
+            case SG_NEGLINEAR:
+                return 1.0/scale;
+            case SG_EXPONENTIAL:
+                return -exp(-height/scale)/scale;
+            case SG_NEGEXPONENTIAL:
+                return exp(-(CRYPT_LENGTH - height)/scale)/scale;
+            default:
+                NEVER_REACHED;
+        }
+    }
+
+    /**
+     * Compare a gradient's tabulated levels and derivatives with the analytic ones.
+     *
+     * @param type the type of gradient
+     * @param parameter the concentration parameter
+     * @param support the height below which the gradient is non-zero
+     * @param relativeTolerance the largest error allowed, relative to the analytic value
+     */
+    static void CheckTables(SignalGradientType type, double parameter, double support, double relativeTolerance)
+    {
+        SignalGradient<2> gradient;
+        gradient.SetType(type);
+        gradient.SetCryptLength(CRYPT_LENGTH);
+        gradient.SetConcentrationParameter(parameter);
+        gradient.SetUseTable(true);
+
+        std::vector<double> heights;
+        for (unsigned i=0; i<NUM_HEIGHTS; i++)
+        {
+            heights.push_back(support*(i + 0.5)/NUM_HEIGHTS);
+        }
+
+        for (unsigned i=0; i<NUM_HEIGHTS; i++)
+        {
+            double level = GetAnalyticLevel(type, parameter, heights[i]);
+            double derivative = GetAnalyticDerivative(type, parameter, heights[i]);
+            TS_ASSERT_DELTA(gradient.GetLevel(heights[i]), level, relativeTolerance*fabs(level) + 1e-14);
+            TS_ASSERT_DELTA(gradient.GetLevelDerivative(heights[i]), derivative, relativeTolerance*fabs(derivative) + 1e-14);
+        }
+
+        // The batch lookups interpolate in the same tables
+        std::vector<double> levels(NUM_HEIGHTS);
+        std::vector<double> derivatives(NUM_HEIGHTS);
+        gradient.GetLevels(heights.data(), levels.data(), NUM_HEIGHTS);
+        gradient.GetLevelDerivatives(heights.data(), derivatives.data(), NUM_HEIGHTS);
+        for (unsigned i=0; i<NUM_HEIGHTS; i++)
+        {
+            TS_ASSERT_EQUALS(levels[i], gradient.GetLevel(heights[i]));
+            TS_ASSERT_EQUALS(derivatives[i], gradient.GetLevelDerivative(heights[i]));
+        }
+
+        // Outside the support both are zero, as without tables
+        TS_ASSERT_EQUALS(gradient.GetLevel(-0.5), 0.0);
+        TS_ASSERT_EQUALS(gradient.GetLevelDerivative(-0.5), 0.0);
+        TS_ASSERT_EQUALS(gradient.GetLevel(support + 0.5), 0.0);
+        TS_ASSERT_EQUALS(gradient.GetLevelDerivative(support + 0.5), 0.0);
+    }
+
+public:
+
+    void TestLinearTablesAreExact()
+    {
+        CheckTables(SG_LINEAR, 0.5, 0.5*CRYPT_LENGTH, 1e-12);
+        CheckTables(SG_RADIAL, 1.0, CRYPT_LENGTH, 1e-12);
+        CheckTables(SG_NEGLINEAR, 0.75, 0.75*CRYPT_LENGTH, 1e-12);
+    }
+
+    void TestExponentialTablesAreAccurate()
+    {
+        /*
+         * Linear interpolation is out by at most an eighth of the squared spacing times the
+         * second derivative, which for these profiles is (spacing/scale)^2/8 of the level:
+         * 1.2e-7 with the default 1024 entries over one crypt length and a parameter of 1.
+         */
+        CheckTables(SG_EXPONENTIAL, 1.0, CRYPT_LENGTH, 1.25e-7);
+        CheckTables(SG_NEGEXPONENTIAL, 1.0, CRYPT_LENGTH, 1.25e-7);
+
+        // The error grows with the inverse square of the parameter
+        CheckTables(SG_EXPONENTIAL, 0.5, CRYPT_LENGTH, 5e-7);
+    }
+};
+
+#endif /*TESTSIGNALGRADIENT_HPP_*/